@@ -8,6 +8,14 @@
 import { useRef, useEffect, useState, useCallback } from "react";
 import { useRollerCoaster } from "@/lib/stores/useRollerCoaster";
 import * as THREE from "three";
+import { useTrackEngine } from "@/hooks/useTrackEngine";
+import type { PhysicsEngineInstance } from "@/lib/wasm/physicsEngine";
+import {
+  getTrackProfiles,
+  strokeCurvatureComb,
+  strokeProfile,
+  type ProfileView,
+} from "@/lib/wasm/trackProfiles";
 
 interface Canvas2DEditorProps {
   width?: number;
@@ -68,6 +76,72 @@ function screenToWorld(
   return new THREE.Vector3(x, groundY, z);
 }
 
+// Side profile strip along the bottom of the editor
+const PROFILE_STRIP_HEIGHT = 110;
+const PROFILE_STRIP_PADDING = 15;
+
+/**
+ * Elevation (with its curvature comb) and banking against arc length, from
+ * the engine's cached polylines; the strip only strokes them.
+ */
+function drawProfileStrip(
+  ctx: CanvasRenderingContext2D,
+  engine: PhysicsEngineInstance,
+  heights: number[],
+  width: number,
+  height: number,
+  isNight: boolean
+) {
+  const trackLength = engine.getTrackLength();
+  if (!(trackLength > 0)) return;
+  
+  const top = height - PROFILE_STRIP_HEIGHT;
+  const plotHeight = PROFILE_STRIP_HEIGHT - PROFILE_STRIP_PADDING * 2;
+  const minY = Math.min(0, ...heights);
+  const rangeY = Math.max(10, Math.max(...heights) - minY);
+  
+  const elevationView: ProfileView = {
+    pxPerMeter: (width - 40) / trackLength,
+    pxPerUnitY: plotHeight / rangeY,
+    originX: 20,
+    baselineY: height - PROFILE_STRIP_PADDING + minY * (plotHeight / rangeY),
+  };
+  // +-90 degrees of bank spans the strip
+  const bankingView: ProfileView = {
+    ...elevationView,
+    pxPerUnitY: plotHeight / 180,
+    baselineY: top + PROFILE_STRIP_HEIGHT / 2,
+  };
+  const { elevation, banking, comb } = getTrackProfiles(engine, elevationView, bankingView);
+  
+  ctx.fillStyle = isNight ? 'rgba(15, 23, 42, 0.85)' : 'rgba(255, 255, 255, 0.8)';
+  ctx.fillRect(0, top, width, PROFILE_STRIP_HEIGHT);
+  
+  ctx.lineCap = 'round';
+  ctx.lineJoin = 'round';
+  ctx.strokeStyle = 'rgba(236, 72, 153, 0.4)';
+  ctx.lineWidth = 1;
+  strokeCurvatureComb(ctx, comb, elevationView);
+  
+  ctx.strokeStyle = '#f97316';
+  ctx.lineWidth = 2;
+  strokeProfile(ctx, elevation, elevationView);
+  
+  ctx.strokeStyle = isNight ? '#94a3b8' : '#6366f1';
+  ctx.lineWidth = 1;
+  ctx.setLineDash([4, 3]);
+  strokeProfile(ctx, banking, bankingView);
+  ctx.setLineDash([]);
+  
+  ctx.font = '9px Inter, sans-serif';
+  ctx.textAlign = 'left';
+  ctx.textBaseline = 'top';
+  ctx.fillStyle = '#f97316';
+  ctx.fillText('Elevation', 8, top + 4);
+  ctx.fillStyle = isNight ? '#94a3b8' : '#6366f1';
+  ctx.fillText('Banking', 64, top + 4);
+}
+
 export function Canvas2DEditor({ width, height }: Canvas2DEditorProps) {
   const canvasRef = useRef<HTMLCanvasElement>(null);
   const containerRef = useRef<HTMLDivElement>(null);
@@ -90,6 +164,9 @@ export function Canvas2DEditor({ width, height }: Canvas2DEditorProps) {
     isNightMode,
     mode,
   } = useRollerCoaster();
+  const { engine, version } = useTrackEngine();
+  // The engine model trails an edit by a background build at most
+  const profileEngine = version > 0 && trackPoints.length >= 2 ? engine : null;
   
   // Handle resize
   useEffect(() => {
@@ -346,15 +423,20 @@ export function Canvas2DEditor({ width, height }: Canvas2DEditorProps) {
       ctx.fillText(`${point.position.y.toFixed(1)}m`, screen.x, screen.y + 18);
     }
     
+    if (profileEngine) {
+      drawProfileStrip(ctx, profileEngine, trackPoints.map(p => p.position.y), width, height, isNightMode);
+    }
+    
     // Draw add point indicator when in add mode
     if (isAddingPoints && mode === 'build') {
       ctx.fillStyle = 'rgba(99, 102, 241, 0.5)';
       ctx.font = '12px Inter, sans-serif';
       ctx.textAlign = 'center';
-      ctx.fillText('Click to add point', width / 2, height - 30);
+      ctx.textBaseline = 'alphabetic';
+      ctx.fillText('Click to add point', width / 2, height - 30 - (profileEngine ? PROFILE_STRIP_HEIGHT : 0));
     }
     
-  }, [trackPoints, loopSegments, selectedPointId, hoveredPointId, camera, canvasSize, isNightMode, isAddingPoints, isLooped, mode]);
+  }, [trackPoints, loopSegments, selectedPointId, hoveredPointId, camera, canvasSize, isNightMode, isAddingPoints, isLooped, mode, profileEngine, version]);
   
   // Redraw on changes
   useEffect(() => {
@@ -382,7 +464,8 @@ export function Canvas2DEditor({ width, height }: Canvas2DEditorProps) {
     }
     
     // If in add mode and clicked on empty space, add a point
-    if (isAddingPoints && mode === 'build') {
+    const onProfileStrip = profileEngine !== null && y > canvasSize.height - PROFILE_STRIP_HEIGHT;
+    if (isAddingPoints && mode === 'build' && !onProfileStrip) {
       const worldPos = screenToWorld(x, y, camera, canvasSize.width, canvasSize.height, 2);
       addTrackPoint(worldPos);
       return;
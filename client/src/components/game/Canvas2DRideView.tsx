@@ -12,8 +12,10 @@
  * - Atmospheric lighting effects
  */
 
-import { useRef, useEffect, useState, useCallback } from 'react';
+import { useRef, useEffect, useState, useCallback, useMemo } from 'react';
 import { useRollerCoaster, TrackPoint } from '@/lib/stores/useRollerCoaster';
+import { useTrackEngine } from '@/hooks/useTrackEngine';
+import { COMB_STRIDE, sampleProfile, strokeProfile, type ProfileView } from '@/lib/wasm/trackProfiles';
 import { 
   RollerCoasterPhysics, 
   TrackSpline, 
@@ -89,6 +91,24 @@ export function Canvas2DRideView({ onExit }: Canvas2DRideViewProps) {
   
   const { trackPoints, isLooped, hasChainLift, stopRide, isRiding, isNightMode } = useRollerCoaster();
   
+  // Once the editor engine has settled on this track, the side view draws
+  // its elevation profile and curvature comb against arc length; the JS
+  // spline draws it until then, and without WASM
+  const { engine, stats } = useTrackEngine();
+  const profileEngine = stats ? engine : null;
+  
+  // Arc length at each control point, from the engine's per-span lengths
+  const pointArcLengths = useMemo(() => {
+    if (!profileEngine) return null;
+    const sections = profileEngine.getEnergySections();
+    const lengths = [0];
+    for (let i = 0; i < sections.size(); i++) {
+      lengths.push(lengths[i] + sections.get(i).length);
+    }
+    sections.delete();
+    return lengths;
+  }, [profileEngine, stats]);
+  
   const [physicsData, setPhysicsData] = useState({
     speed: 0,
     speedKmh: 0,
@@ -314,61 +334,136 @@ export function Canvas2DRideView({ onExit }: Canvas2DRideViewProps) {
     ctx.lineCap = 'round';
     ctx.lineJoin = 'round';
     
-    const segments = 200;
-    let prevX = 0, prevY = 0;
+    const pointScreens: { x: number; y: number }[] = [];
+    let car: { x: number; y: number; angle: number } | null = null;
+    const state = physicsRef.current?.getState() ?? null;
+    const trackLength = profileEngine?.getTrackLength() ?? 0;
     
-    // Track shadow/glow layer
-    for (let i = 0; i <= segments; i++) {
-      const t = i / segments;
-      const sample = splineRef.current.getSampleAtProgress(t);
+    if (profileEngine && pointArcLengths && trackLength > 0) {
+      const view: ProfileView = {
+        pxPerMeter: (width - 40) / trackLength,
+        pxPerUnitY: (height - 60) / (maxY - minY),
+        originX: 20,
+        baselineY: scaleY(0),
+      };
+      const elevation = profileEngine.getElevationProfile(view.pxPerMeter, view.pxPerUnitY, 0.5);
+      const comb = profileEngine.getCurvatureComb(view.pxPerMeter, 6);
       
-      const horizontalPos = Math.sqrt(
-        sample.position.x * sample.position.x + 
-        sample.position.z * sample.position.z
-      ) * Math.sign(sample.position.x || sample.position.z || 1);
-      
-      const sx = scaleX(horizontalPos);
-      const sy = scaleY(sample.position.y);
+      // Track glow
+      ctx.shadowColor = '#60a5fa';
+      ctx.shadowBlur = 12;
+      ctx.strokeStyle = '#60a5fa';
+      ctx.lineWidth = 6;
+      ctx.globalAlpha = 0.4;
+      strokeProfile(ctx, elevation, view);
+      ctx.shadowBlur = 0;
+      ctx.globalAlpha = 1;
       
-      if (i > 0) {
-        const estimatedG = 1 + sample.curvature * 10;
-        const color = gForceToColor(estimatedG);
-        
-        // Glow effect
-        ctx.shadowColor = color;
-        ctx.shadowBlur = 12;
-        ctx.strokeStyle = color;
-        ctx.lineWidth = 6;
-        ctx.globalAlpha = 0.4;
+      // Comb teeth colored by the same G estimate as the JS view
+      ctx.lineWidth = 2;
+      for (let i = 0; i < comb.length; i += COMB_STRIDE) {
+        const x = view.originX + comb[i] * view.pxPerMeter;
+        const y = view.baselineY - comb[i + 1] * view.pxPerUnitY;
+        ctx.strokeStyle = gForceToColor(1 + comb[i + 3] * 10);
         ctx.beginPath();
-        ctx.moveTo(prevX, prevY);
-        ctx.lineTo(sx, sy);
+        ctx.moveTo(x, y);
+        ctx.lineTo(x, y - comb[i + 2] * 400);
         ctx.stroke();
+      }
+      
+      // Main track
+      ctx.strokeStyle = '#f1f5f9';
+      ctx.lineWidth = 4;
+      strokeProfile(ctx, elevation, view);
+      
+      for (let i = 0; i < trackPoints.length; i++) {
+        pointScreens.push({
+          x: view.originX + (pointArcLengths[i] ?? 0) * view.pxPerMeter,
+          y: scaleY(trackPoints[i].position.y),
+        });
+      }
+      
+      // The JS ride's progress is a fraction of arc length
+      if (state) {
+        const { value, slope } = sampleProfile(elevation, state.progress * trackLength);
+        car = {
+          x: view.originX + state.progress * trackLength * view.pxPerMeter,
+          y: view.baselineY - value * view.pxPerUnitY,
+          angle: Math.atan2(-slope * view.pxPerUnitY, view.pxPerMeter),
+        };
+      }
+    } else {
+      const segments = 200;
+      let prevX = 0, prevY = 0;
+      
+      // Track shadow/glow layer
+      for (let i = 0; i <= segments; i++) {
+        const t = i / segments;
+        const sample = splineRef.current.getSampleAtProgress(t);
         
-        // Main track
-        ctx.shadowBlur = 0;
-        ctx.globalAlpha = 1;
-        ctx.lineWidth = 4;
-        ctx.beginPath();
-        ctx.moveTo(prevX, prevY);
-        ctx.lineTo(sx, sy);
-        ctx.stroke();
+        const horizontalPos = Math.sqrt(
+          sample.position.x * sample.position.x + 
+          sample.position.z * sample.position.z
+        ) * Math.sign(sample.position.x || sample.position.z || 1);
+        
+        const sx = scaleX(horizontalPos);
+        const sy = scaleY(sample.position.y);
+        
+        if (i > 0) {
+          const estimatedG = 1 + sample.curvature * 10;
+          const color = gForceToColor(estimatedG);
+          
+          // Glow effect
+          ctx.shadowColor = color;
+          ctx.shadowBlur = 12;
+          ctx.strokeStyle = color;
+          ctx.lineWidth = 6;
+          ctx.globalAlpha = 0.4;
+          ctx.beginPath();
+          ctx.moveTo(prevX, prevY);
+          ctx.lineTo(sx, sy);
+          ctx.stroke();
+          
+          // Main track
+          ctx.shadowBlur = 0;
+          ctx.globalAlpha = 1;
+          ctx.lineWidth = 4;
+          ctx.beginPath();
+          ctx.moveTo(prevX, prevY);
+          ctx.lineTo(sx, sy);
+          ctx.stroke();
+        }
+        
+        prevX = sx;
+        prevY = sy;
+      }
+      
+      for (const p of trackPoints) {
+        const horizontalPos = Math.sqrt(p.position.x ** 2 + p.position.z ** 2) * 
+          Math.sign(p.position.x || p.position.z || 1);
+        pointScreens.push({ x: scaleX(horizontalPos), y: scaleY(p.position.y) });
       }
       
-      prevX = sx;
-      prevY = sy;
+      if (state) {
+        const sample = splineRef.current.getSampleAtProgress(state.progress);
+        const horizontalPos = Math.sqrt(
+          sample.position.x ** 2 + sample.position.z ** 2
+        ) * Math.sign(sample.position.x || sample.position.z || 1);
+        car = {
+          x: scaleX(horizontalPos),
+          y: scaleY(sample.position.y),
+          angle: Math.atan2(-sample.tangent.y, 
+            Math.sqrt(sample.tangent.x ** 2 + sample.tangent.z ** 2) * 
+            Math.sign(sample.tangent.x || sample.tangent.z || 1)),
+        };
+      }
     }
     
     ctx.shadowBlur = 0;
     
     // Draw track points with enhanced styling
-    for (let i = 0; i < trackPoints.length; i++) {
-      const p = trackPoints[i];
-      const horizontalPos = Math.sqrt(p.position.x ** 2 + p.position.z ** 2) * 
-        Math.sign(p.position.x || p.position.z || 1);
-      
-      const sx = scaleX(horizontalPos);
-      const sy = scaleY(p.position.y);
+    for (let i = 0; i < pointScreens.length; i++) {
+      const { x: sx, y: sy } = pointScreens[i];
       
       // Point glow
       const pointGlow = ctx.createRadialGradient(sx, sy, 0, sx, sy, 12);
@@ -396,23 +491,12 @@ export function Canvas2DRideView({ onExit }: Canvas2DRideViewProps) {
     }
     
     // Draw car position with enhanced effects
-    if (physicsRef.current) {
-      const state = physicsRef.current.getState();
-      const sample = splineRef.current.getSampleAtProgress(state.progress);
-      
-      const horizontalPos = Math.sqrt(
-        sample.position.x ** 2 + sample.position.z ** 2
-      ) * Math.sign(sample.position.x || sample.position.z || 1);
-      
-      const carX = scaleX(horizontalPos);
-      const carY = scaleY(sample.position.y);
+    if (state && car) {
+      const { x: carX, y: carY, angle } = car;
       
       // Speed trail effect
       if (state.speed > 3) {
         const trailLength = Math.min(state.speed * 2, 40);
-        const angle = Math.atan2(-sample.tangent.y, 
-          Math.sqrt(sample.tangent.x ** 2 + sample.tangent.z ** 2) * 
-          Math.sign(sample.tangent.x || sample.tangent.z || 1));
         
         const trailGrad = ctx.createLinearGradient(
           carX - Math.cos(angle) * trailLength,
@@ -464,10 +548,6 @@ export function Canvas2DRideView({ onExit }: Canvas2DRideViewProps) {
       ctx.fill();
       
       // Direction indicator with glow
-      const angle = Math.atan2(-sample.tangent.y, 
-        Math.sqrt(sample.tangent.x ** 2 + sample.tangent.z ** 2) * 
-        Math.sign(sample.tangent.x || sample.tangent.z || 1));
-      
       ctx.shadowColor = '#fbbf24';
       ctx.shadowBlur = 6;
       ctx.strokeStyle = '#fbbf24';
@@ -483,7 +563,7 @@ export function Canvas2DRideView({ onExit }: Canvas2DRideViewProps) {
       ctx.shadowBlur = 0;
     }
     
-  }, [trackPoints, isNightMode]);
+  }, [trackPoints, isNightMode, profileEngine, pointArcLengths]);
   
   // Draw first-person view with enhanced visuals
   const drawFirstPersonView = useCallback((ctx: CanvasRenderingContext2D, width: number, height: number) => {
@@ -1,6 +1,7 @@
 import { useState, useRef, useMemo } from "react";
 import { useRollerCoaster } from "@/lib/stores/useRollerCoaster";
 import { useKeyboardShortcuts, KEYBOARD_SHORTCUTS } from "@/hooks/useKeyboardShortcuts";
+import { useTrackEngine } from "@/hooks/useTrackEngine";
 import { computeTrackStats, formatTime, formatDistance } from "@/lib/trackUtils";
 import { Button } from "@/components/ui/button";
 import { MiniMap } from "./MiniMap";
@@ -173,10 +174,12 @@ export function GameUI({ use2DMode = false, onToggle2DMode }: GameUIProps) {
   const fileInputRef = useRef<HTMLInputElement>(null);
   const dragOffset = useRef({ x: 0, y: 0 });
   
-  // Compute track statistics
+  // Compute track statistics; exact once the shared engine has ridden this
+  // version, JS estimates until then
+  const { stats: nativeStats } = useTrackEngine();
   const trackStats = useMemo(() => {
-    return computeTrackStats(trackPoints, loopSegments, isLooped);
-  }, [trackPoints, loopSegments, isLooped]);
+    return computeTrackStats(trackPoints, loopSegments, isLooped, nativeStats);
+  }, [trackPoints, loopSegments, isLooped, nativeStats]);
   
   // Get selected point info
   const selectedPoint = useMemo(() => {
@@ -343,7 +346,7 @@ export function GameUI({ use2DMode = false, onToggle2DMode }: GameUIProps) {
                 </div>
                 <div className="stat-card">
                   <div className="text-[9px] text-slate-400 uppercase tracking-wider">Est. Time</div>
-                  <div className="text-sm font-bold text-purple-400">{formatTime(trackStats.estimatedRideTime)}</div>
+                  <div className="text-sm font-bold text-purple-400">{trackStats.estimatedRideTime > 0 ? formatTime(trackStats.estimatedRideTime) : "—"}</div>
                 </div>
               </div>
               {trackStats.problems.length > 0 && (
@@ -889,8 +892,8 @@ export function GameUI({ use2DMode = false, onToggle2DMode }: GameUIProps) {
                       </span>
                     </div>
                     <div className="text-[10px] text-slate-400 mb-3 flex gap-2 flex-wrap">
-                      <span className="px-2 py-0.5 bg-indigo-500/20 rounded-full">{coaster.trackPoints.length} points</span>
-                      {coaster.loopSegments?.length > 0 && <span className="px-2 py-0.5 bg-pink-500/20 rounded-full">{coaster.loopSegments.length} loops</span>}
+                      <span className="px-2 py-0.5 bg-indigo-500/20 rounded-full">{coaster.pointCount ?? coaster.trackPoints?.length ?? 0} points</span>
+                      {(coaster.loopCount ?? coaster.loopSegments?.length ?? 0) > 0 && <span className="px-2 py-0.5 bg-pink-500/20 rounded-full">{coaster.loopCount ?? coaster.loopSegments?.length} loops</span>}
                       {coaster.isLooped && <span className="px-2 py-0.5 bg-purple-500/20 rounded-full">Closed</span>}
                     </div>
                     <div className="flex gap-2">
@@ -2,6 +2,13 @@ import React, { useMemo, useRef, useEffect, useCallback } from 'react';
 import { useRollerCoaster } from '../../lib/stores/useRollerCoaster';
 import * as THREE from 'three';
 import { CatmullRomCurve3 } from 'three';
+import { useTrackEngine } from '../../hooks/useTrackEngine';
+import { MINIMAP_STRIDE, strokeMinimap } from '../../lib/wasm/trackProfiles';
+
+// Canvas pixels around the drawn area
+const MAP_MARGIN = 20;
+// Outline simplification, in canvas pixels
+const OUTLINE_TOLERANCE_PX = 0.5;
 
 interface MiniMapProps {
   size?: number;
@@ -17,6 +24,7 @@ function seededRandom(seed: number): number {
 export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
   const canvasRef = useRef<HTMLCanvasElement>(null);
   const { trackPoints, selectedPointId, rideProgress, mode, isNightMode, loopSegments } = useRollerCoaster();
+  const { engine, version, stats } = useTrackEngine();
   
   // Pre-generate decorations for the minimap (stable positions)
   const decorations = useMemo(() => {
@@ -93,15 +101,40 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
       curve = new CatmullRomCurve3(points3D, false, 'centripetal', 0.5);
     }
     
+    let minHeight = Infinity, maxHeight = -Infinity;
+    for (const p of trackPoints) {
+      minHeight = Math.min(minHeight, p.position.y);
+      maxHeight = Math.max(maxHeight, p.position.y);
+    }
+    
     return {
       minX, maxX, minZ, maxZ,
       rangeX, rangeZ, scale,
       centerX: (minX + maxX) / 2,
       centerZ: (minZ + maxZ) / 2,
-      curve
+      curve,
+      minHeight,
+      heightRange: maxHeight - minHeight || 1,
     };
   }, [trackPoints]);
   
+  // Outline as [x, z, height, speed] per vertex, fetched once per edit so
+  // redraws during a ride only move the car. The engine's outline carries
+  // its ride, so like the stats it waits for edits to settle; the JS
+  // spline stands in until then, and without WASM.
+  const outline = useMemo((): Float32Array | null => {
+    if (!trackData) return null;
+    if (engine && stats) {
+      const metersPerPx = trackData.scale / (size - MAP_MARGIN * 2);
+      return engine.getMinimapPolyline(OUTLINE_TOLERANCE_PX * metersPerPx);
+    }
+    if (!trackData.curve) return null;
+    const points = trackData.curve.getPoints(Math.max(50, trackPoints.length * 10));
+    const packed = new Float32Array(points.length * MINIMAP_STRIDE);
+    points.forEach((p, i) => packed.set([p.x, p.z, p.y, 0], i * MINIMAP_STRIDE));
+    return packed;
+  }, [trackData, engine, version, stats, size, trackPoints.length]);
+  
   // Draw on canvas
   useEffect(() => {
     const canvas = canvasRef.current;
@@ -153,7 +186,7 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
       ctx.fillText(`${trackPoints.length}pts`, size - 20, 13);
     }
     
-    const margin = 20;
+    const margin = MAP_MARGIN;
     const drawSize = size - margin * 2;
     const defaultScale = 200;
     
@@ -271,9 +304,7 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
     }
     
     // Draw track curve with glow effect
-    if (curve) {
-      const samples = Math.max(50, trackPoints.length * 10);
-      
+    if (outline && outline.length >= 2 * MINIMAP_STRIDE) {
       // Outer glow
       ctx.strokeStyle = 'rgba(96, 165, 250, 0.3)';
       ctx.lineWidth = 6;
@@ -281,10 +312,8 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
       ctx.lineJoin = 'round';
       ctx.beginPath();
       
-      for (let i = 0; i <= samples; i++) {
-        const t = i / samples;
-        const point = curve.getPoint(t);
-        const canvasPoint = toCanvas(point.x, point.z);
+      for (let i = 0; i < outline.length; i += MINIMAP_STRIDE) {
+        const canvasPoint = toCanvas(outline[i], outline[i + 1]);
         
         if (i === 0) {
           ctx.moveTo(canvasPoint.x, canvasPoint.y);
@@ -294,30 +323,18 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
       }
       ctx.stroke();
       
-      // Main track line with gradient based on height
+      // Main track line with gradient based on height; loop tops can rise
+      // above every control point
+      const minHeight = stats ? stats.minHeight : trackData.minHeight;
+      const heightRange = stats ? stats.maxHeight - stats.minHeight || 1 : trackData.heightRange;
       ctx.lineWidth = 3;
-      for (let i = 0; i < samples; i++) {
-        const t1 = i / samples;
-        const t2 = (i + 1) / samples;
-        const p1 = curve.getPoint(t1);
-        const p2 = curve.getPoint(t2);
-        
-        const avgHeight = (p1.y + p2.y) / 2;
-        const maxHeight = Math.max(...trackPoints.map(p => p.position.y));
-        const minHeight = Math.min(...trackPoints.map(p => p.position.y));
-        const heightRange = maxHeight - minHeight || 1;
-        const normalizedHeight = (avgHeight - minHeight) / heightRange;
+      strokeMinimap(ctx, outline, toCanvas, (height) => {
+        const normalizedHeight = Math.min(1, Math.max(0, (height - minHeight) / heightRange));
         
         // Beautiful gradient from cyan (low) through purple to magenta (high)
         const hue = 180 - normalizedHeight * 120; // 180 (cyan) to 60 (yellow)
-        ctx.strokeStyle = `hsla(${hue}, 80%, 60%, 0.8)`;
-        ctx.beginPath();
-        const cp1 = toCanvas(p1.x, p1.z);
-        const cp2 = toCanvas(p2.x, p2.z);
-        ctx.moveTo(cp1.x, cp1.y);
-        ctx.lineTo(cp2.x, cp2.y);
-        ctx.stroke();
-      }
+        return `hsla(${hue}, 80%, 60%, 0.8)`;
+      });
     }
     
     // Draw track points with enhanced styling
@@ -461,7 +478,7 @@ export function MiniMap({ size = 150, className = '' }: MiniMapProps) {
     // Draw legend
     drawLegend(ctx, size, isNightMode);
     
-  }, [trackPoints, trackData, selectedPointId, rideProgress, mode, size, isNightMode, decorations, loopSegments]);
+  }, [trackPoints, trackData, outline, stats, selectedPointId, rideProgress, mode, size, isNightMode, decorations, loopSegments]);
   
   return (
     <canvas
@@ -7,11 +7,30 @@
  * - Loop whoosh
  * - Track rattling
  * - UI sounds
+ *
+ * Ride sounds follow the audio control stream of a private ride engine
+ * (useRideEngine). Each update puts the engine where the ride camera is and
+ * simulates a short window ahead; every control frame in it is scheduled on
+ * the audio clock, so wind, clicks and rattle keep going when rendering
+ * drops frames. Loop and airtime whooshes are played from the engine's ride
+ * events, drained once per update and placed at their simulated times.
+ * Without WASM they fall back to estimates from the playback rate.
  */
 
-import { useEffect, useRef, useCallback } from "react";
+import { useEffect, useRef, useCallback, useMemo } from "react";
 import { useRollerCoaster } from "@/lib/stores/useRollerCoaster";
 import { useAudio } from "@/lib/stores/useAudio";
+import { useRideEngine } from "@/hooks/useRideEngine";
+import { buildTrackSections, toSplineProgress } from "@/lib/trackUtils";
+import { ControlChannel, ControlStreamReader } from "@/lib/wasm/controlStream";
+import { RideEventType, toRideEvents } from "@/lib/wasm/physicsEngine";
+
+const CONTROL_RATE_HZ = 200;
+// Each update simulates this far ahead of the audio clock
+const LOOKAHEAD_S = 0.25;
+const WINDOW_FRAMES = Math.round(LOOKAHEAD_S * CONTROL_RATE_HZ);
+// Per control frame; about what 0.3 per 60 Hz render update gave
+const RATTLE_CHANCE = 0.3 * 60 / CONTROL_RATE_HZ;
 
 // Web Audio API types
 interface SoundEffectsState {
@@ -25,6 +44,15 @@ interface SoundEffectsState {
   lastClickTime: number;
 }
 
+// The window of control frames last scheduled on the audio clock
+interface ControlSchedule {
+  reader: ControlStreamReader;
+  anchorTime: number;    // audio time the window starts at
+  simTime: number;       // engine simulation time at the end of the window
+  horizon: number;       // audio time one-shots are scheduled up to
+  speeds: Float32Array;  // engine speed at the anchor and after each frame
+}
+
 // Generate white noise buffer
 function createNoiseBuffer(audioContext: AudioContext, duration: number): AudioBuffer {
   const sampleRate = audioContext.sampleRate;
@@ -99,8 +127,15 @@ function createRattleBuffer(audioContext: AudioContext): AudioBuffer {
 }
 
 export function SoundEffects() {
-  const { isRiding, rideProgress, rideSpeed, hasChainLift, loopSegments, trackPoints } = useRollerCoaster();
+  const { isRiding, rideProgress, rideSpeed, hasChainLift, loopSegments, trackPoints, isLooped } = useRollerCoaster();
   const { isMuted } = useAudio();
+  const engine = useRideEngine();
+  
+  const { sections, totalArcLength } = useMemo(
+    () => buildTrackSections(trackPoints, loopSegments, isLooped),
+    [trackPoints, loopSegments, isLooped]
+  );
+  const controlScheduleRef = useRef<ControlSchedule | null>(null);
   
   const stateRef = useRef<SoundEffectsState>({
     audioContext: null,
@@ -194,8 +229,8 @@ export function SoundEffects() {
     }
   }, [isMuted]);
   
-  // Play one-shot sound
-  const playSound = useCallback((buffer: AudioBuffer | null, volume: number = 1) => {
+  // Play one-shot sound, now or at an audio-clock time
+  const playSound = useCallback((buffer: AudioBuffer | null, volume: number = 1, when: number = 0) => {
     if (!stateRef.current.audioContext || !stateRef.current.masterGain || !buffer || isMuted) {
       return;
     }
@@ -209,9 +244,93 @@ export function SoundEffects() {
     source.connect(gain);
     gain.connect(stateRef.current.masterGain);
     
-    source.start();
+    source.start(when);
   }, [isMuted]);
   
+  // A new ride engine starts a new schedule
+  useEffect(() => {
+    controlScheduleRef.current = null;
+  }, [engine]);
+  
+  // Put the engine where the ride camera is and schedule the next
+  // LOOKAHEAD_S of control frames. Returns false without an engine.
+  const scheduleControlStream = useCallback((progress: number): boolean => {
+    const state = stateRef.current;
+    if (!engine || !state.audioContext || !state.windGain || totalArcLength <= 0) return false;
+    
+    const now = state.audioContext.currentTime;
+    let schedule = controlScheduleRef.current;
+    if (!schedule) {
+      schedule = {
+        reader: new ControlStreamReader(engine.getControlFramesView(), engine.getControlHeadView()),
+        anchorTime: now,
+        simTime: 0,
+        horizon: now,
+        speeds: new Float32Array(WINDOW_FRAMES + 1).fill(engine.getSpeed()),
+      };
+      controlScheduleRef.current = schedule;
+    } else if (schedule.reader.isDetached()) {
+      schedule.reader = new ControlStreamReader(engine.getControlFramesView(), engine.getControlHeadView());
+    }
+    
+    // The engine's own speed at this moment, from the previous window
+    const elapsed = Math.round((now - schedule.anchorTime) * CONTROL_RATE_HZ);
+    const speed = schedule.speeds[Math.max(0, Math.min(WINDOW_FRAMES, elapsed))];
+    
+    // Restarting the rate puts frame i exactly i control intervals after now
+    engine.setControlRate(CONTROL_RATE_HZ);
+    engine.setProgress(toSplineProgress(progress, sections));
+    engine.setSpeed(speed);
+    while (schedule.reader.available() > 0) schedule.reader.next();
+    
+    const wind = state.windGain.gain;
+    wind.cancelScheduledValues(now);
+    wind.setValueAtTime(wind.value, now);
+    schedule.speeds[0] = speed;
+    
+    for (let i = 1; i <= WINDOW_FRAMES; i++) {
+      engine.step(1 / CONTROL_RATE_HZ);
+      let frame = schedule.reader.next();
+      while (schedule.reader.available() > 0) frame = schedule.reader.next();
+      
+      const time = now + i / CONTROL_RATE_HZ;
+      schedule.speeds[i] = frame[ControlChannel.SPEED];
+      wind.linearRampToValueAtTime(Math.min(1, Math.abs(frame[ControlChannel.SPEED]) / 25), time);
+      
+      // The previous window already scheduled one-shots up to its horizon
+      if (time <= schedule.horizon) continue;
+      
+      // Chain lift clicks
+      if (frame[ControlChannel.CHAIN_LIFT] > 0.5 && time - state.lastClickTime > 0.15) {
+        playSound(state.clickBuffer, 0.3, time);
+        state.lastClickTime = time;
+      }
+      
+      // Track rattling at high speeds and through tight curves
+      const wheelNoise = frame[ControlChannel.WHEEL_NOISE];
+      if (wheelNoise > 0.5 && time - state.lastClickTime > 0.08 && Math.random() < RATTLE_CHANCE) {
+        playSound(state.rattleBuffer, wheelNoise * 0.3, time);
+      }
+    }
+    
+    // Events carry simulation time; the window started at `now`
+    const windowStart = schedule.simTime;
+    for (const event of toRideEvents(engine.drainEvents())) {
+      const time = now + (event.time - windowStart);
+      if (time <= schedule.horizon) continue;
+      if (event.type === RideEventType.LOOP_ENTER) {
+        playSound(state.whooshBuffer, 0.5, time);
+      } else if (event.type === RideEventType.AIRTIME_START) {
+        playSound(state.whooshBuffer, 0.25, time);
+      }
+    }
+    
+    schedule.anchorTime = now;
+    schedule.simTime += WINDOW_FRAMES / CONTROL_RATE_HZ;
+    schedule.horizon = Math.max(schedule.horizon, now + WINDOW_FRAMES / CONTROL_RATE_HZ);
+    return true;
+  }, [engine, sections, totalArcLength, playSound]);
+  
   // Update sounds based on ride state
   useEffect(() => {
     if (!stateRef.current.audioContext || !stateRef.current.windGain) return;
@@ -220,46 +339,48 @@ export function SoundEffects() {
     const now = state.audioContext!.currentTime;
     
     if (isRiding) {
-      // Wind volume based on speed
-      const windVolume = Math.min(1, rideSpeed * 0.3);
-      state.windGain!.gain.setTargetAtTime(windVolume, now, 0.1);
-      
-      // Chain lift clicks
-      if (hasChainLift && rideProgress < 0.2) {
-        const clickInterval = 0.15; // seconds between clicks
-        if (now - state.lastClickTime > clickInterval) {
-          playSound(state.clickBuffer, 0.3);
-          state.lastClickTime = now;
+      if (!scheduleControlStream(rideProgress)) {
+        // Wind volume based on speed
+        state.windGain!.gain.setTargetAtTime(Math.min(1, rideSpeed * 0.3), now, 0.1);
+        
+        // Chain lift clicks
+        if (hasChainLift && rideProgress < 0.2) {
+          const clickInterval = 0.15; // seconds between clicks
+          if (now - state.lastClickTime > clickInterval) {
+            playSound(state.clickBuffer, 0.3);
+            state.lastClickTime = now;
+          }
         }
-      }
-      
-      // Check if entering a loop
-      if (loopSegments.length > 0 && trackPoints.length > 0) {
-        const segments = trackPoints.length;
-        const currentIndex = Math.floor(rideProgress * segments);
-        const currentPoint = trackPoints[currentIndex];
         
-        if (currentPoint?.hasLoop && !wasInLoopRef.current) {
-          playSound(state.whooshBuffer, 0.5);
-          wasInLoopRef.current = true;
-        } else if (!currentPoint?.hasLoop) {
-          wasInLoopRef.current = false;
+        // Track rattling at high speeds
+        if (rideSpeed > 1.5 && now - state.lastClickTime > 0.08) {
+          if (Math.random() < 0.3) {
+            playSound(state.rattleBuffer, rideSpeed * 0.1);
+          }
         }
-      }
-      
-      // Track rattling at high speeds
-      if (rideSpeed > 1.5 && now - state.lastClickTime > 0.08) {
-        if (Math.random() < 0.3) {
-          playSound(state.rattleBuffer, rideSpeed * 0.1);
+        
+        // Check if entering a loop
+        if (loopSegments.length > 0 && trackPoints.length > 0) {
+          const segments = trackPoints.length;
+          const currentIndex = Math.floor(rideProgress * segments);
+          const currentPoint = trackPoints[currentIndex];
+          
+          if (currentPoint?.hasLoop && !wasInLoopRef.current) {
+            playSound(state.whooshBuffer, 0.5);
+            wasInLoopRef.current = true;
+          } else if (!currentPoint?.hasLoop) {
+            wasInLoopRef.current = false;
+          }
         }
       }
     } else {
       // Fade out wind when not riding
+      state.windGain!.gain.cancelScheduledValues(now);
       state.windGain!.gain.setTargetAtTime(0, now, 0.3);
     }
     
     lastProgressRef.current = rideProgress;
-  }, [isRiding, rideSpeed, rideProgress, hasChainLift, loopSegments, trackPoints, playSound]);
+  }, [isRiding, rideSpeed, rideProgress, hasChainLift, loopSegments, trackPoints, playSound, scheduleControlStream]);
   
   // This component doesn't render anything visible
   return null;
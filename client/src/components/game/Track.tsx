@@ -8,9 +8,16 @@ import {
   type RailSample,
   type BarrelRollFrame,
 } from "@/lib/trackUtils";
+import { useTrackEngine } from "@/hooks/useTrackEngine";
+import { VertexAttribute } from "@/lib/wasm/physicsEngine";
+
+// Rail vertices per control-point span; getVertexAttribute lays its
+// buffer out the same way
+const RAIL_SAMPLES_PER_SEGMENT = 20;
 
 export function Track() {
-  const { trackPoints, loopSegments, isLooped, showWoodSupports, isNightMode } = useRollerCoaster();
+  const { trackPoints, loopSegments, isLooped, showWoodSupports, isNightMode, showDebugOverlay } = useRollerCoaster();
+  const { engine, version, stats } = useTrackEngine();
   
   const { railData, woodSupports, trackLights } = useMemo(() => {
     if (trackPoints.length < 2) {
@@ -26,7 +33,7 @@ export function Track() {
     }
     
     const railData: RailSample[] = [];
-    const numSamplesPerSegment = 20;
+    const numSamplesPerSegment = RAIL_SAMPLES_PER_SEGMENT;
     const numTrackPoints = trackPoints.length;
     const totalSplineSegments = isLooped ? numTrackPoints : numTrackPoints - 1;
     
@@ -237,6 +244,22 @@ export function Track() {
     return { railData, woodSupports, trackLights };
   }, [trackPoints, loopSegments, isLooped]);
   
+  // Debug view: rails tinted by total G from the native ride, green at 1 G
+  // to red at 4 G like the overlay's heatmap. Waits for the settled stats,
+  // so dragging a point never runs the ride.
+  const railColors = useMemo(() => {
+    if (!showDebugOverlay || !engine || !stats) return null;
+    const gTotal = engine.getVertexAttribute(VertexAttribute.G_TOTAL, RAIL_SAMPLES_PER_SEGMENT);
+    if (gTotal.length !== railData.length) return null;
+    
+    const color = new THREE.Color();
+    return Array.from(gTotal, (g): [number, number, number] => {
+      const normalizedG = Math.min(1, Math.max(0, (g - 1) / 3));
+      color.setHSL((120 - normalizedG * 120) / 360, 1, 0.5);
+      return [color.r, color.g, color.b];
+    });
+  }, [showDebugOverlay, engine, version, stats, railData]);
+  
   if (railData.length < 2) {
     return null;
   }
@@ -267,12 +290,14 @@ export function Track() {
     <group>
       <Line
         points={leftRail}
-        color="#ff4444"
+        color={railColors ? "#ffffff" : "#ff4444"}
+        vertexColors={railColors ?? undefined}
         lineWidth={4 * TRACK_SCALE}
       />
       <Line
         points={rightRail}
-        color="#ff4444"
+        color={railColors ? "#ffffff" : "#ff4444"}
+        vertexColors={railColors ?? undefined}
         lineWidth={4 * TRACK_SCALE}
       />
       
@@ -2,7 +2,10 @@
  * usePhysicsSimulation Hook
  * 
  * Provides accurate roller coaster physics simulation
- * Pure JavaScript - no WASM or WebGL required for physics calculations
+ * Pure JavaScript - no WASM or WebGL required for physics calculations.
+ * On cross-origin isolated pages the ride is stepped instead by the
+ * threaded native engine on its own worker (ThreadedPhysicsHost), and the
+ * frame loop only samples its state ring.
  * 
  * Physics features:
  * - Energy conservation
@@ -22,6 +25,12 @@ import {
   PHYSICS_CONSTANTS,
   PhysicsState,
 } from '@/lib/physics/PhysicsEngine';
+import { toNativeTrackPoints } from '@/lib/trackUtils';
+import { ThreadedPhysicsHost, type InterpolatedPhysicsState } from '@/lib/wasm/engineHost';
+import { isThreadedWasmSupported, loadThreadedPhysicsEngine } from '@/lib/wasm/physicsEngine';
+
+// Fixed step rate of the threaded engine's simulation thread
+const THREADED_RATE_HZ = 120;
 
 export interface PhysicsData {
   // Speed
@@ -125,6 +134,51 @@ function convertTrackPoints(trackPoints: TrackPoint[]): TrackPointInput[] {
   }));
 }
 
+const TRAIN_MASS = PHYSICS_CONSTANTS.CAR_MASS + PHYSICS_CONSTANTS.PASSENGER_MASS * PHYSICS_CONSTANTS.PASSENGERS;
+
+/**
+ * Convert a state sampled from the threaded engine to PhysicsData. The
+ * tangential acceleration and distance come from the previous sample; the
+ * simulation thread does not publish curvature.
+ */
+function threadedPhysicsData(
+  state: InterpolatedPhysicsState,
+  previous: InterpolatedPhysicsState | null,
+  arcLength: number
+): PhysicsData {
+  const g = PHYSICS_CONSTANTS.GRAVITY;
+  const elapsed = previous ? state.simTime - previous.simTime : 0;
+  const tangentAccel = previous && elapsed > 0 ? (state.speed - previous.speed) / elapsed : 0;
+  const { x, y, z } = state.velocity;
+  const velocityLength = Math.sqrt(x * x + y * y + z * z);
+  const kineticEnergy = 0.5 * TRAIN_MASS * state.speed * state.speed;
+  const potentialEnergy = TRAIN_MASS * g * state.height;
+  
+  return {
+    speed: state.speed,
+    speedKmh: state.speed * 3.6,
+    speedMph: state.speed * 2.23694,
+    gForceVertical: state.gForceVertical,
+    gForceLateral: state.gForceLateral,
+    gForceLongitudinal: -tangentAccel / g,
+    gForceTotal: state.gForceTotal,
+    height: state.height,
+    progress: state.progress,
+    arcLength,
+    grade: velocityLength > 0 ? (y / velocityLength) * 100 : 0,
+    curvature: 0,
+    bankAngle: state.bankAngle,
+    isOnChainLift: state.isOnChainLift,
+    isInLoop: state.isInLoop,
+    isAirtime: state.gForceVertical < 0.5,
+    isBraking: false,
+    kineticEnergy,
+    potentialEnergy,
+    totalEnergy: kineticEnergy + potentialEnergy,
+    acceleration: Math.abs(tangentAccel),
+  };
+}
+
 /**
  * Main physics simulation hook
  */
@@ -151,6 +205,9 @@ export function usePhysicsSimulation(): PhysicsSimulationResult {
   const animationFrameId = useRef<number | null>(null);
   const lastTime = useRef(performance.now());
   const isInitialized = useRef(false);
+  
+  // Threaded engine for the current ride, once loaded
+  const threadedHost = useRef<ThreadedPhysicsHost | null>(null);
 
   // Initialize physics engine
   useEffect(() => {
@@ -173,7 +230,9 @@ export function usePhysicsSimulation(): PhysicsSimulationResult {
     physicsEngine.current.setTrack(points, isLooped);
     physicsEngine.current.setChainLift(hasChainLift);
     
-  }, [trackPoints, isLooped, hasChainLift]);
+    threadedHost.current?.setTrack(toNativeTrackPoints(trackPoints, loopSegments), isLooped);
+    threadedHost.current?.setChainLift(hasChainLift);
+  }, [trackPoints, loopSegments, isLooped, hasChainLift]);
 
   // Main simulation loop
   useEffect(() => {
@@ -192,11 +251,48 @@ export function usePhysicsSimulation(): PhysicsSimulationResult {
     physicsEngine.current.reset();
     physicsEngine.current.setSpeed(rideSpeed || 1);
     lastTime.current = performance.now();
+    
+    // The threaded engine takes over once it loads; the JS engine waits
+    // for it rather than start a ride it would have to hand over
+    let cancelled = false;
+    let threadedPending = isThreadedWasmSupported();
+    let previousSample: InterpolatedPhysicsState | null = null;
+    let travelled = 0;
+    if (threadedPending) {
+      loadThreadedPhysicsEngine()
+        .then(module => {
+          if (cancelled) return;
+          const host = new ThreadedPhysicsHost(module);
+          host.setTrack(toNativeTrackPoints(trackPoints, loopSegments), isLooped);
+          host.setChainLift(hasChainLift);
+          host.reset();
+          host.start(THREADED_RATE_HZ);
+          threadedHost.current = host;
+          threadedPending = false;
+        })
+        .catch(() => {
+          // JS physics starts from here
+          threadedPending = false;
+          lastTime.current = performance.now();
+        });
+    }
 
     const updatePhysics = () => {
       if (!physicsEngine.current || !isRiding) return;
       
       const now = performance.now();
+      
+      if (threadedPending || threadedHost.current) {
+        const sample = threadedHost.current?.sample(now) ?? null;
+        if (sample) {
+          if (previousSample) travelled += Math.abs(sample.speed) * Math.max(0, sample.simTime - previousSample.simTime);
+          setPhysicsData(threadedPhysicsData(sample, previousSample, travelled));
+          previousSample = sample;
+        }
+        animationFrameId.current = requestAnimationFrame(updatePhysics);
+        return;
+      }
+      
       const dt = Math.min((now - lastTime.current) / 1000, 0.05); // Cap at 50ms
       lastTime.current = now;
       
@@ -247,6 +343,9 @@ export function usePhysicsSimulation(): PhysicsSimulationResult {
     animationFrameId.current = requestAnimationFrame(updatePhysics);
 
     return () => {
+      cancelled = true;
+      threadedHost.current?.dispose();
+      threadedHost.current = null;
       if (animationFrameId.current) {
         cancelAnimationFrame(animationFrameId.current);
         animationFrameId.current = null;
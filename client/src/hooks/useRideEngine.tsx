@@ -0,0 +1,53 @@
+/**
+ * useRideEngine Hook
+ *
+ * A private native engine for the duration of a ride, loaded from the
+ * ride-only core build (loadRideEngine). Unlike the shared editor engine
+ * (useTrackEngine), the caller owns it: stepping, seeking and resetting it
+ * never moves anyone else's train. It is built on the track in the store
+ * when the ride starts and deleted when the ride ends.
+ */
+
+import { useEffect, useState } from 'react';
+import { useRollerCoaster } from '@/lib/stores/useRollerCoaster';
+import { toNativeTrackPoints } from '@/lib/trackUtils';
+import {
+  createTrackPointDataVector,
+  loadRideEngine,
+  type RideEngineInstance,
+} from '@/lib/wasm/physicsEngine';
+
+export function useRideEngine(): RideEngineInstance | null {
+  const { isRiding, trackPoints, loopSegments, isLooped, hasChainLift } = useRollerCoaster();
+  const [engine, setEngine] = useState<RideEngineInstance | null>(null);
+
+  useEffect(() => {
+    if (!isRiding || trackPoints.length < 2) return;
+
+    let cancelled = false;
+    let instance: RideEngineInstance | null = null;
+
+    loadRideEngine().then(
+      module => {
+        if (cancelled) return;
+        instance = new module.PhysicsEngine();
+        const points = createTrackPointDataVector(module, toNativeTrackPoints(trackPoints, loopSegments));
+        instance.setTrack(points, isLooped);
+        points.delete();
+        instance.setChainLift(hasChainLift);
+        instance.reset();
+        setEngine(instance);
+      },
+      // Callers keep their JS estimates
+      () => {}
+    );
+
+    return () => {
+      cancelled = true;
+      setEngine(null);
+      instance?.delete();
+    };
+  }, [isRiding, trackPoints, loopSegments, isLooped, hasChainLift]);
+
+  return engine;
+}
@@ -0,0 +1,64 @@
+/**
+ * useTrackEngine Hook
+ *
+ * Keeps the shared editor engine (lib/wasm/trackEngine.ts) on the track in
+ * the store and re-renders when a new model or its stats land. Any number
+ * of components can use it; each edit is submitted once. The full engine
+ * is loaded the first time the editor is open (build mode), so a page that
+ * only rides never downloads it; JS estimates cover the time until then.
+ */
+
+import { useEffect, useSyncExternalStore } from 'react';
+import { useRollerCoaster, TrackPoint, LoopSegment } from '@/lib/stores/useRollerCoaster';
+import { toNativeTrackPoints } from '@/lib/trackUtils';
+import type { NativeTrackPointInput } from '@/lib/wasm/physicsEngine';
+import {
+  getTrackEngineSnapshot,
+  setEditorTrack,
+  startTrackEngine,
+  subscribeTrackEngine,
+  type TrackEngineSnapshot,
+} from '@/lib/wasm/trackEngine';
+
+let synced: {
+  trackPoints: TrackPoint[];
+  loopSegments: LoopSegment[];
+  isLooped: boolean;
+  hasChainLift: boolean;
+  points: NativeTrackPointInput[];
+} | null = null;
+
+function syncEditorTrack(
+  trackPoints: TrackPoint[],
+  loopSegments: LoopSegment[],
+  isLooped: boolean,
+  hasChainLift: boolean
+): void {
+  const sameShape = synced !== null && synced.trackPoints === trackPoints && synced.loopSegments === loopSegments;
+  if (sameShape && synced!.isLooped === isLooped && synced!.hasChainLift === hasChainLift) return;
+  
+  // A chain-lift toggle reuses the points, so the model isn't rebuilt
+  const points = sameShape ? synced!.points : toNativeTrackPoints(trackPoints, loopSegments);
+  synced = { trackPoints, loopSegments, isLooped, hasChainLift, points };
+  setEditorTrack(points, isLooped, hasChainLift);
+}
+
+export function useTrackEngine(): TrackEngineSnapshot {
+  const { mode, trackPoints, loopSegments, isLooped, hasChainLift } = useRollerCoaster();
+  
+  useEffect(() => {
+    if (mode === 'build') void startTrackEngine();
+  }, [mode]);
+  
+  useEffect(() => {
+    syncEditorTrack(trackPoints, loopSegments, isLooped, hasChainLift);
+  }, [trackPoints, loopSegments, isLooped, hasChainLift]);
+  
+  const snapshot = useSyncExternalStore(subscribeTrackEngine, getTrackEngineSnapshot);
+  
+  // Until the effect above submits an edit, published stats describe the
+  // previous track
+  const current = synced !== null && synced.trackPoints === trackPoints && synced.loopSegments === loopSegments &&
+    synced.isLooped === isLooped && synced.hasChainLift === hasChainLift;
+  return current || !snapshot.stats ? snapshot : { ...snapshot, stats: null };
+}
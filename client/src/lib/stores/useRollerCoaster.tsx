@@ -1,6 +1,9 @@
 import { create } from "zustand";
 import { subscribeWithSelector } from "zustand/middleware";
 import * as THREE from "three";
+import { base64ToBytes, bytesToBase64, decodeTrack, encodeTrack } from "../wasm/trackCodec";
+import { openSavedEditorTrack } from "../wasm/trackEngine";
+import { deleteStoredTables } from "../wasm/trackTables";
 
 export type CoasterMode = "build" | "ride" | "preview";
 
@@ -41,7 +44,7 @@ export interface TrackPoint {
 }
 
 // Serializable versions for JSON storage
-interface SerializedLoopSegment {
+export interface SerializedLoopSegment {
   id: string;
   entryPointId: string;
   elementType?: TrackElementType;
@@ -51,7 +54,7 @@ interface SerializedLoopSegment {
   direction?: 'left' | 'right';
 }
 
-interface SerializedTrackPoint {
+export interface SerializedTrackPoint {
   id: string;
   position: [number, number, number];
   tilt: number;
@@ -63,8 +66,13 @@ export interface SavedCoaster {
   id: string;
   name: string;
   timestamp: number;
-  trackPoints: SerializedTrackPoint[];
-  loopSegments: SerializedLoopSegment[];
+  // Either plain arrays (older saves, or saved without the WASM module) or
+  // the packed binary track in trackData with its counts for listing
+  trackPoints?: SerializedTrackPoint[];
+  loopSegments?: SerializedLoopSegment[];
+  trackData?: string;
+  pointCount?: number;
+  loopCount?: number;
   isLooped: boolean;
   hasChainLift: boolean;
   showWoodSupports: boolean;
@@ -134,8 +142,41 @@ function loadSavedCoasters(): SavedCoaster[] {
   }
 }
 
-function persistSavedCoasters(coasters: SavedCoaster[]) {
-  localStorage.setItem(STORAGE_KEY, JSON.stringify(coasters));
+// Pack plain-array saves into the binary track format when the encoder is
+// available, so older libraries shrink the next time they are written.
+// Packed saves open without WASM too: decodeTrack() falls back to its
+// JavaScript decoder.
+function packCoaster(coaster: SavedCoaster): SavedCoaster {
+  if (coaster.trackData || !coaster.trackPoints) return coaster;
+  
+  const loopSegments = coaster.loopSegments || [];
+  const bytes = encodeTrack(coaster.trackPoints, loopSegments, coaster.isLooped);
+  if (!bytes) return coaster;
+  
+  const { trackPoints: _points, loopSegments: _segments, ...rest } = coaster;
+  return {
+    ...rest,
+    trackData: bytesToBase64(bytes),
+    pointCount: coaster.trackPoints.length,
+    loopCount: loopSegments.length,
+  };
+}
+
+function unpackCoaster(
+  coaster: SavedCoaster
+): { trackPoints: SerializedTrackPoint[]; loopSegments: SerializedLoopSegment[] } | null {
+  if (coaster.trackData) {
+    const track = decodeTrack(base64ToBytes(coaster.trackData));
+    return track && { trackPoints: track.trackPoints, loopSegments: track.loopSegments };
+  }
+  if (!Array.isArray(coaster.trackPoints)) return null;
+  return { trackPoints: coaster.trackPoints, loopSegments: coaster.loopSegments || [] };
+}
+
+function persistSavedCoasters(coasters: SavedCoaster[]): SavedCoaster[] {
+  const packed = coasters.map(packCoaster);
+  localStorage.setItem(STORAGE_KEY, JSON.stringify(packed));
+  return packed;
 }
 
 interface RollerCoasterState {
@@ -724,19 +765,24 @@ export const useRollerCoaster = create<RollerCoasterState>()(
     
     const coasters = loadSavedCoasters();
     coasters.push(savedCoaster);
-    persistSavedCoasters(coasters);
     
-    set({ savedCoasters: coasters, currentCoasterName: name });
+    set({ savedCoasters: persistSavedCoasters(coasters), currentCoasterName: name });
   },
   
   loadCoaster: (id: string) => {
     try {
       const coasters = loadSavedCoasters();
       const coaster = coasters.find(c => c.id === id);
-      if (!coaster || !Array.isArray(coaster.trackPoints)) return;
+      if (!coaster) return;
       
-      const trackPoints = coaster.trackPoints.map(deserializeTrackPoint);
-      const loopSegments = (coaster.loopSegments || []).map(deserializeLoopSegment);
+      const track = unpackCoaster(coaster);
+      if (!track) {
+        console.error("Failed to load coaster: track data could not be decoded");
+        return;
+      }
+      
+      const trackPoints = track.trackPoints.map(deserializeTrackPoint);
+      const loopSegments = track.loopSegments.map(deserializeLoopSegment);
       
       // Update pointCounter to avoid ID collisions
       const maxId = trackPoints.reduce((max, p) => {
@@ -745,6 +791,8 @@ export const useRollerCoaster = create<RollerCoasterState>()(
       }, 0);
       pointCounter = maxId;
       
+      // The editor engine warm-starts from this coaster's stored tables
+      openSavedEditorTrack(id);
       set({
         trackPoints,
         loopSegments,
@@ -764,15 +812,20 @@ export const useRollerCoaster = create<RollerCoasterState>()(
   
   deleteCoaster: (id: string) => {
     const coasters = loadSavedCoasters().filter(c => c.id !== id);
-    persistSavedCoasters(coasters);
-    set({ savedCoasters: coasters });
+    set({ savedCoasters: persistSavedCoasters(coasters) });
+    void deleteStoredTables(id);
   },
   
   exportCoaster: (id: string) => {
     const coasters = loadSavedCoasters();
     const coaster = coasters.find(c => c.id === id);
     if (!coaster) return null;
-    return JSON.stringify(coaster, null, 2);
+    
+    // Exports stay plain JSON so they load anywhere
+    const track = unpackCoaster(coaster);
+    if (!track) return null;
+    const { trackData, pointCount, loopCount, ...rest } = coaster;
+    return JSON.stringify({ ...rest, ...track }, null, 2);
   },
   
   importCoaster: (jsonString: string) => {
@@ -817,8 +870,7 @@ export const useRollerCoaster = create<RollerCoasterState>()(
       
       const coasters = loadSavedCoasters();
       coasters.push(validCoaster);
-      persistSavedCoasters(coasters);
-      set({ savedCoasters: coasters });
+      set({ savedCoasters: persistSavedCoasters(coasters) });
       return true;
     } catch {
       return false;
@@ -1,5 +1,6 @@
 import * as THREE from "three";
 import type { LoopSegment, TrackPoint } from "./stores/useRollerCoaster";
+import type { NativeTrackPointInput, TrackStatsNative } from "./wasm/physicsEngine";
 
 // ============================================================================
 // Shared types for track sampling
@@ -55,12 +56,13 @@ export interface TrackStats {
   estimatedRideTime: number; // seconds
   numPoints: number;
   numLoops: number;
+  numInversions: number;
   hasProblems: boolean;
   problems: TrackProblem[];
 }
 
 export interface TrackProblem {
-  type: "steep_grade" | "tight_turn" | "low_point" | "self_intersect";
+  type: "steep_grade" | "tight_turn" | "low_point" | "self_intersect" | "stall";
   severity: "warning" | "error";
   message: string;
   pointIndex?: number;
@@ -499,6 +501,23 @@ export function buildTrackSections(
   return { sections, totalArcLength: accumulatedLength, firstPeakProgress: peakProgress };
 }
 
+// Spline parameter under a hybrid progress value, i.e. the native engine's
+// progress. Inside an element it holds the element's entry.
+export function toSplineProgress(progress: number, sections: TrackSection[]): number {
+  let splineT = 0;
+  for (const section of sections) {
+    if (section.type === "spline" && section.splineStartT !== undefined && section.splineEndT !== undefined) {
+      if (progress < section.startProgress) break;
+      const span = section.endProgress - section.startProgress;
+      const local = span > 0 ? Math.min(1, (progress - section.startProgress) / span) : 1;
+      splineT = section.splineStartT + local * (section.splineEndT - section.splineStartT);
+    } else if (progress < section.endProgress) {
+      break;
+    }
+  }
+  return splineT;
+}
+
 // ============================================================================
 // Hybrid track sampling (handles both spline and roll sections)
 // ============================================================================
@@ -638,10 +657,38 @@ export function sampleHybridTrack(
 // Track statistics and validation
 // ============================================================================
 
+// Editor points in the engine's units (tilt in radians), with each inline
+// element carried on its entry point
+export function toNativeTrackPoints(
+  trackPoints: TrackPoint[],
+  loopSegments: LoopSegment[]
+): NativeTrackPointInput[] {
+  const loopMap = new Map<string, LoopSegment>();
+  for (const seg of loopSegments) {
+    loopMap.set(seg.entryPointId, seg);
+  }
+  return trackPoints.map(p => {
+    const seg = loopMap.get(p.id);
+    return {
+      x: p.position.x,
+      y: p.position.y,
+      z: p.position.z,
+      tilt: p.tilt * Math.PI / 180,
+      hasLoop: seg !== undefined,
+      loopRadius: seg?.radius,
+      loopPitch: seg?.pitch,
+    };
+  });
+}
+
+// `native` is the shared editor engine's result for this exact track and
+// chain-lift setting (see lib/wasm/trackEngine.ts); without it the values
+// are JS estimates
 export function computeTrackStats(
   trackPoints: TrackPoint[],
   loopSegments: LoopSegment[],
-  isLooped: boolean
+  isLooped: boolean,
+  native: TrackStatsNative | null = null
 ): TrackStats {
   const stats: TrackStats = {
     totalLength: 0,
@@ -652,6 +699,7 @@ export function computeTrackStats(
     estimatedRideTime: 0,
     numPoints: trackPoints.length,
     numLoops: loopSegments.length,
+    numInversions: loopSegments.length,
     hasProblems: false,
     problems: [],
   };
@@ -661,6 +709,29 @@ export function computeTrackStats(
     return stats;
   }
 
+  // Exact values from the native engine when they are ready
+  if (native) {
+    stats.totalLength = native.totalLength;
+    stats.maxHeight = native.maxHeight;
+    stats.minHeight = native.minHeight;
+    stats.maxGrade = native.maxGrade;
+    stats.maxBanking = native.maxBank;
+    stats.numInversions = native.inversions;
+    if (native.rideCompleted) {
+      stats.estimatedRideTime = native.rideTime;
+    } else {
+      // rideTime is only when the stalled train came to rest
+      stats.problems.push({
+        type: "stall",
+        severity: "error",
+        message: "Train stalls before finishing the ride.",
+      });
+      stats.hasProblems = true;
+    }
+    validateTrack(trackPoints, loopSegments, isLooped, stats);
+    return stats;
+  }
+
   const { sections, totalArcLength } = buildTrackSections(trackPoints, loopSegments, isLooped);
   stats.totalLength = totalArcLength;
 
@@ -0,0 +1,73 @@
+/**
+ * Audio Control Stream Reader
+ *
+ * The C++ engine resamples speed, G-forces, chain-lift state and wheel-noise
+ * intensity to a fixed control rate (see setControlRate) and writes them as
+ * float32 frames into a ring in WASM memory. This reader follows that ring
+ * from plain typed-array views, so it works unchanged inside an
+ * AudioWorklet: in the pthreads build the views are backed by a
+ * SharedArrayBuffer that can be posted to the worklet once, and audio
+ * parameters then stay smooth even when rendering drops frames.
+ */
+
+// Matches ControlChannel in native/physics_engine.cpp
+export const ControlChannel = {
+  SPEED: 0,
+  G_VERTICAL: 1,
+  G_LATERAL: 2,
+  CHAIN_LIFT: 3,
+  WHEEL_NOISE: 4,
+  COUNT: 5,
+} as const;
+
+export class ControlStreamReader {
+  private frames: Float32Array;
+  private head: Uint32Array;
+  private capacity: number;
+  private cursor: number;
+
+  // Last frame handed out, returned again while the producer is behind
+  private current = new Float32Array(ControlChannel.COUNT);
+
+  constructor(frames: Float32Array, head: Uint32Array) {
+    this.frames = frames;
+    this.head = head;
+    this.capacity = frames.length / ControlChannel.COUNT;
+    this.cursor = this.loadHead();
+  }
+
+  /**
+   * Frames written since the last read. If the reader fell more than a
+   * full ring behind, it skips ahead to the oldest frame still available.
+   */
+  available(): number {
+    const head = this.loadHead();
+    if (((head - this.cursor) >>> 0) > this.capacity) {
+      this.cursor = (head - this.capacity) >>> 0;
+    }
+    return (head - this.cursor) >>> 0;
+  }
+
+  /**
+   * Advance one frame if one is available and return it; otherwise hold the
+   * previous frame. The returned array is reused between calls.
+   */
+  next(): Float32Array {
+    if (this.available() > 0) {
+      const start = (this.cursor % this.capacity) * ControlChannel.COUNT;
+      this.current.set(this.frames.subarray(start, start + ControlChannel.COUNT));
+      this.cursor = (this.cursor + 1) >>> 0;
+    }
+    return this.current;
+  }
+
+  // Views detach when WASM memory grows; make a new reader from fresh ones
+  isDetached(): boolean {
+    return this.frames.length === 0;
+  }
+
+  private loadHead(): number {
+    // Atomics only work on shared memory; plain reads are fine otherwise
+    return this.head.buffer instanceof ArrayBuffer ? this.head[0] : Atomics.load(this.head, 0);
+  }
+}
@@ -0,0 +1,221 @@
+/**
+ * Threaded Physics Engine Host
+ *
+ * Drives the pthreads build of the C++ engine. The simulation runs at a
+ * fixed rate on its own worker and publishes every step into a lock-free
+ * ring in shared WASM memory; the render thread only reads the newest two
+ * records and interpolates between them, so physics never costs main-thread
+ * frame time.
+ */
+
+import {
+  PhysicsEngineModule,
+  PhysicsState,
+  RideEvent,
+  SimulationHostInstance,
+  NativeTrackPointInput,
+  createTrackPointDataVector,
+  toPhysicsState,
+  toRideEvents,
+} from './physicsEngine';
+
+// Field offsets within a StateRecord (see native/physics_engine.cpp)
+const RECORD = {
+  SIM_TIME: 0,
+  PROGRESS: 1,
+  SPEED: 2,
+  POSITION_X: 3,
+  POSITION_Y: 4,
+  POSITION_Z: 5,
+  VELOCITY_X: 6,
+  VELOCITY_Y: 7,
+  VELOCITY_Z: 8,
+  G_VERTICAL: 9,
+  G_LATERAL: 10,
+  G_TOTAL: 11,
+  HEIGHT: 12,
+  BANK_ANGLE: 13,
+  FLAGS: 14,
+} as const;
+
+const FLAG_CHAIN_LIFT = 1;
+const FLAG_IN_LOOP = 2;
+
+export interface InterpolatedPhysicsState {
+  simTime: number;
+  progress: number;
+  speed: number;
+  position: { x: number; y: number; z: number };
+  velocity: { x: number; y: number; z: number };
+  gForceVertical: number;
+  gForceLateral: number;
+  gForceTotal: number;
+  height: number;
+  bankAngle: number;
+  isOnChainLift: boolean;
+  isInLoop: boolean;
+}
+
+export class ThreadedPhysicsHost {
+  private module: PhysicsEngineModule;
+  private host: SimulationHostInstance;
+  private statesIndex: number;
+  private headIndex: number;
+  private capacity: number;
+  private stride: number;
+
+  // Scratch copies of the newest two records
+  private previous: Float64Array;
+  private latest: Float64Array;
+
+  // When the current newest record was first seen on this thread
+  private lastHead = 0;
+  private headSeenAt = 0;
+
+  constructor(module: PhysicsEngineModule) {
+    if (!module.SimulationHost || !module.HEAPF64 || !module.HEAPU32) {
+      throw new Error('ThreadedPhysicsHost requires the pthreads build of the engine');
+    }
+
+    this.module = module;
+    this.host = new module.SimulationHost();
+    this.statesIndex = this.host.getRingStatesPointer() / Float64Array.BYTES_PER_ELEMENT;
+    this.headIndex = this.host.getRingHeadPointer() / Uint32Array.BYTES_PER_ELEMENT;
+    this.capacity = this.host.getRingCapacity();
+    this.stride = this.host.getRecordStride();
+    this.previous = new Float64Array(this.stride);
+    this.latest = new Float64Array(this.stride);
+  }
+
+  start(rateHz: number = 120): void {
+    this.host.start(rateHz);
+  }
+
+  stop(): void {
+    this.host.stop();
+  }
+
+  setTrack(points: NativeTrackPointInput[], isLooped: boolean): void {
+    const trackPoints = createTrackPointDataVector(this.module, points);
+    this.host.setTrack(trackPoints, isLooped);
+    trackPoints.delete();
+  }
+
+  setChainLift(enabled: boolean): void {
+    this.host.setChainLift(enabled);
+  }
+
+  reset(): void {
+    this.host.reset();
+  }
+
+  setSpeed(s: number): void {
+    this.host.setSpeed(s);
+  }
+
+  setProgress(p: number): void {
+    this.host.setProgress(p);
+  }
+
+  /**
+   * Most recently stepped state, read tear-free while the simulation thread
+   * keeps stepping. For consumers that poll at their own rate (G-force
+   * display, minimap, debug overlay) and do not need interpolation.
+   */
+  getSnapshot(): PhysicsState {
+    return toPhysicsState(this.host.getSnapshot());
+  }
+
+  get snapshotVersion(): number {
+    return this.host.getSnapshotVersion();
+  }
+
+  /**
+   * Events the simulation thread emitted since the last call
+   */
+  drainEvents(): RideEvent[] {
+    return toRideEvents(this.host.drainEvents());
+  }
+
+  /**
+   * State interpolated between the newest two published steps, running one
+   * simulation tick behind. Returns null until two steps have been published.
+   */
+  sample(now: number = performance.now()): InterpolatedPhysicsState | null {
+    const head = this.readLatestPair();
+    if (head === null) return null;
+
+    if (head !== this.lastHead) {
+      this.lastHead = head;
+      this.headSeenAt = now;
+    }
+
+    const a = this.previous;
+    const b = this.latest;
+    const tickMs = (b[RECORD.SIM_TIME] - a[RECORD.SIM_TIME]) * 1000;
+    const alpha = tickMs > 0 ? Math.min(1, (now - this.headSeenAt) / tickMs) : 1;
+    const lerp = (field: number) => a[field] + (b[field] - a[field]) * alpha;
+
+    // Progress wraps on looped tracks
+    let progressB = b[RECORD.PROGRESS];
+    if (progressB < a[RECORD.PROGRESS] - 0.5) progressB += 1;
+    const progress = a[RECORD.PROGRESS] + (progressB - a[RECORD.PROGRESS]) * alpha;
+
+    const flags = b[RECORD.FLAGS];
+
+    return {
+      simTime: lerp(RECORD.SIM_TIME),
+      progress: progress % 1,
+      speed: lerp(RECORD.SPEED),
+      position: {
+        x: lerp(RECORD.POSITION_X),
+        y: lerp(RECORD.POSITION_Y),
+        z: lerp(RECORD.POSITION_Z),
+      },
+      velocity: {
+        x: lerp(RECORD.VELOCITY_X),
+        y: lerp(RECORD.VELOCITY_Y),
+        z: lerp(RECORD.VELOCITY_Z),
+      },
+      gForceVertical: lerp(RECORD.G_VERTICAL),
+      gForceLateral: lerp(RECORD.G_LATERAL),
+      gForceTotal: lerp(RECORD.G_TOTAL),
+      height: lerp(RECORD.HEIGHT),
+      bankAngle: lerp(RECORD.BANK_ANGLE),
+      isOnChainLift: (flags & FLAG_CHAIN_LIFT) !== 0,
+      isInLoop: (flags & FLAG_IN_LOOP) !== 0,
+    };
+  }
+
+  dispose(): void {
+    this.host.stop();
+    this.host.delete();
+  }
+
+  /**
+   * Copy the newest two records out of shared memory. Mirrors
+   * StateRing::readLatestPair: re-check the head after copying and retry if
+   * the simulation thread lapped us.
+   */
+  private readLatestPair(): number | null {
+    // Re-read the heap views every time; they are replaced when memory grows
+    const heapF64 = this.module.HEAPF64!;
+    const heapU32 = this.module.HEAPU32!;
+
+    for (let attempt = 0; attempt < 4; attempt++) {
+      const head = Atomics.load(heapU32, this.headIndex);
+      if (head < 2) return null;
+
+      const previousStart = this.statesIndex + ((head - 2) % this.capacity) * this.stride;
+      const latestStart = this.statesIndex + ((head - 1) % this.capacity) * this.stride;
+      this.previous.set(heapF64.subarray(previousStart, previousStart + this.stride));
+      this.latest.set(heapF64.subarray(latestStart, latestStart + this.stride));
+
+      if (((Atomics.load(heapU32, this.headIndex) - head) >>> 0) < this.capacity - 2) {
+        return head;
+      }
+    }
+
+    return null;
+  }
+}
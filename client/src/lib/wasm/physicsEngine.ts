@@ -36,6 +36,11 @@ export interface PhysicsState {
   bankAngle: number;
 }
 
+// PhysicsState handle returned by value from C++ (must be deleted)
+export interface NativePhysicsState extends PhysicsState {
+  delete(): void;
+}
+
 export interface TrackSample {
   point: Vec3;
   tangent: Vec3;
@@ -47,6 +52,176 @@ export interface TrackSample {
   grade: number;
 }
 
+export interface TrackStatsNative {
+  totalLength: number;    // meters, spline plus inline elements
+  elementLength: number;  // meters of totalLength inside loop/roll elements
+  minHeight: number;      // meters, loop tops included
+  maxHeight: number;
+  maxGrade: number;       // degrees from horizontal, inside elements too
+  maxBank: number;        // degrees
+  inversions: number;
+  elements: number;
+  rideTime: number;       // seconds, headless simulation plus element traversal (to rest if it stalled)
+  maxSpeed: number;       // m/s
+  maxGForce: number;
+  rideCompleted: boolean; // false if the headless run stalled or hit its time limit
+}
+
+// Load, friction and wind applied on top of the physics constants; the
+// defaults (1, 1, 0, 0) are the nominal case every analysis uses
+export interface RideConditions {
+  dragScale: number;      // nominal train mass / actual
+  frictionScale: number;
+  windX: number;          // m/s
+  windZ: number;
+}
+
+// Monte Carlo robustness run (see MonteCarloRides in native/physics_engine.cpp)
+export interface RobustnessOptions {
+  samples: number;
+  seed: number;           // same seed, same draws per sample index
+  threads: number;        // 0 = 1 in the browser
+  minOccupancy: number;   // fraction of seats filled
+  maxOccupancy: number;
+  frictionSigma: number;  // log-normal spread of the friction multiplier
+  meanWindSpeed: number;  // m/s
+}
+
+export const DEFAULT_ROBUSTNESS_OPTIONS: RobustnessOptions = {
+  samples: 2000,
+  seed: 1,
+  threads: 0,
+  minOccupancy: 0,
+  maxOccupancy: 1,
+  frictionSigma: 0.2,
+  meanWindSpeed: 4,
+};
+
+// Probabilities are fractions of all samples
+export interface RobustnessSection {
+  startProgress: number;
+  endProgress: number;
+  reachProbability: number;
+  stallProbability: number;
+  exceedanceProbability: number;
+  maxVerticalG: number;
+  minVerticalG: number;
+  maxLateralG: number;
+}
+
+export interface RobustnessSectionVector {
+  size(): number;
+  get(index: number): RobustnessSection;
+  delete(): void;
+}
+
+export interface RobustnessReport {
+  samples: number;
+  stallProbability: number;
+  exceedanceProbability: number;
+  sections: RobustnessSectionVector;
+}
+
+// Energy bookkeeping for one control-point span, J/kg
+export interface EnergySection {
+  startProgress: number;
+  endProgress: number;
+  length: number;        // meters
+  entryHeight: number;
+  peakHeight: number;
+  peakDistance: number;  // meters from span start to its peak
+  entrySpeed: number;    // m/s
+  exitSpeed: number;
+  dragLoss: number;
+  frictionLoss: number;
+  dragToPeak: number;
+  liftGain: number;
+  margin: number;        // kinetic energy left at the peak; < 0 stalls
+  chainLifted: boolean;
+  reached: boolean;
+}
+
+// Matches VertexAttribute in native/physics_engine.cpp. Channels for
+// coloring the track, one value per rail vertex in Track.tsx's layout
+// (samplesPerSegment per span plus its vertices at each inline element).
+export const VertexAttribute = {
+  SPEED: 0,
+  G_VERTICAL: 1,
+  G_LATERAL: 2,
+  G_TOTAL: 3,
+  TIME: 4,
+  HEIGHT: 5,
+} as const;
+
+export type VertexAttributeValue = typeof VertexAttribute[keyof typeof VertexAttribute];
+
+// Matches RideEventType in native/physics_engine.cpp
+export const RideEventType = {
+  LOOP_ENTER: 0,
+  LOOP_EXIT: 1,
+  CHAIN_LIFT_ENGAGE: 2,
+  CHAIN_LIFT_RELEASE: 3,
+  AIRTIME_START: 4,
+  AIRTIME_END: 5,
+  STATION_CROSSED: 6,
+  SEEK: 7,
+} as const;
+
+export type RideEventTypeValue = typeof RideEventType[keyof typeof RideEventType];
+
+export interface RideEvent {
+  type: RideEventTypeValue;
+  time: number;      // simulation seconds since reset
+  arcLength: number; // meters from start
+  progress: number;  // 0-1 along track
+  value: number;     // speed (m/s), vertical G for airtime events, or the new time for seeks
+}
+
+// Matches TrackFeatureKind in native/physics_engine.cpp
+export const TrackFeatureKind = {
+  STRAIGHT: 0,
+  CURVE: 1,         // bends that are none of the below
+  DROP: 2,
+  AIRTIME_HILL: 3,
+  TURN: 4,
+  HELIX: 5,
+  INVERSION: 6,
+} as const;
+
+// One recognized element along the spline
+export interface TrackFeature {
+  kind: typeof TrackFeatureKind[keyof typeof TrackFeatureKind];
+  startProgress: number;
+  endProgress: number;
+  startDistance: number;  // meters along the spline
+  endDistance: number;
+  heightChange: number;   // meters, end minus start
+  turnAngle: number;      // radians of heading change, signed
+  maxCurvature: number;   // 1/m
+  maxTorsion: number;     // 1/m
+  maxBank: number;        // radians
+  minVerticalG: number;   // estimated for a frictionless train
+}
+
+// Matches StallOutcome in native/physics_engine.cpp
+export const StallOutcome = {
+  NONE: 0,          // clears every hill
+  SETTLES: 1,       // rolls back and comes to rest in the valley
+  CHAIN_CATCH: 2,   // rolls back onto the chain lift
+  STATION: 3,       // open track: rolls back into the station
+} as const;
+
+export interface StallPrediction {
+  outcome: typeof StallOutcome[keyof typeof StallOutcome];
+  stallProgress: number;   // -1 if the train never stops
+  hillPoint: number;       // control point nearest the failed crest, -1 if none
+  shortfall: number;       // meters of height short of that crest
+  swings: number;          // direction reversals after the stall
+  restProgress: number;
+  minSpeed: number;        // m/s, off the chain lift before any stall
+  minSpeedProgress: number;
+}
+
 export interface ValidationResult {
   isValid: boolean;
   message: string;
@@ -56,8 +231,57 @@ export interface ValidationResult {
 }
 
 export interface PhysicsEngineInstance {
+  setTrack(points: TrackPointDataVector, isLooped: boolean): void;
+  // Warm start from getTrackTables() bytes; false (after a normal build)
+  // when they don't match these points or fail to validate
+  setTrackFromTables(points: TrackPointDataVector, isLooped: boolean, tables: Uint8Array): boolean;
+  getTrackTables(): Uint8Array;
+  beginTrackBuild(points: TrackPointDataVector, isLooped: boolean): void;
+  // Adopts matching tables at once; false (build started) otherwise
+  beginTrackBuildFromTables(points: TrackPointDataVector, isLooped: boolean, tables: Uint8Array): boolean;
+  pumpTrackBuild(budgetMs: number): boolean;
+  isTrackBuildPending(): boolean;
+  getTrackVersion(): number;
+  getTrackLength(): number;
+  // Frame curvature is built per chunk on first access
+  getFrameChunkCount(): number;
+  getBuiltFrameChunkCount(): number;
+  getValidation(): ValidationResultVector;
+  predictStall(startSpeed: number): StallPrediction;
+  getTrackFingerprint(): string;
+  // Similarity key; see SimilarityIndexInstance
+  getTrackDescriptor(): Float32Array;
+  getTrackStats(): TrackStatsNative & { delete(): void };
+  recordRide(rateHz: number): TrajectorySampleVector;
+  simulateRobustness(options: RobustnessOptions): RobustnessReport;
+  getEnergySections(): EnergySectionVector;
+  getTrackFeatures(): TrackFeatureVector;
+  canClearSection(section: number, entrySpeed: number): boolean;
+  getClearanceMargin(section: number, entrySpeed: number): number;
+  getFirstStallSection(fromSection: number, startSpeed: number): number; // -1 if none
+  // Look the ride state up by position instead of integrating where laps
+  // repeat (0 disables); exact when stepped at referenceStep
+  setSpeedProfileStep(referenceStep: number): void;
+  getSpeedProfileStep(): number;
+  getSpeedAtProgress(progress: number): number;
+  getSpeedAtDistance(meters: number): number;
+  // Scrub the first lap with speed, G smoothing and flags restored
+  getRideDuration(): number;
+  seekToTime(seconds: number): boolean;
+  seekToDistance(meters: number): boolean;
+  // Flat profile polylines for the 2D views (see trackProfiles.ts)
+  getMinimapPolyline(toleranceMeters: number): Float32Array;
+  getVertexAttribute(attribute: VertexAttributeValue, samplesPerSegment: number): Float32Array;
+  getElevationProfile(pxPerMeter: number, pxPerMeterY: number, tolerancePx: number): Float32Array;
+  getBankingProfile(pxPerMeter: number, pxPerDegree: number, tolerancePx: number): Float32Array;
+  getCurvatureComb(pxPerMeter: number, spacingPx: number): Float32Array;
   setChainLift(enabled: boolean): void;
+  // Applies to this engine's stepping only; analyses stay nominal
+  setRideConditions(conditions: RideConditions): void;
+  getRideConditions(): RideConditions;
   reset(): void;
+  // Read the new state through the getters or readSnapshot()
+  step(dt: number): void;
   getSpeed(): number;
   getGForceVertical(): number;
   getGForceLateral(): number;
@@ -72,6 +296,16 @@ export interface PhysicsEngineInstance {
   getVelocityX(): number;
   getVelocityY(): number;
   getVelocityZ(): number;
+  readSnapshot(): NativePhysicsState;
+  getSnapshotVersion(): number;
+  drainEvents(): RideEventVector;
+  getDroppedEventCount(): number;
+  setControlRate(hz: number): void;
+  getControlHead(): number;
+  getControlCapacity(): number;
+  getControlChannels(): number;
+  getControlFramesView(): Float32Array;
+  getControlHeadView(): Uint32Array;
   setProgress(p: number): void;
   setSpeed(s: number): void;
   delete(): void;
@@ -99,6 +333,182 @@ export interface ValidationResultVector {
   delete(): void;
 }
 
+export interface EnergySectionVector {
+  size(): number;
+  get(index: number): EnergySection;
+  delete(): void;
+}
+
+export interface TrackFeatureVector {
+  size(): number;
+  get(index: number): TrackFeature;
+  delete(): void;
+}
+
+export interface RideEventVector {
+  size(): number;
+  get(index: number): RideEvent;
+  delete(): void;
+}
+
+// Saved track format (see TrackCodec in native/physics_engine.cpp)
+export interface SavedTrackPoint {
+  x: number;
+  y: number;
+  z: number;
+  tilt: number; // degrees
+}
+
+export interface SavedTrackElement {
+  pointIndex: number;
+  type: number; // index into TRACK_ELEMENT_KINDS
+  radius: number;
+  pitch: number;
+  rotation: number; // degrees
+  leftHanded: boolean;
+}
+
+export interface SavedTrackPointVector {
+  size(): number;
+  get(index: number): SavedTrackPoint;
+  push_back(item: SavedTrackPoint): void;
+  delete(): void;
+}
+
+export interface SavedTrackElementVector {
+  size(): number;
+  get(index: number): SavedTrackElement;
+  push_back(item: SavedTrackElement): void;
+  delete(): void;
+}
+
+export interface SavedTrackInstance {
+  points: SavedTrackPointVector;
+  elements: SavedTrackElementVector;
+  isLooped: boolean;
+  delete(): void;
+}
+
+export interface TrackCodecStatic {
+  encode(track: SavedTrackInstance): Uint8Array;
+  decode(bytes: Uint8Array, out: SavedTrackInstance): boolean;
+}
+
+// 16 hex digits over quantized points, elements and physics constants;
+// the server caches analysis results under the same key
+export interface TrackFingerprintStatic {
+  compute(points: TrackPointDataVector, isLooped: boolean, hasChainLift: boolean): string;
+}
+
+// Exact k-NN over track descriptors (see SimilarityIndex in
+// native/physics_engine.cpp); the server keeps one over every design it
+// has analyzed
+export const DUPLICATE_DISTANCE = 0.5;
+
+export interface SimilarityMatch {
+  id: string;
+  distance: number; // DUPLICATE_DISTANCE and under is the same ride
+}
+
+export interface SimilarityMatchVector {
+  size(): number;
+  get(index: number): SimilarityMatch;
+  delete(): void;
+}
+
+export interface SimilarityIndexInstance {
+  add(id: string, descriptor: Float32Array): boolean;
+  remove(id: string): boolean;
+  contains(id: string): boolean;
+  get(id: string): Float32Array; // empty if absent
+  size(): number;
+  // Closest first; excludeId skips the query's own entry
+  query(descriptor: Float32Array, k: number, excludeId: string): SimilarityMatchVector;
+  delete(): void;
+}
+
+// Trajectory codec (see TrajectoryCodec in native/physics_engine.cpp)
+export interface TrajectorySample {
+  time: number;
+  x: number;
+  y: number;
+  z: number;
+  // Orientation quaternion: car-local +Z forward, +Y up
+  qx: number;
+  qy: number;
+  qz: number;
+  qw: number;
+  speed: number;
+  gForceVertical: number;
+  gForceLateral: number;
+}
+
+// Quantization steps; reconstruction error is at most half a step
+export interface TrajectoryCodecOptions {
+  timeStep: number;
+  positionStep: number;
+  speedStep: number;
+  gForceStep: number;
+  orientationStep: number;
+  smallestThree: boolean;
+  blockSize: number;
+}
+
+export const DEFAULT_TRAJECTORY_OPTIONS: TrajectoryCodecOptions = {
+  timeStep: 1e-4,
+  positionStep: 1e-3,
+  speedStep: 0.01,
+  gForceStep: 0.01,
+  orientationStep: 1e-3,
+  smallestThree: true,
+  blockSize: 64,
+};
+
+export interface TrajectorySampleVector {
+  size(): number;
+  get(index: number): TrajectorySample;
+  push_back(item: TrajectorySample): void;
+  delete(): void;
+}
+
+export interface TrajectoryCodecStatic {
+  encode(samples: TrajectorySampleVector, options: TrajectoryCodecOptions): Uint8Array;
+}
+
+export interface TrajectoryReaderInstance {
+  append(chunk: Uint8Array): void;
+  isValid(): boolean;
+  getSampleCount(): number;
+  getBlockCount(): number;
+  getStartTime(): number;
+  getLoadedEndTime(): number;
+  sampleAt(time: number): TrajectorySample;
+  delete(): void;
+}
+
+export interface SimulationHostInstance {
+  start(rateHz: number): void;
+  stop(): void;
+  isRunning(): boolean;
+  getSnapshot(): NativePhysicsState;
+  getSnapshotVersion(): number;
+  drainEvents(): RideEventVector;
+  setControlRate(hz: number): void;
+  getControlFramesView(): Float32Array;
+  getControlHeadView(): Uint32Array;
+  setTrack(points: TrackPointDataVector, isLooped: boolean): void;
+  setChainLift(enabled: boolean): void;
+  setRideConditions(conditions: RideConditions): void;
+  reset(): void;
+  setSpeed(s: number): void;
+  setProgress(p: number): void;
+  getRingStatesPointer(): number;
+  getRingHeadPointer(): number;
+  getRingCapacity(): number;
+  getRecordStride(): number;
+  delete(): void;
+}
+
 // Module interface
 export interface PhysicsEngineModule {
   Vec3: new (x?: number, y?: number, z?: number) => Vec3;
@@ -108,13 +518,111 @@ export interface PhysicsEngineModule {
   CollisionDetector: CollisionDetectorStatic;
   TrackPointDataVector: new () => TrackPointDataVector;
   ValidationResultVector: new () => ValidationResultVector;
+  SavedTrack: new () => SavedTrackInstance;
+  SavedTrackPointVector: new () => SavedTrackPointVector;
+  SavedTrackElementVector: new () => SavedTrackElementVector;
+  TrackCodec: TrackCodecStatic;
+  TrackFingerprint: TrackFingerprintStatic;
+  TrajectorySampleVector: new () => TrajectorySampleVector;
+  TrajectoryCodec: TrajectoryCodecStatic;
+  TrajectoryReader: new () => TrajectoryReaderInstance;
+  SimilarityIndex: new () => SimilarityIndexInstance;
+  
+  // Threaded build only
+  SimulationHost?: new () => SimulationHostInstance;
+  HEAPF64?: Float64Array;
+  HEAPU32?: Uint32Array;
 }
 
+// Editor and analysis methods, which the ride-only core leaves out
+// (PHYSICS_RIDE_CORE in native/physics_engine.cpp)
+type EngineToolMethod =
+  | 'getTrackTables'
+  | 'getValidation'
+  | 'predictStall'
+  | 'getTrackFingerprint'
+  | 'getTrackDescriptor'
+  | 'getTrackStats'
+  | 'recordRide'
+  | 'simulateRobustness'
+  | 'getEnergySections'
+  | 'getTrackFeatures'
+  | 'canClearSection'
+  | 'getClearanceMargin'
+  | 'getFirstStallSection'
+  | 'getMinimapPolyline'
+  | 'getVertexAttribute'
+  | 'getElevationProfile'
+  | 'getBankingProfile'
+  | 'getCurvatureComb';
+
+export type RideEngineInstance = Omit<PhysicsEngineInstance, EngineToolMethod>;
+
+// What physics_engine_core exports; the full module satisfies it too
+export type RideEngineModule = Pick<
+  PhysicsEngineModule,
+  'Vec3' | 'TrackPointData' | 'TrackPointDataVector' | 'TrajectoryReader'
+> & {
+  PhysicsEngine: new () => RideEngineInstance;
+};
+
 // Loader state
 let moduleInstance: PhysicsEngineModule | null = null;
+let moduleVariant: EngineVariant | null = null;
 let loadPromise: Promise<PhysicsEngineModule> | null = null;
 let loadError: Error | null = null;
 
+/**
+ * Engine builds, fastest first (see native/CMakeLists.txt). All export the
+ * same API; 'threaded' adds SimulationHost and background track builds.
+ */
+export type EngineVariant = 'threaded' | 'simd' | 'baseline';
+
+const ENGINE_VARIANT_PATHS: Record<EngineVariant, string> = {
+  threaded: '/wasm/physics_engine_mt.js',
+  simd: '/wasm/physics_engine_simd.js',
+  baseline: '/wasm/physics_engine.js',
+};
+
+// Smallest module using a v128 op: i32.const 0, i8x16.splat, i8x16.popcnt
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+let simdSupported: boolean | null = null;
+
+/**
+ * Check if the browser accepts WebAssembly SIMD128
+ */
+export function isSimdWasmSupported(): boolean {
+  if (simdSupported === null) {
+    try {
+      simdSupported = typeof WebAssembly === 'object' && WebAssembly.validate(SIMD_PROBE);
+    } catch {
+      simdSupported = false;
+    }
+  }
+  return simdSupported;
+}
+
+/**
+ * Variants this page can run, fastest first
+ */
+export function getSupportedEngineVariants(): EngineVariant[] {
+  const variants: EngineVariant[] = [];
+  if (isThreadedWasmSupported()) variants.push('threaded');
+  if (isSimdWasmSupported()) variants.push('simd');
+  variants.push('baseline');
+  return variants;
+}
+
+/**
+ * Which build loadPhysicsEngine() ended up with (null until loaded)
+ */
+export function getPhysicsEngineVariant(): EngineVariant | null {
+  return moduleVariant;
+}
+
 /**
  * Check if WASM physics engine is available
  */
@@ -122,6 +630,26 @@ export function isWasmAvailable(): boolean {
   return moduleInstance !== null;
 }
 
+/**
+ * Import and initialize an Emscripten-generated engine module
+ */
+async function importEngineModule(wasmPath: string): Promise<PhysicsEngineModule> {
+  // Check if the WASM file exists
+  const response = await fetch(wasmPath, { method: 'HEAD' });
+  
+  if (!response.ok) {
+    throw new Error(`WASM module not found at ${wasmPath}. Have you built the native code?`);
+  }
+  
+  // Import the ES6 module
+  const PhysicsEngineFactory = await import(/* @vite-ignore */ wasmPath);
+  
+  // Initialize the module
+  const module = await PhysicsEngineFactory.default();
+  
+  return module as PhysicsEngineModule;
+}
+
 /**
  * Load the WASM physics engine module
  * Returns a promise that resolves when the module is ready
@@ -145,26 +673,25 @@ export async function loadPhysicsEngine(): Promise<PhysicsEngineModule> {
   // Start loading
   loadPromise = (async () => {
     try {
-      // Dynamic import of the WASM module
-      const wasmPath = '/wasm/physics_engine.js';
-      
-      // Check if the WASM file exists
-      const response = await fetch(wasmPath, { method: 'HEAD' });
-      
-      if (!response.ok) {
-        throw new Error(`WASM module not found at ${wasmPath}. Have you built the native code?`);
+      // Fall through to slower builds when a variant wasn't deployed or
+      // fails to instantiate
+      let lastError: unknown = null;
+      for (const variant of getSupportedEngineVariants()) {
+        try {
+          // The threaded build doubles as the SimulationHost module; share it
+          moduleInstance = variant === 'threaded'
+            ? await loadThreadedPhysicsEngine()
+            : await importEngineModule(ENGINE_VARIANT_PATHS[variant]);
+        } catch (error) {
+          lastError = error;
+          continue;
+        }
+        
+        moduleVariant = variant;
+        console.log(`✓ Physics Engine WASM loaded successfully (${variant})`);
+        return moduleInstance;
       }
-      
-      // Import the ES6 module
-      const PhysicsEngineFactory = await import(/* @vite-ignore */ wasmPath);
-      
-      // Initialize the module
-      const module = await PhysicsEngineFactory.default();
-      
-      moduleInstance = module as PhysicsEngineModule;
-      console.log('✓ Physics Engine WASM loaded successfully');
-      
-      return moduleInstance;
+      throw lastError;
     } catch (error) {
       loadError = error instanceof Error ? error : new Error(String(error));
       console.warn('⚠ WASM physics engine not available, using JavaScript fallback:', loadError.message);
@@ -175,6 +702,75 @@ export async function loadPhysicsEngine(): Promise<PhysicsEngineModule> {
   return loadPromise;
 }
 
+// Ride-only module state
+let rideModuleInstance: RideEngineModule | null = null;
+let rideLoadPromise: Promise<RideEngineModule> | null = null;
+
+/**
+ * Load just what riding needs: spline, stepping, seeking, events, control
+ * stream and trajectory playback. Viewers that never open the editor skip
+ * downloading the validator, analysis and codecs. loadPhysicsEngine() adds
+ * them when first needed. Returns the full engine if it is already loaded,
+ * and falls back to it when the core build isn't deployed.
+ */
+export async function loadRideEngine(): Promise<RideEngineModule> {
+  if (moduleInstance) {
+    return moduleInstance;
+  }
+  
+  if (rideModuleInstance) {
+    return rideModuleInstance;
+  }
+  
+  if (!rideLoadPromise) {
+    rideLoadPromise = importEngineModule('/wasm/physics_engine_core.js').then(
+      module => {
+        rideModuleInstance = module;
+        console.log('✓ Ride Physics Engine WASM loaded successfully');
+        return module;
+      },
+      () => loadPhysicsEngine()
+    );
+  }
+  
+  return rideLoadPromise;
+}
+
+// Threaded module state (loaded separately; needs SharedArrayBuffer)
+let threadedModuleInstance: PhysicsEngineModule | null = null;
+let threadedLoadPromise: Promise<PhysicsEngineModule> | null = null;
+
+/**
+ * Check if the page can run the pthreads build: cross-origin isolated, and
+ * SIMD128 since that build is vectorized too
+ */
+export function isThreadedWasmSupported(): boolean {
+  return typeof SharedArrayBuffer !== 'undefined' && globalThis.crossOriginIsolated === true && isSimdWasmSupported();
+}
+
+/**
+ * Load the pthreads build of the engine, which provides SimulationHost
+ */
+export async function loadThreadedPhysicsEngine(): Promise<PhysicsEngineModule> {
+  if (threadedModuleInstance) {
+    return threadedModuleInstance;
+  }
+  
+  if (!isThreadedWasmSupported()) {
+    throw new Error('Threaded physics engine requires a cross-origin isolated page with WebAssembly SIMD');
+  }
+  
+  if (!threadedLoadPromise) {
+    threadedLoadPromise = importEngineModule(ENGINE_VARIANT_PATHS.threaded).then(module => {
+      threadedModuleInstance = module;
+      console.log('✓ Threaded Physics Engine WASM loaded successfully');
+      return module;
+    });
+  }
+  
+  return threadedLoadPromise;
+}
+
 /**
  * Get the loaded physics engine module (throws if not loaded)
  */
@@ -229,30 +825,80 @@ export function createTrackPointData(
   return point;
 }
 
+export type NativeTrackPointInput = {
+  x: number;
+  y: number;
+  z: number;
+  tilt: number; // radians
+  hasLoop?: boolean;
+  loopRadius?: number;
+  loopPitch?: number;
+};
+
 /**
- * Validate track using native C++ validator
+ * Copy a native PhysicsState into a plain object and release the handle
  */
-export function validateTrackNative(
-  points: Array<{ x: number; y: number; z: number; tilt: number; hasLoop?: boolean }>,
-  isLooped: boolean
-): ValidationResult[] | null {
-  if (!moduleInstance) {
-    return null;
+export function toPhysicsState(snapshot: NativePhysicsState): PhysicsState {
+  const state: PhysicsState = {
+    speed: snapshot.speed,
+    gForceVertical: snapshot.gForceVertical,
+    gForceLateral: snapshot.gForceLateral,
+    gForceTotal: snapshot.gForceTotal,
+    progress: snapshot.progress,
+    height: snapshot.height,
+    isOnChainLift: snapshot.isOnChainLift,
+    isInLoop: snapshot.isInLoop,
+    bankAngle: snapshot.bankAngle,
+  };
+  snapshot.delete();
+  return state;
+}
+
+/**
+ * Convert a drained native event vector to a JavaScript array and release it
+ */
+export function toRideEvents(events: RideEventVector): RideEvent[] {
+  const jsEvents: RideEvent[] = [];
+  for (let i = 0; i < events.size(); i++) {
+    const e = events.get(i);
+    jsEvents.push({
+      type: e.type,
+      time: e.time,
+      arcLength: e.arcLength,
+      progress: e.progress,
+      value: e.value,
+    });
   }
-  
-  const trackPoints = new moduleInstance.TrackPointDataVector();
+  events.delete();
+  return jsEvents;
+}
+
+/**
+ * Copy JavaScript track points into a native vector (caller must delete it)
+ */
+export function createTrackPointDataVector(
+  module: RideEngineModule,
+  points: NativeTrackPointInput[]
+): TrackPointDataVector {
+  const trackPoints = new module.TrackPointDataVector();
   
   for (const p of points) {
-    const point = new moduleInstance.TrackPointData();
-    point.position = new moduleInstance.Vec3(p.x, p.y, p.z);
+    const point = new module.TrackPointData();
+    point.position = new module.Vec3(p.x, p.y, p.z);
     point.tilt = p.tilt;
     point.hasLoop = p.hasLoop || false;
+    if (p.loopRadius !== undefined) point.loopRadius = p.loopRadius;
+    if (p.loopPitch !== undefined) point.loopPitch = p.loopPitch;
     trackPoints.push_back(point);
   }
   
-  const results = moduleInstance.TrackValidator.validate(trackPoints, isLooped);
-  
-  // Convert to JavaScript array
+  return trackPoints;
+}
+
+/**
+ * Convert a native validation result vector to a JavaScript array
+ */
+function toValidationResults(results: ValidationResultVector): ValidationResult[] {
   const jsResults: ValidationResult[] = [];
   for (let i = 0; i < results.size(); i++) {
     const r = results.get(i);
@@ -264,6 +910,23 @@ export function validateTrackNative(
       value: r.value,
     });
   }
+  return jsResults;
+}
+
+/**
+ * Validate track using native C++ validator
+ */
+export function validateTrackNative(
+  points: NativeTrackPointInput[],
+  isLooped: boolean
+): ValidationResult[] | null {
+  if (!moduleInstance) {
+    return null;
+  }
+  
+  const trackPoints = createTrackPointDataVector(moduleInstance, points);
+  const results = moduleInstance.TrackValidator.validate(trackPoints, isLooped);
+  const jsResults = toValidationResults(results);
   
   // Clean up
   trackPoints.delete();
@@ -272,6 +935,32 @@ export function validateTrackNative(
   return jsResults;
 }
 
+/**
+ * Exact track statistics for the engine's current model: one pass over its
+ * cached tables plus a headless ride for timing (memoized per model
+ * version). The ride is up to 36k steps; call it off the input path.
+ */
+export function readTrackStats(engine: PhysicsEngineInstance): TrackStatsNative {
+  const native = engine.getTrackStats();
+  const stats: TrackStatsNative = {
+    totalLength: native.totalLength,
+    elementLength: native.elementLength,
+    minHeight: native.minHeight,
+    maxHeight: native.maxHeight,
+    maxGrade: native.maxGrade,
+    maxBank: native.maxBank,
+    inversions: native.inversions,
+    elements: native.elements,
+    rideTime: native.rideTime,
+    maxSpeed: native.maxSpeed,
+    maxGForce: native.maxGForce,
+    rideCompleted: native.rideCompleted,
+  };
+  native.delete();
+  
+  return stats;
+}
+
 /**
  * High-level physics simulation wrapper
  */
@@ -290,6 +979,54 @@ export class PhysicsSimulation {
     return this.isInitialized && this.engine !== null;
   }
   
+  /**
+   * Rebuild the track model synchronously and restart the ride
+   */
+  setTrack(points: NativeTrackPointInput[], isLooped: boolean): void {
+    if (!this.engine || !moduleInstance) return;
+    
+    const trackPoints = createTrackPointDataVector(moduleInstance, points);
+    this.engine.setTrack(trackPoints, isLooped);
+    trackPoints.delete();
+  }
+  
+  /**
+   * Start rebuilding the track model without blocking the frame. The ride
+   * keeps using the previous model until the new one is ready; call
+   * pumpTrackBuild() once per frame to make progress on single-threaded builds.
+   */
+  beginTrackBuild(points: NativeTrackPointInput[], isLooped: boolean): void {
+    if (!this.engine || !moduleInstance) return;
+    
+    const trackPoints = createTrackPointDataVector(moduleInstance, points);
+    this.engine.beginTrackBuild(trackPoints, isLooped);
+    trackPoints.delete();
+  }
+  
+  /**
+   * Spend up to budgetMs on a pending track build. Returns true when the
+   * newest requested track is in use.
+   */
+  pumpTrackBuild(budgetMs: number = 2): boolean {
+    return this.engine?.pumpTrackBuild(budgetMs) ?? true;
+  }
+  
+  get trackVersion(): number {
+    return this.engine?.getTrackVersion() ?? 0;
+  }
+  
+  /**
+   * Validation results computed alongside the current track model
+   */
+  getValidation(): ValidationResult[] {
+    if (!this.engine) return [];
+    
+    const results = this.engine.getValidation();
+    const jsResults = toValidationResults(results);
+    results.delete();
+    return jsResults;
+  }
+  
   setChainLift(enabled: boolean): void {
     this.engine?.setChainLift(enabled);
   }
@@ -301,17 +1038,25 @@ export class PhysicsSimulation {
   getState(): PhysicsState | null {
     if (!this.engine) return null;
     
-    return {
-      speed: this.engine.getSpeed(),
-      gForceVertical: this.engine.getGForceVertical(),
-      gForceLateral: this.engine.getGForceLateral(),
-      gForceTotal: this.engine.getGForceTotal(),
-      progress: this.engine.getProgress(),
-      height: this.engine.getHeight(),
-      isOnChainLift: this.engine.getIsOnChainLift(),
-      isInLoop: this.engine.getIsInLoop(),
-      bankAngle: 0, // Would need to be added to C++
-    };
+    // One consistent snapshot instead of a getter call per field
+    return toPhysicsState(this.engine.readSnapshot());
+  }
+  
+  /**
+   * Bumps every time the engine publishes a new state; lets readers that
+   * poll at their own rate skip unchanged snapshots
+   */
+  get stateVersion(): number {
+    return this.engine?.getSnapshotVersion() ?? 0;
+  }
+  
+  /**
+   * Ride events (loop entry/exit, chain lift, airtime, station) emitted
+   * while stepping since the last call. Drain once per frame.
+   */
+  drainEvents(): RideEvent[] {
+    if (!this.engine) return [];
+    return toRideEvents(this.engine.drainEvents());
   }
   
   getPosition(): { x: number; y: number; z: number } | null {
@@ -0,0 +1,355 @@
+/**
+ * Saved Track Codec
+ *
+ * Packs a coaster's track into the engine's compact binary format
+ * (millimeter positions, 0.1 degree angles, delta + range coded) and back.
+ * Packed tracks are stored as base64 strings, since localStorage only holds
+ * text. Encoding needs the WASM module and returns null without it, so
+ * callers keep plain JSON. Decoding falls back to a JavaScript port of the
+ * decoder, so a packed save opens in any session.
+ */
+
+import { getPhysicsEngine, isWasmAvailable } from './physicsEngine';
+import type {
+  SerializedLoopSegment,
+  SerializedTrackPoint,
+  TrackElementType,
+} from '../stores/useRollerCoaster';
+
+// Matches TrackElementKind in native/physics_engine.cpp
+export const TRACK_ELEMENT_KINDS: readonly TrackElementType[] = [
+  'loop',
+  'corkscrew',
+  'helix',
+  'immelman',
+  'zero-g-roll',
+  'cobra-roll',
+];
+
+export interface UnpackedTrack {
+  trackPoints: SerializedTrackPoint[];
+  loopSegments: SerializedLoopSegment[];
+  isLooped: boolean;
+}
+
+export function encodeTrack(
+  trackPoints: SerializedTrackPoint[],
+  loopSegments: SerializedLoopSegment[],
+  isLooped: boolean
+): Uint8Array | null {
+  if (!isWasmAvailable()) return null;
+  const module = getPhysicsEngine();
+
+  const indexById = new Map<string, number>();
+  trackPoints.forEach((p, i) => indexById.set(p.id, i));
+
+  const points = new module.SavedTrackPointVector();
+  for (const p of trackPoints) {
+    points.push_back({ x: p.position[0], y: p.position[1], z: p.position[2], tilt: p.tilt });
+  }
+
+  const elements = new module.SavedTrackElementVector();
+  for (const seg of loopSegments) {
+    const pointIndex = indexById.get(seg.entryPointId);
+    if (pointIndex === undefined) continue;
+    elements.push_back({
+      pointIndex,
+      type: Math.max(0, TRACK_ELEMENT_KINDS.indexOf(seg.elementType ?? 'loop')),
+      radius: seg.radius,
+      pitch: seg.pitch ?? 12,
+      rotation: seg.rotation ?? 360,
+      leftHanded: seg.direction === 'left',
+    });
+  }
+
+  const track = new module.SavedTrack();
+  track.points = points;
+  track.elements = elements;
+  track.isLooped = isLooped;
+  points.delete();
+  elements.delete();
+
+  const bytes = module.TrackCodec.encode(track);
+  track.delete();
+  return bytes;
+}
+
+/**
+ * Rebuild serialized points and segments from packed bytes. IDs are not
+ * stored; points come back as point-1..point-N and segments reference them.
+ */
+export function decodeTrack(bytes: Uint8Array): UnpackedTrack | null {
+  const decoded = isWasmAvailable() ? decodeNative(bytes) : decodePacked(bytes);
+  if (!decoded) return null;
+
+  const trackPoints: SerializedTrackPoint[] = decoded.points.map((p, i) => ({
+    id: `point-${i + 1}`,
+    position: [p.x, p.y, p.z],
+    tilt: p.tilt,
+  }));
+
+  const loopSegments: SerializedLoopSegment[] = decoded.elements.map((e, i) => {
+    const elementType = TRACK_ELEMENT_KINDS[e.type] ?? 'loop';
+    const entry = trackPoints[e.pointIndex];
+    entry.hasLoop = true;
+    entry.elementType = elementType;
+    return {
+      id: `element-${i + 1}`,
+      entryPointId: entry.id,
+      elementType,
+      radius: e.radius,
+      pitch: e.pitch,
+      rotation: e.rotation,
+      direction: e.leftHanded ? 'left' : 'right',
+    };
+  });
+
+  return { trackPoints, loopSegments, isLooped: decoded.isLooped };
+}
+
+interface DecodedPoint {
+  x: number;
+  y: number;
+  z: number;
+  tilt: number;
+}
+
+interface DecodedElement {
+  pointIndex: number;
+  type: number;
+  radius: number;
+  pitch: number;
+  rotation: number;
+  leftHanded: boolean;
+}
+
+interface DecodedTrack {
+  points: DecodedPoint[];
+  elements: DecodedElement[];
+  isLooped: boolean;
+}
+
+function decodeNative(bytes: Uint8Array): DecodedTrack | null {
+  const module = getPhysicsEngine();
+  const track = new module.SavedTrack();
+  if (!module.TrackCodec.decode(bytes, track)) {
+    track.delete();
+    return null;
+  }
+
+  const points: DecodedPoint[] = [];
+  const pointVector = track.points;
+  for (let i = 0; i < pointVector.size(); i++) {
+    const p = pointVector.get(i);
+    points.push({ x: p.x, y: p.y, z: p.z, tilt: p.tilt });
+  }
+  pointVector.delete();
+
+  const elements: DecodedElement[] = [];
+  const elementVector = track.elements;
+  for (let i = 0; i < elementVector.size(); i++) {
+    const e = elementVector.get(i);
+    elements.push({
+      pointIndex: e.pointIndex,
+      type: e.type,
+      radius: e.radius,
+      pitch: e.pitch,
+      rotation: e.rotation,
+      leftHanded: e.leftHanded,
+    });
+  }
+  elementVector.delete();
+
+  const isLooped = track.isLooped;
+  track.delete();
+  return { points, elements, isLooped };
+}
+
+// ============================================================================
+// JavaScript decoder (mirrors TrackCodec::decode and rangecoder::Decoder in
+// native/physics_engine.cpp; keep the two in step)
+// ============================================================================
+
+const FORMAT_VERSION = 1;
+const POSITION_SCALE = 1000;
+const ANGLE_SCALE = 10;
+const MAX_POINTS = 1 << 20;
+const MAX_ELEMENTS = 1 << 16;
+const MAX_ITEMS_PER_BYTE = 16;
+const MAX_QUANTIZED = 1e12;
+const ELEMENT_KIND_COUNT = TRACK_ELEMENT_KINDS.length;
+
+const PROB_BITS = 11;
+const PROB_INIT = 1 << (PROB_BITS - 1);
+const MOVE_BITS = 5;
+const TOP = 1 << 24;
+
+class RangeDecoder {
+  private range = 0xffffffff;
+  private code = 0;
+  private pos: number;
+
+  constructor(private data: Uint8Array, start: number) {
+    this.pos = start;
+    for (let i = 0; i < 5; i++) this.code = ((this.code << 8) | this.next()) >>> 0;
+  }
+
+  // Reads past the end yield zeros; overrun() reports it afterwards
+  private next(): number {
+    return this.pos < this.data.length ? this.data[this.pos++] : (this.pos++, 0);
+  }
+
+  private normalize(): void {
+    while (this.range < TOP) {
+      this.range = (this.range << 8) >>> 0;
+      this.code = ((this.code << 8) | this.next()) >>> 0;
+    }
+  }
+
+  decodeBit(probs: Uint16Array, index: number): number {
+    const prob = probs[index];
+    const bound = (this.range >>> PROB_BITS) * prob;
+    let bit: number;
+    if (this.code < bound) {
+      this.range = bound;
+      probs[index] = prob + (((1 << PROB_BITS) - prob) >> MOVE_BITS);
+      bit = 0;
+    } else {
+      this.code -= bound;
+      this.range -= bound;
+      probs[index] = prob - (prob >> MOVE_BITS);
+      bit = 1;
+    }
+    this.normalize();
+    return bit;
+  }
+
+  decodeDirect(bits: number): number {
+    let value = 0;
+    for (let i = 0; i < bits; i++) {
+      this.range >>>= 1;
+      const bit = this.code >= this.range ? 1 : 0;
+      if (bit) this.code -= this.range;
+      value = value * 2 + bit;
+      this.normalize();
+    }
+    return value;
+  }
+
+  overrun(): boolean {
+    return this.pos > this.data.length;
+  }
+}
+
+// IntegerModel: 7-level bit tree for the bit length, then the raw bits
+// below the leading one, zigzag coded
+function integerModel(): Uint16Array {
+  return new Uint16Array(128).fill(PROB_INIT);
+}
+
+function decodeInteger(rc: RangeDecoder, lengthTree: Uint16Array): number {
+  let node = 1;
+  for (let i = 0; i < 7; i++) node = node * 2 + rc.decodeBit(lengthTree, node);
+  const length = Math.min(node - 128, 64);
+  if (length === 0) return 0;
+
+  let u = 1;
+  for (let remaining = length - 1; remaining > 0; ) {
+    const chunk = Math.min(remaining, 16);
+    remaining -= chunk;
+    u = u * (1 << chunk) + rc.decodeDirect(chunk);
+  }
+  // Past 2^53 the value is only approximate, but such lengths are corrupt
+  // and accumulate() rejects them
+  return u % 2 === 0 ? u / 2 : -(u + 1) / 2;
+}
+
+// Same bounds as TrackCodec::accumulate; returns NaN when out of range
+function accumulate(total: number, delta: number): number {
+  if (Math.abs(delta) > 2 * MAX_QUANTIZED) return NaN;
+  const next = total + delta;
+  return Math.abs(next) <= MAX_QUANTIZED ? next : NaN;
+}
+
+function decodePacked(bytes: Uint8Array): DecodedTrack | null {
+  if (
+    bytes.length < 5 ||
+    bytes[0] !== 0x52 || bytes[1] !== 0x43 || bytes[2] !== 0x54 || bytes[3] !== 0x4b ||
+    bytes[4] !== FORMAT_VERSION
+  ) {
+    return null;
+  }
+
+  const rc = new RangeDecoder(bytes, 5);
+  const looped = new Uint16Array(1).fill(PROB_INIT);
+  const leftHanded = new Uint16Array(1).fill(PROB_INIT);
+  const typeTree = new Uint16Array(8).fill(PROB_INIT);
+  const count = integerModel();
+  const [x, y, z, tilt] = [integerModel(), integerModel(), integerModel(), integerModel()];
+  const [pointIndex, radius, pitch, rotation] = [integerModel(), integerModel(), integerModel(), integerModel()];
+
+  const isLooped = rc.decodeBit(looped, 0) !== 0;
+  const pointCount = decodeInteger(rc, count);
+  const elementCount = decodeInteger(rc, count);
+  if (
+    pointCount < 0 || pointCount > MAX_POINTS ||
+    elementCount < 0 || elementCount > MAX_ELEMENTS ||
+    pointCount + elementCount > (bytes.length - 5) * MAX_ITEMS_PER_BYTE
+  ) {
+    return null;
+  }
+
+  const points: DecodedPoint[] = [];
+  let px = 0, py = 0, pz = 0, pt = 0;
+  for (let i = 0; i < pointCount; i++) {
+    px = accumulate(px, decodeInteger(rc, x));
+    py = accumulate(py, decodeInteger(rc, y));
+    pz = accumulate(pz, decodeInteger(rc, z));
+    pt = accumulate(pt, decodeInteger(rc, tilt));
+    if (Number.isNaN(px + py + pz + pt)) return null;
+    points.push({ x: px / POSITION_SCALE, y: py / POSITION_SCALE, z: pz / POSITION_SCALE, tilt: pt / ANGLE_SCALE });
+  }
+
+  const elements: DecodedElement[] = [];
+  let pi = 0, pr = 0, pp = 0, prot = 0;
+  for (let i = 0; i < elementCount; i++) {
+    pi = accumulate(pi, decodeInteger(rc, pointIndex));
+    if (!(pi >= 0 && pi < pointCount)) return null;
+    let node = 1;
+    for (let b = 0; b < 3; b++) node = node * 2 + rc.decodeBit(typeTree, node);
+    const type = node - 8;
+    if (type >= ELEMENT_KIND_COUNT) return null;
+    const left = rc.decodeBit(leftHanded, 0) !== 0;
+    pr = accumulate(pr, decodeInteger(rc, radius));
+    pp = accumulate(pp, decodeInteger(rc, pitch));
+    prot = accumulate(prot, decodeInteger(rc, rotation));
+    if (Number.isNaN(pr + pp + prot)) return null;
+    elements.push({
+      pointIndex: pi,
+      type,
+      radius: pr / POSITION_SCALE,
+      pitch: pp / POSITION_SCALE,
+      rotation: prot / ANGLE_SCALE,
+      leftHanded: left,
+    });
+  }
+
+  return rc.overrun() ? null : { points, elements, isLooped };
+}
+
+export function bytesToBase64(bytes: Uint8Array): string {
+  let binary = '';
+  for (let i = 0; i < bytes.length; i += 0x8000) {
+    binary += String.fromCharCode(...bytes.subarray(i, i + 0x8000));
+  }
+  return btoa(binary);
+}
+
+export function base64ToBytes(base64: string): Uint8Array {
+  const binary = atob(base64);
+  const bytes = new Uint8Array(binary.length);
+  for (let i = 0; i < binary.length; i++) {
+    bytes[i] = binary.charCodeAt(i);
+  }
+  return bytes;
+}
@@ -0,0 +1,203 @@
+/**
+ * Editor Track Engine
+ *
+ * One native engine that follows the coaster being edited, shared by the
+ * stats panel and anything else that reads the current model. Edits start
+ * a background rebuild (beginTrackBuild) that a frame loop pumps a few
+ * milliseconds at a time, so dragging a point never waits on the model; a
+ * newer edit supersedes a build still in flight. Stats need a headless
+ * ride, so they run once edits settle and are published with the model
+ * version they describe. Until then readers fall back to the JS estimates.
+ * Opening a saved coaster tries its warm-start tables (trackTables.ts)
+ * before building.
+ */
+
+import {
+  createPhysicsEngine,
+  createTrackPointDataVector,
+  getPhysicsEngine,
+  loadPhysicsEngine,
+  readTrackStats,
+  type NativeTrackPointInput,
+  type PhysicsEngineInstance,
+  type TrackStatsNative,
+} from './physicsEngine';
+import { getStoredTables, storeTables } from './trackTables';
+
+// Per frame on single-threaded builds; threaded builds only adopt
+const PUMP_BUDGET_MS = 3;
+// Quiet time after the last landed build before the stats ride
+const STATS_DELAY_MS = 150;
+
+export interface TrackEngineSnapshot {
+  engine: PhysicsEngineInstance | null;
+  version: number;                 // model in use; 0 until the first build lands
+  stats: TrackStatsNative | null;  // for `version`, once computed
+}
+
+interface TrackRequest {
+  points: NativeTrackPointInput[];
+  isLooped: boolean;
+  hasChainLift: boolean;
+}
+
+let engine: PhysicsEngineInstance | null = null;
+let startPromise: Promise<boolean> | null = null;
+let request: TrackRequest | null = null;
+let submittedPoints: NativeTrackPointInput[] | null = null;
+let submittedLooped = false;
+let snapshot: TrackEngineSnapshot = { engine: null, version: 0, stats: null };
+const listeners = new Set<() => void>();
+
+// Saved coaster the next new geometry belongs to (openSavedEditorTrack)
+let pendingTablesKey: string | null = null;
+// Key to store the submitted geometry's tables under once its build lands
+let tablesKey: string | null = null;
+// Submitted points still waiting on their stored tables
+let warmStartPoints: NativeTrackPointInput[] | null = null;
+
+let pumpHandle = 0;
+let statsTimer: ReturnType<typeof setTimeout> | null = null;
+
+function publish(next: TrackEngineSnapshot): void {
+  snapshot = next;
+  listeners.forEach(listener => listener());
+}
+
+/**
+ * Load the engine once the editor opens (useTrackEngine). Resolves false
+ * (and the editor keeps its JS fallbacks) if WASM is unavailable.
+ */
+export function startTrackEngine(): Promise<boolean> {
+  // Every editor component asks; the first one loads
+  startPromise ??= loadTrackEngine();
+  return startPromise;
+}
+
+async function loadTrackEngine(): Promise<boolean> {
+  try {
+    await loadPhysicsEngine();
+  } catch {
+    return false;
+  }
+  engine = createPhysicsEngine();
+  if (!engine) return false;
+  
+  publish({ ...snapshot, engine });
+  if (request) submit();
+  return true;
+}
+
+/**
+ * The next track submitted is the saved coaster `key` being opened: its
+ * stored tables are tried before any build, and the tables of a fresh
+ * build are stored for the next open. Call before the store loads it.
+ */
+export function openSavedEditorTrack(key: string): void {
+  pendingTablesKey = key;
+}
+
+/**
+ * Point the engine at the edited track. Cheap to call on every edit: the
+ * rebuild happens in the background and only the newest request lands.
+ */
+export function setEditorTrack(points: NativeTrackPointInput[], isLooped: boolean, hasChainLift: boolean): void {
+  request = { points, isLooped, hasChainLift };
+  if (engine) submit();
+}
+
+function submit(): void {
+  if (!engine || !request) return;
+  const { points, isLooped, hasChainLift } = request;
+  
+  engine.setChainLift(hasChainLift);
+  if (points !== submittedPoints || isLooped !== submittedLooped) {
+    submittedPoints = points;
+    submittedLooped = isLooped;
+    tablesKey = pendingTablesKey;
+    pendingTablesKey = null;
+    if (tablesKey) {
+      warmStartPoints = points;
+      void warmStart(tablesKey, points, isLooped);
+    } else {
+      warmStartPoints = null;
+      const trackPoints = createTrackPointDataVector(getPhysicsEngine(), points);
+      engine.beginTrackBuild(trackPoints, isLooped);
+      trackPoints.delete();
+    }
+  }
+  
+  // Stats on screen describe the previous request now
+  publish({ ...snapshot, stats: null });
+  cancelStats();
+  if (!warmStartPoints && !pumpHandle) pumpHandle = requestAnimationFrame(pump);
+}
+
+async function warmStart(key: string, points: NativeTrackPointInput[], isLooped: boolean): Promise<void> {
+  const stored = await getStoredTables(key);
+  // A newer edit went in while storage answered
+  if (!engine || warmStartPoints !== points) return;
+  warmStartPoints = null;
+  
+  // Missing or stale tables start the background build; the pump stores
+  // its tables when it lands
+  const trackPoints = createTrackPointDataVector(getPhysicsEngine(), points);
+  let warm = false;
+  if (stored) warm = engine.beginTrackBuildFromTables(trackPoints, isLooped, stored);
+  else engine.beginTrackBuild(trackPoints, isLooped);
+  trackPoints.delete();
+  if (warm) {
+    tablesKey = null;
+    publish({ ...snapshot, version: engine.getTrackVersion() });
+    scheduleStats();
+    return;
+  }
+  
+  if (!pumpHandle) pumpHandle = requestAnimationFrame(pump);
+}
+
+function pump(): void {
+  pumpHandle = 0;
+  if (!engine) return;
+  
+  if (!engine.pumpTrackBuild(PUMP_BUDGET_MS)) {
+    pumpHandle = requestAnimationFrame(pump);
+    return;
+  }
+  
+  if (tablesKey) {
+    void storeTables(tablesKey, engine.getTrackTables());
+    tablesKey = null;
+  }
+  
+  const version = engine.getTrackVersion();
+  if (version !== snapshot.version) publish({ ...snapshot, version });
+  scheduleStats();
+}
+
+function cancelStats(): void {
+  if (statsTimer !== null) {
+    clearTimeout(statsTimer);
+    statsTimer = null;
+  }
+}
+
+function scheduleStats(): void {
+  cancelStats();
+  statsTimer = setTimeout(() => {
+    statsTimer = null;
+    if (!engine || engine.isTrackBuildPending()) return;
+    publish({ ...snapshot, version: engine.getTrackVersion(), stats: readTrackStats(engine) });
+  }, STATS_DELAY_MS);
+}
+
+export function getTrackEngineSnapshot(): TrackEngineSnapshot {
+  return snapshot;
+}
+
+export function subscribeTrackEngine(listener: () => void): () => void {
+  listeners.add(listener);
+  return () => {
+    listeners.delete(listener);
+  };
+}
@@ -0,0 +1,137 @@
+/**
+ * Track Profile Drawing
+ *
+ * The engine builds flat polylines for the 2D views (minimap outline,
+ * elevation, banking, curvature comb), simplified for the current scale
+ * and cached per track version, so redrawing is just walking a
+ * Float32Array. These helpers do that walk.
+ *
+ * Layouts:
+ *   minimap              [x, z, height, speed] per vertex
+ *   elevation / banking  [arcLength, value] per vertex
+ *   curvature comb       [arcLength, height, verticalCurvature, curvature] per tooth
+ */
+
+import { PhysicsEngineInstance } from './physicsEngine';
+
+export const MINIMAP_STRIDE = 4;
+export const PROFILE_STRIDE = 2;
+export const COMB_STRIDE = 4;
+
+export interface ProfileView {
+  pxPerMeter: number;   // horizontal: pixels per meter of arc length
+  pxPerUnitY: number;   // vertical: pixels per meter (elevation) or degree (banking)
+  originX: number;      // screen x of arc length 0
+  baselineY: number;    // screen y of value 0
+}
+
+export interface TrackProfileData {
+  elevation: Float32Array;
+  banking: Float32Array;
+  comb: Float32Array;
+}
+
+/**
+ * Fetch all three profiles for a view. Repeated calls with the same scale
+ * are served from the engine's cache.
+ */
+export function getTrackProfiles(
+  engine: PhysicsEngineInstance,
+  elevationView: ProfileView,
+  bankingView: ProfileView,
+  tolerancePx: number = 0.5,
+  combSpacingPx: number = 6
+): TrackProfileData {
+  return {
+    elevation: engine.getElevationProfile(elevationView.pxPerMeter, elevationView.pxPerUnitY, tolerancePx),
+    banking: engine.getBankingProfile(bankingView.pxPerMeter, bankingView.pxPerUnitY, tolerancePx),
+    comb: engine.getCurvatureComb(elevationView.pxPerMeter, combSpacingPx),
+  };
+}
+
+/**
+ * Stroke the top-down outline, one color per segment from the caller's
+ * colorFor(height, speed). toCanvas maps world x/z to canvas coordinates.
+ */
+export function strokeMinimap(
+  ctx: CanvasRenderingContext2D,
+  outline: Float32Array,
+  toCanvas: (x: number, z: number) => { x: number; y: number },
+  colorFor: (height: number, speed: number) => string
+): void {
+  let prev = outline.length >= MINIMAP_STRIDE ? toCanvas(outline[0], outline[1]) : null;
+  for (let i = MINIMAP_STRIDE; prev && i < outline.length; i += MINIMAP_STRIDE) {
+    const next = toCanvas(outline[i], outline[i + 1]);
+    const j = i - MINIMAP_STRIDE;
+    ctx.strokeStyle = colorFor((outline[j + 2] + outline[i + 2]) / 2, (outline[j + 3] + outline[i + 3]) / 2);
+    ctx.beginPath();
+    ctx.moveTo(prev.x, prev.y);
+    ctx.lineTo(next.x, next.y);
+    ctx.stroke();
+    prev = next;
+  }
+}
+
+/**
+ * Value and slope (per meter) of an elevation or banking profile at an arc
+ * length, interpolated between its vertices and clamped to its ends.
+ */
+export function sampleProfile(data: Float32Array, arcLength: number): { value: number; slope: number } {
+  const count = data.length / PROFILE_STRIDE;
+  if (count === 0) return { value: 0, slope: 0 };
+  if (count === 1) return { value: data[1], slope: 0 };
+
+  // Last vertex at or before arcLength, by bisection
+  let lo = 0;
+  let hi = count - 1;
+  while (hi - lo > 1) {
+    const mid = (lo + hi) >> 1;
+    if (data[mid * PROFILE_STRIDE] <= arcLength) lo = mid;
+    else hi = mid;
+  }
+
+  const x0 = data[lo * PROFILE_STRIDE];
+  const y0 = data[lo * PROFILE_STRIDE + 1];
+  const x1 = data[hi * PROFILE_STRIDE];
+  const y1 = data[hi * PROFILE_STRIDE + 1];
+  const slope = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0;
+  const t = Math.max(0, Math.min(1, x1 > x0 ? (arcLength - x0) / (x1 - x0) : 0));
+  return { value: y0 + (y1 - y0) * t, slope };
+}
+
+export function strokeProfile(
+  ctx: CanvasRenderingContext2D,
+  data: Float32Array,
+  view: ProfileView
+): void {
+  if (data.length < 2 * PROFILE_STRIDE) return;
+
+  ctx.beginPath();
+  ctx.moveTo(view.originX + data[0] * view.pxPerMeter, view.baselineY - data[1] * view.pxPerUnitY);
+  for (let i = PROFILE_STRIDE; i < data.length; i += PROFILE_STRIDE) {
+    ctx.lineTo(view.originX + data[i] * view.pxPerMeter, view.baselineY - data[i + 1] * view.pxPerUnitY);
+  }
+  ctx.stroke();
+}
+
+/**
+ * Draw comb teeth straight up (bending upward) or down from the elevation
+ * line, toothPxPerCurvature pixels per 1/m of vertical curvature.
+ */
+export function strokeCurvatureComb(
+  ctx: CanvasRenderingContext2D,
+  comb: Float32Array,
+  view: ProfileView,
+  toothPxPerCurvature: number = 400
+): void {
+  if (comb.length === 0) return;
+
+  ctx.beginPath();
+  for (let i = 0; i < comb.length; i += COMB_STRIDE) {
+    const x = view.originX + comb[i] * view.pxPerMeter;
+    const y = view.baselineY - comb[i + 1] * view.pxPerUnitY;
+    ctx.moveTo(x, y);
+    ctx.lineTo(x, y - comb[i + 2] * toothPxPerCurvature);
+  }
+  ctx.stroke();
+}
@@ -0,0 +1,143 @@
+/**
+ * Warm-Start Track Tables
+ *
+ * Keeps the engine's precomputed track tables (frames, loop zones,
+ * validation) in IndexedDB so reopening an unchanged coaster skips the
+ * rebuild in setTrack(). The engine checks the blob against the exact
+ * points, its format version, its physics revision and a checksum, and
+ * rebuilds on any mismatch. The fresh tables then replace the stale entry.
+ * Only the last MAX_ENTRIES coasters opened keep their tables. Storage
+ * failures (private mode, quota) only cost the warm start.
+ */
+
+import type { RideEngineInstance, TrackPointDataVector } from './physicsEngine';
+
+const DB_NAME = 'coaster-track-tables';
+const DB_VERSION = 2;
+const STORE = 'tables';
+// Tables for the most recently opened coasters; older entries are evicted
+const MAX_ENTRIES = 16;
+
+interface StoredTables {
+  tables: Uint8Array;
+  usedAt: number;  // ms timestamp of the last store or open
+}
+
+let dbPromise: Promise<IDBDatabase> | null = null;
+
+function openDb(): Promise<IDBDatabase> {
+  if (!dbPromise) {
+    dbPromise = new Promise((resolve, reject) => {
+      const request = indexedDB.open(DB_NAME, DB_VERSION);
+      // Version 1 stored bare blobs with no timestamp; start over
+      request.onupgradeneeded = () => {
+        const db = request.result;
+        if (db.objectStoreNames.contains(STORE)) db.deleteObjectStore(STORE);
+        db.createObjectStore(STORE).createIndex('usedAt', 'usedAt');
+      };
+      request.onsuccess = () => resolve(request.result);
+      request.onerror = () => reject(request.error);
+    });
+    dbPromise.catch(() => {
+      dbPromise = null;
+    });
+  }
+  return dbPromise;
+}
+
+// One transaction; resolves with what `body` reports once it commits
+function transact<T>(
+  mode: IDBTransactionMode,
+  body: (store: IDBObjectStore, report: (value: T) => void) => void
+): Promise<T | undefined> {
+  return openDb().then(
+    db =>
+      new Promise<T | undefined>((resolve, reject) => {
+        const tx = db.transaction(STORE, mode);
+        let result: T | undefined;
+        body(tx.objectStore(STORE), value => {
+          result = value;
+        });
+        tx.oncomplete = () => resolve(result);
+        tx.onerror = () => reject(tx.error);
+        tx.onabort = () => reject(tx.error);
+      })
+  );
+}
+
+export async function getStoredTables(key: string): Promise<Uint8Array | null> {
+  try {
+    const tables = await transact<Uint8Array>('readwrite', (store, report) => {
+      const request = store.get(key);
+      request.onsuccess = () => {
+        const entry = request.result as StoredTables | undefined;
+        if (!(entry?.tables instanceof Uint8Array)) return;
+        report(entry.tables);
+        // Opened again, so evicted last
+        const touched: StoredTables = { tables: entry.tables, usedAt: Date.now() };
+        store.put(touched, key);
+      };
+    });
+    return tables ?? null;
+  } catch {
+    return null;
+  }
+}
+
+export async function storeTables(key: string, tables: Uint8Array): Promise<void> {
+  try {
+    await transact<void>('readwrite', store => {
+      const entry: StoredTables = { tables, usedAt: Date.now() };
+      store.put(entry, key);
+      
+      // Requests run in order, so the count includes the entry just put,
+      // which is also the newest and never among the evicted
+      const count = store.count();
+      count.onsuccess = () => {
+        let excess = count.result - MAX_ENTRIES;
+        if (excess <= 0) return;
+        const cursor = store.index('usedAt').openKeyCursor();
+        cursor.onsuccess = () => {
+          const oldest = cursor.result;
+          if (!oldest || excess-- <= 0) return;
+          store.delete(oldest.primaryKey);
+          oldest.continue();
+        };
+      };
+    });
+  } catch {
+    // Warm start is an optimization; nothing to recover
+  }
+}
+
+export async function deleteStoredTables(key: string): Promise<void> {
+  try {
+    await transact<void>('readwrite', store => {
+      store.delete(key);
+    });
+  } catch {
+    // Evicted eventually either way
+  }
+}
+
+/**
+ * setTrack() through the table cache. `key` names the saved coaster (its
+ * id, or tables shipped alongside it by the server). Resolves true when
+ * the stored tables were used. The editor engine warm-starts through
+ * openSavedEditorTrack() in trackEngine.ts instead.
+ */
+export async function setTrackWarm(
+  engine: Pick<RideEngineInstance, 'setTrack' | 'setTrackFromTables' | 'getTrackTables'>,
+  key: string,
+  points: TrackPointDataVector,
+  isLooped: boolean
+): Promise<boolean> {
+  const stored = await getStoredTables(key);
+  if (stored && engine.setTrackFromTables(points, isLooped, stored)) {
+    return true;
+  }
+
+  if (!stored) engine.setTrack(points, isLooped);
+  void storeTables(key, engine.getTrackTables());
+  return false;
+}
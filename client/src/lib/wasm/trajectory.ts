@@ -0,0 +1,95 @@
+/**
+ * Ride Trajectories
+ *
+ * Records a headless ride in the engine and packs it with the trajectory
+ * codec (keyframed blocks, per-channel error bounds, smallest-three
+ * quaternions), and plays encoded rides back by time. Playback streams:
+ * each fetched chunk is handed to the reader as it arrives, and any time
+ * whose block has loaded can be sampled before the rest of the file.
+ */
+
+import {
+  DEFAULT_TRAJECTORY_OPTIONS,
+  PhysicsEngineInstance,
+  TrajectoryCodecOptions,
+  TrajectoryReaderInstance,
+  TrajectorySample,
+  getPhysicsEngine,
+} from './physicsEngine';
+
+/**
+ * Encode one lap of the engine's current track sampled at rateHz
+ */
+export function encodeRecordedRide(
+  engine: PhysicsEngineInstance,
+  rateHz: number = 60,
+  options: Partial<TrajectoryCodecOptions> = {}
+): Uint8Array {
+  const module = getPhysicsEngine();
+  const samples = engine.recordRide(rateHz);
+  const bytes = module.TrajectoryCodec.encode(samples, { ...DEFAULT_TRAJECTORY_OPTIONS, ...options });
+  samples.delete();
+  return bytes;
+}
+
+export class TrajectoryPlayer {
+  private reader: TrajectoryReaderInstance;
+  private abort: AbortController | null = null;
+
+  constructor() {
+    this.reader = new (getPhysicsEngine().TrajectoryReader)();
+  }
+
+  static fromBytes(bytes: Uint8Array): TrajectoryPlayer {
+    const player = new TrajectoryPlayer();
+    player.reader.append(bytes);
+    return player;
+  }
+
+  /**
+   * Start streaming an encoded ride. Resolves when the download finishes;
+   * sampling works as soon as the header and first block are in.
+   */
+  async stream(url: string): Promise<void> {
+    this.abort?.abort();
+    this.abort = new AbortController();
+
+    const response = await fetch(url, { signal: this.abort.signal });
+    if (!response.ok || !response.body) {
+      throw new Error(`Failed to fetch trajectory: ${response.status}`);
+    }
+
+    const body = response.body.getReader();
+    for (;;) {
+      const { done, value } = await body.read();
+      if (done) break;
+      this.reader.append(value);
+    }
+  }
+
+  get isReady(): boolean {
+    return this.reader.isValid() && this.loadedEndTime > this.startTime;
+  }
+
+  get sampleCount(): number {
+    return this.reader.getSampleCount();
+  }
+
+  get startTime(): number {
+    return this.reader.getStartTime();
+  }
+
+  // Playable up to here; grows while streaming
+  get loadedEndTime(): number {
+    return this.reader.getLoadedEndTime();
+  }
+
+  sampleAt(time: number): TrajectorySample {
+    return this.reader.sampleAt(time);
+  }
+
+  dispose(): void {
+    this.abort?.abort();
+    this.reader.delete();
+  }
+}
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/physics_engine.dir/physics_engine.cpp.o"
+  "CMakeFiles/physics_engine.dir/physics_engine.cpp.o.d"
+  "libphysics_engine.a"
+  "libphysics_engine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/physics_engine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
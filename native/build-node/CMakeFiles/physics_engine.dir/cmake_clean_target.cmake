@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libphysics_engine.a"
+)
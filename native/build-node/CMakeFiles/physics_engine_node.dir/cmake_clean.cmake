@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/server/native/physics_engine.node"
+  "/root/repo/server/native/physics_engine.pdb"
+  "CMakeFiles/physics_engine_node.dir/node_addon.cpp.o"
+  "CMakeFiles/physics_engine_node.dir/node_addon.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/physics_engine_node.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,620 @@
+/**
+ * Roller Coaster Physics Engine - Node-API Addon
+ *
+ * Exposes the C++ core to the Express server so uploaded tracks can be
+ * validated and scored at native speed. Every call parses its arguments on
+ * the JS thread, runs the track build and analysis on libuv's thread pool
+ * (napi_async_work) and resolves a Promise, so the event loop never blocks
+ * on physics.
+ *
+ *   validateTrack(points, isLooped, hasChainLift)   -> ValidationResult[]
+ *   analyzeTrack(points, isLooped, hasChainLift)    -> { stats, validation, stall, descriptor }
+ *   simulateRide(points, isLooped, hasChainLift, rateHz)
+ *       -> { rideTime, completed, samples: Float64Array }  (SAMPLE_STRIDE per step)
+ *   describeTrack(points, isLooped, hasChainLift)   -> Float32Array (DESCRIPTOR_LENGTH)
+ *   simulateRobustness(points, isLooped, hasChainLift, options?)
+ *       -> { samples, stallProbability, exceedanceProbability, sections }
+ *   canonicalTrack(points, isLooped, hasChainLift)  -> Buffer (synchronous)
+ *
+ *   new SimilarityIndex()   k-NN over descriptors, synchronous on the JS thread:
+ *       add(id, descriptor) -> boolean, remove(id) -> boolean, has(id),
+ *       get(id) -> Float32Array | null, size(),
+ *       query(descriptor, k, excludeId?) -> { id, distance }[]
+ *
+ * Points are { x, y, z, tilt?, hasLoop?, loopRadius?, loopPitch? }, the
+ * same shape the client passes to the WASM engine.
+ */
+
+#include <node_api.h>
+
+// The core is a single translation unit; without __EMSCRIPTEN__ it has no
+// bindings and no Emscripten dependency
+#include "physics_engine.cpp"
+
+namespace {
+
+constexpr uint32_t MAX_TRACK_POINTS = 4096;
+constexpr double MAX_SAMPLE_RATE = 240.0;  // Hz; bounds simulateRide output
+constexpr uint32_t SAMPLE_STRIDE = 11;     // doubles per TrajectorySample
+
+enum JobKind { JOB_VALIDATE, JOB_ANALYZE, JOB_SIMULATE, JOB_DESCRIBE, JOB_ROBUSTNESS };
+
+// One request: inputs copied off the JS heap, outputs filled on a worker
+struct TrackJob {
+    JobKind kind;
+    std::vector<TrackPointData> points;
+    bool isLooped = false;
+    bool hasChainLift = false;
+    double rateHz = 60.0;
+    RobustnessOptions robustnessOptions;
+
+    napi_deferred deferred = nullptr;
+    napi_async_work work = nullptr;
+
+    std::vector<ValidationResult> validation;
+    TrackStats stats = {};
+    StallPrediction stall = {};
+    std::vector<TrajectorySample> samples;
+    std::vector<float> descriptor;
+    RobustnessReport robustness = {};
+};
+
+#define NAPI_CHECK(env, call)                                       \
+    do {                                                            \
+        if ((call) != napi_ok) {                                    \
+            napi_throw_error((env), nullptr, "Node-API call failed: " #call); \
+            return nullptr;                                         \
+        }                                                           \
+    } while (0)
+
+// ----------------------------------------------------------------------------
+// JS -> C++
+// ----------------------------------------------------------------------------
+
+bool getNumberProperty(napi_env env, napi_value object, const char* name, double& out) {
+    bool has = false;
+    if (napi_has_named_property(env, object, name, &has) != napi_ok || !has) return false;
+    napi_value value;
+    if (napi_get_named_property(env, object, name, &value) != napi_ok) return false;
+    return napi_get_value_double(env, value, &out) == napi_ok && std::isfinite(out);
+}
+
+bool getBoolProperty(napi_env env, napi_value object, const char* name, bool& out) {
+    bool has = false;
+    if (napi_has_named_property(env, object, name, &has) != napi_ok || !has) return false;
+    napi_value value;
+    if (napi_get_named_property(env, object, name, &value) != napi_ok) return false;
+    return napi_get_value_bool(env, value, &out) == napi_ok;
+}
+
+// Returns an error message, or nullptr when `points` was filled
+const char* readTrackPoints(napi_env env, napi_value array, std::vector<TrackPointData>& points) {
+    bool isArray = false;
+    if (napi_is_array(env, array, &isArray) != napi_ok || !isArray) return "points must be an array";
+
+    uint32_t length = 0;
+    napi_get_array_length(env, array, &length);
+    if (length > MAX_TRACK_POINTS) return "too many track points";
+
+    points.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_valuetype type;
+        if (napi_get_element(env, array, i, &element) != napi_ok ||
+            napi_typeof(env, element, &type) != napi_ok || type != napi_object) {
+            return "each point must be an object";
+        }
+
+        TrackPointData& p = points[i];
+        if (!getNumberProperty(env, element, "x", p.position.x) ||
+            !getNumberProperty(env, element, "y", p.position.y) ||
+            !getNumberProperty(env, element, "z", p.position.z)) {
+            return "each point needs finite x, y and z";
+        }
+        getNumberProperty(env, element, "tilt", p.tilt);
+        getBoolProperty(env, element, "hasLoop", p.hasLoop);
+        getNumberProperty(env, element, "loopRadius", p.loopRadius);
+        getNumberProperty(env, element, "loopPitch", p.loopPitch);
+    }
+    return nullptr;
+}
+
+bool readBool(napi_env env, napi_value value, bool fallback) {
+    bool out = fallback;
+    napi_get_value_bool(env, value, &out);
+    return out;
+}
+
+bool readString(napi_env env, napi_value value, std::string& out) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) return false;
+    out.resize(length);
+    return napi_get_value_string_utf8(env, value, &out[0], length + 1, &length) == napi_ok;
+}
+
+// Missing fields keep RobustnessOptions' defaults
+void readRobustnessOptions(napi_env env, napi_value object, RobustnessOptions& options) {
+    napi_valuetype type;
+    if (napi_typeof(env, object, &type) != napi_ok || type != napi_object) return;
+
+    // Clamped before the integer casts, which are undefined out of range
+    double value;
+    if (getNumberProperty(env, object, "samples", value)) {
+        options.samples = static_cast<int>(std::max(0.0, std::min(value, double(MonteCarloRides::MAX_SAMPLES))));
+    }
+    if (getNumberProperty(env, object, "seed", value)) {
+        options.seed = static_cast<uint32_t>(std::max(0.0, std::min(value, 4294967295.0)));
+    }
+    if (getNumberProperty(env, object, "threads", value)) {
+        options.threads = static_cast<int>(std::max(0.0, std::min(value, double(MonteCarloRides::MAX_THREADS))));
+    }
+    getNumberProperty(env, object, "minOccupancy", options.minOccupancy);
+    getNumberProperty(env, object, "maxOccupancy", options.maxOccupancy);
+    getNumberProperty(env, object, "frictionSigma", options.frictionSigma);
+    getNumberProperty(env, object, "meanWindSpeed", options.meanWindSpeed);
+}
+
+// Descriptors arrive as the Float32Array describeTrack() produced
+bool readDescriptor(napi_env env, napi_value value, std::vector<float>& out) {
+    bool isTypedArray = false;
+    if (napi_is_typedarray(env, value, &isTypedArray) != napi_ok || !isTypedArray) return false;
+
+    napi_typedarray_type type;
+    size_t length = 0;
+    void* data = nullptr;
+    if (napi_get_typedarray_info(env, value, &type, &length, &data, nullptr, nullptr) != napi_ok ||
+        type != napi_float32_array || length != static_cast<size_t>(TrackDescriptor::DIMENSIONS)) {
+        return false;
+    }
+    const float* values = static_cast<const float*>(data);
+    out.assign(values, values + length);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// C++ -> JS
+// ----------------------------------------------------------------------------
+
+void setNumber(napi_env env, napi_value object, const char* name, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+void setBool(napi_env env, napi_value object, const char* name, bool value) {
+    napi_value v;
+    napi_get_boolean(env, value, &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+void setString(napi_env env, napi_value object, const char* name, const std::string& value) {
+    napi_value v;
+    napi_create_string_utf8(env, value.c_str(), value.size(), &v);
+    napi_set_named_property(env, object, name, v);
+}
+
+napi_value toJs(napi_env env, const std::vector<ValidationResult>& results) {
+    napi_value array;
+    napi_create_array_with_length(env, results.size(), &array);
+    for (size_t i = 0; i < results.size(); i++) {
+        const ValidationResult& r = results[i];
+        napi_value object;
+        napi_create_object(env, &object);
+        setBool(env, object, "isValid", r.isValid);
+        setString(env, object, "message", r.message);
+        setNumber(env, object, "severity", r.severity);
+        setNumber(env, object, "pointIndex", r.pointIndex);
+        setNumber(env, object, "value", r.value);
+        napi_set_element(env, array, static_cast<uint32_t>(i), object);
+    }
+    return array;
+}
+
+napi_value toJs(napi_env env, const TrackStats& s) {
+    napi_value object;
+    napi_create_object(env, &object);
+    setNumber(env, object, "totalLength", s.totalLength);
+    setNumber(env, object, "elementLength", s.elementLength);
+    setNumber(env, object, "minHeight", s.minHeight);
+    setNumber(env, object, "maxHeight", s.maxHeight);
+    setNumber(env, object, "maxGrade", s.maxGrade);
+    setNumber(env, object, "maxBank", s.maxBank);
+    setNumber(env, object, "inversions", s.inversions);
+    setNumber(env, object, "elements", s.elements);
+    setNumber(env, object, "rideTime", s.rideTime);
+    setNumber(env, object, "maxSpeed", s.maxSpeed);
+    setNumber(env, object, "maxGForce", s.maxGForce);
+    setBool(env, object, "rideCompleted", s.rideCompleted);
+    return object;
+}
+
+napi_value toJs(napi_env env, const StallPrediction& p) {
+    napi_value object;
+    napi_create_object(env, &object);
+    setNumber(env, object, "outcome", p.outcome);
+    setNumber(env, object, "stallProgress", p.stallProgress);
+    setNumber(env, object, "hillPoint", p.hillPoint);
+    setNumber(env, object, "shortfall", p.shortfall);
+    setNumber(env, object, "swings", p.swings);
+    setNumber(env, object, "restProgress", p.restProgress);
+    setNumber(env, object, "minSpeed", p.minSpeed);
+    setNumber(env, object, "minSpeedProgress", p.minSpeedProgress);
+    return object;
+}
+
+napi_value toJs(napi_env env, const RobustnessReport& r) {
+    napi_value object, sections;
+    napi_create_object(env, &object);
+    setNumber(env, object, "samples", r.samples);
+    setNumber(env, object, "stallProbability", r.stallProbability);
+    setNumber(env, object, "exceedanceProbability", r.exceedanceProbability);
+
+    napi_create_array_with_length(env, r.sections.size(), &sections);
+    for (size_t i = 0; i < r.sections.size(); i++) {
+        const RobustnessSection& s = r.sections[i];
+        napi_value section;
+        napi_create_object(env, &section);
+        setNumber(env, section, "startProgress", s.startProgress);
+        setNumber(env, section, "endProgress", s.endProgress);
+        setNumber(env, section, "reachProbability", s.reachProbability);
+        setNumber(env, section, "stallProbability", s.stallProbability);
+        setNumber(env, section, "exceedanceProbability", s.exceedanceProbability);
+        setNumber(env, section, "maxVerticalG", s.maxVerticalG);
+        setNumber(env, section, "minVerticalG", s.minVerticalG);
+        setNumber(env, section, "maxLateralG", s.maxLateralG);
+        napi_set_element(env, sections, static_cast<uint32_t>(i), section);
+    }
+    napi_set_named_property(env, object, "sections", sections);
+    return object;
+}
+
+napi_value toJs(napi_env env, const std::vector<float>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size() * sizeof(float), &data, &buffer);
+    if (!values.empty()) std::memcpy(data, values.data(), values.size() * sizeof(float));
+    napi_create_typedarray(env, napi_float32_array, values.size(), buffer, 0, &array);
+    return array;
+}
+
+napi_value toJs(napi_env env, const std::vector<SimilarityMatch>& matches) {
+    napi_value array;
+    napi_create_array_with_length(env, matches.size(), &array);
+    for (size_t i = 0; i < matches.size(); i++) {
+        napi_value object;
+        napi_create_object(env, &object);
+        setString(env, object, "id", matches[i].id);
+        setNumber(env, object, "distance", matches[i].distance);
+        napi_set_element(env, array, static_cast<uint32_t>(i), object);
+    }
+    return array;
+}
+
+napi_value toJs(napi_env env, const std::vector<TrajectorySample>& samples) {
+    size_t count = samples.size() * SAMPLE_STRIDE;
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, count * sizeof(double), &data, &buffer);
+
+    double* out = static_cast<double*>(data);
+    for (const TrajectorySample& s : samples) {
+        const double values[SAMPLE_STRIDE] = {
+            s.time, s.x, s.y, s.z, s.qx, s.qy, s.qz, s.qw, s.speed, s.gForceVertical, s.gForceLateral
+        };
+        std::memcpy(out, values, sizeof(values));
+        out += SAMPLE_STRIDE;
+    }
+
+    napi_create_typedarray(env, napi_float64_array, count, buffer, 0, &array);
+    return array;
+}
+
+// ----------------------------------------------------------------------------
+// Async work
+// ----------------------------------------------------------------------------
+
+// Runs on a libuv pool thread: no napi_* calls allowed here
+void executeJob(napi_env, void* data) {
+    TrackJob* job = static_cast<TrackJob*>(data);
+
+    // Each job owns its engine, so concurrent jobs share nothing
+    std::unique_ptr<PhysicsEngine> engine(new PhysicsEngine());
+    engine->setChainLift(job->hasChainLift);
+    engine->setTrack(job->points, job->isLooped);
+
+    switch (job->kind) {
+        case JOB_VALIDATE:
+            job->validation = engine->getValidation();
+            break;
+        case JOB_ANALYZE:
+            job->validation = engine->getValidation();
+            job->stats = engine->getTrackStats();
+            job->stall = engine->predictStall(STATION_SPEED);
+            job->descriptor = engine->getTrackDescriptor();
+            break;
+        case JOB_SIMULATE:
+            job->stats = engine->getTrackStats();
+            job->samples = engine->recordRide(job->rateHz);
+            break;
+        case JOB_DESCRIBE:
+            job->descriptor = engine->getTrackDescriptor();
+            break;
+        case JOB_ROBUSTNESS:
+            // Fans out over its own threads; this pool thread runs a share
+            job->robustness = engine->simulateRobustness(job->robustnessOptions);
+            break;
+    }
+}
+
+// Back on the JS thread: build the result and settle the promise
+void completeJob(napi_env env, napi_status status, void* data) {
+    std::unique_ptr<TrackJob> job(static_cast<TrackJob*>(data));
+
+    if (status != napi_ok) {
+        napi_value message, error;
+        napi_create_string_utf8(env, "track job was cancelled", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    } else {
+        napi_value result = nullptr;
+        switch (job->kind) {
+            case JOB_VALIDATE:
+                result = toJs(env, job->validation);
+                break;
+            case JOB_ANALYZE:
+                napi_create_object(env, &result);
+                napi_set_named_property(env, result, "stats", toJs(env, job->stats));
+                napi_set_named_property(env, result, "validation", toJs(env, job->validation));
+                napi_set_named_property(env, result, "stall", toJs(env, job->stall));
+                napi_set_named_property(env, result, "descriptor", toJs(env, job->descriptor));
+                break;
+            case JOB_SIMULATE:
+                napi_create_object(env, &result);
+                setNumber(env, result, "rideTime", job->stats.rideTime);
+                setBool(env, result, "completed", job->stats.rideCompleted);
+                napi_set_named_property(env, result, "samples", toJs(env, job->samples));
+                break;
+            case JOB_DESCRIBE:
+                result = toJs(env, job->descriptor);
+                break;
+            case JOB_ROBUSTNESS:
+                result = toJs(env, job->robustness);
+                break;
+        }
+        napi_resolve_deferred(env, job->deferred, result);
+    }
+
+    napi_delete_async_work(env, job->work);
+}
+
+// Shared entry point: (points, isLooped, hasChainLift[, rateHz | options]) -> Promise
+napi_value queueJob(napi_env env, napi_callback_info info, JobKind kind) {
+    size_t argc = 4;
+    napi_value argv[4];
+    NAPI_CHECK(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+    if (argc < 1) {
+        napi_throw_type_error(env, nullptr, "expected (points, isLooped, hasChainLift)");
+        return nullptr;
+    }
+
+    std::unique_ptr<TrackJob> job(new TrackJob());
+    job->kind = kind;
+    if (const char* error = readTrackPoints(env, argv[0], job->points)) {
+        napi_throw_type_error(env, nullptr, error);
+        return nullptr;
+    }
+    if (argc > 1) job->isLooped = readBool(env, argv[1], false);
+    if (argc > 2) job->hasChainLift = readBool(env, argv[2], false);
+    if (kind == JOB_ROBUSTNESS) {
+        if (argc > 3) readRobustnessOptions(env, argv[3], job->robustnessOptions);
+    } else if (argc > 3 && napi_get_value_double(env, argv[3], &job->rateHz) == napi_ok) {
+        if (!std::isfinite(job->rateHz)) job->rateHz = 60.0;
+        job->rateHz = std::max(1.0, std::min(MAX_SAMPLE_RATE, job->rateHz));
+    }
+
+    napi_value promise, name;
+    NAPI_CHECK(env, napi_create_promise(env, &job->deferred, &promise));
+    NAPI_CHECK(env, napi_create_string_utf8(env, "physicsTrackJob", NAPI_AUTO_LENGTH, &name));
+    NAPI_CHECK(env, napi_create_async_work(env, nullptr, name, executeJob, completeJob, job.get(), &job->work));
+    NAPI_CHECK(env, napi_queue_async_work(env, job->work));
+
+    job.release();  // owned by completeJob now
+    return promise;
+}
+
+// The quantized track as TrackFingerprint keys it: cheap enough to build on
+// the JS thread, which lets the server hash it and check its cache before
+// queueing any work
+napi_value canonicalTrack(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    NAPI_CHECK(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+    if (argc < 1) {
+        napi_throw_type_error(env, nullptr, "expected (points, isLooped, hasChainLift)");
+        return nullptr;
+    }
+
+    std::vector<TrackPointData> points;
+    if (const char* error = readTrackPoints(env, argv[0], points)) {
+        napi_throw_type_error(env, nullptr, error);
+        return nullptr;
+    }
+    bool isLooped = argc > 1 && readBool(env, argv[1], false);
+    bool hasChainLift = argc > 2 && readBool(env, argv[2], false);
+
+    std::string bytes = TrackFingerprint::canonical(points, isLooped, hasChainLift);
+    napi_value result;
+    NAPI_CHECK(env, napi_create_buffer_copy(env, bytes.size(), bytes.data(), nullptr, &result));
+    return result;
+}
+
+napi_value validateTrack(napi_env env, napi_callback_info info) { return queueJob(env, info, JOB_VALIDATE); }
+napi_value analyzeTrack(napi_env env, napi_callback_info info) { return queueJob(env, info, JOB_ANALYZE); }
+napi_value simulateRide(napi_env env, napi_callback_info info) { return queueJob(env, info, JOB_SIMULATE); }
+napi_value describeTrack(napi_env env, napi_callback_info info) { return queueJob(env, info, JOB_DESCRIBE); }
+napi_value simulateRobustness(napi_env env, napi_callback_info info) { return queueJob(env, info, JOB_ROBUSTNESS); }
+
+// ----------------------------------------------------------------------------
+// SimilarityIndex
+// ----------------------------------------------------------------------------
+
+// Queries are a scan of a few MB at most, so they run right on the JS
+// thread; handing them to the pool would cost more than the scan
+
+// Unwraps `this`; reads up to argc arguments into argv
+SimilarityIndex* unwrapIndex(napi_env env, napi_callback_info info, size_t& argc, napi_value* argv) {
+    napi_value self;
+    void* data = nullptr;
+    if (napi_get_cb_info(env, info, &argc, argv, &self, nullptr) != napi_ok ||
+        napi_unwrap(env, self, &data) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "expected a SimilarityIndex");
+        return nullptr;
+    }
+    return static_cast<SimilarityIndex*>(data);
+}
+
+// Unwraps `this` and reads the id in the first argument
+SimilarityIndex* unwrapIndexWithId(napi_env env, napi_callback_info info, size_t& argc,
+                                   napi_value* argv, std::string& id) {
+    SimilarityIndex* index = unwrapIndex(env, info, argc, argv);
+    if (!index) return nullptr;
+    if (argc < 1 || !readString(env, argv[0], id)) {
+        napi_throw_type_error(env, nullptr, "id must be a string");
+        return nullptr;
+    }
+    return index;
+}
+
+napi_value indexConstructor(napi_env env, napi_callback_info info) {
+    napi_value self;
+    NAPI_CHECK(env, napi_get_cb_info(env, info, nullptr, nullptr, &self, nullptr));
+
+    std::unique_ptr<SimilarityIndex> index(new SimilarityIndex());
+    NAPI_CHECK(env, napi_wrap(env, self, index.get(), [](napi_env, void* data, void*) {
+        delete static_cast<SimilarityIndex*>(data);
+    }, nullptr, nullptr));
+    index.release();  // owned by the JS object now
+    return self;
+}
+
+napi_value indexAdd(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    std::string id;
+    SimilarityIndex* index = unwrapIndexWithId(env, info, argc, argv, id);
+    if (!index) return nullptr;
+
+    std::vector<float> descriptor;
+    if (argc < 2 || !readDescriptor(env, argv[1], descriptor)) {
+        napi_throw_type_error(env, nullptr, "descriptor must be a Float32Array of DESCRIPTOR_LENGTH");
+        return nullptr;
+    }
+    napi_value result;
+    NAPI_CHECK(env, napi_get_boolean(env, index->add(id, descriptor), &result));
+    return result;
+}
+
+napi_value indexRemove(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    std::string id;
+    SimilarityIndex* index = unwrapIndexWithId(env, info, argc, argv, id);
+    if (!index) return nullptr;
+
+    napi_value result;
+    NAPI_CHECK(env, napi_get_boolean(env, index->remove(id), &result));
+    return result;
+}
+
+napi_value indexHas(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    std::string id;
+    SimilarityIndex* index = unwrapIndexWithId(env, info, argc, argv, id);
+    if (!index) return nullptr;
+
+    napi_value result;
+    NAPI_CHECK(env, napi_get_boolean(env, index->contains(id), &result));
+    return result;
+}
+
+napi_value indexGet(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    std::string id;
+    SimilarityIndex* index = unwrapIndexWithId(env, info, argc, argv, id);
+    if (!index) return nullptr;
+
+    if (!index->contains(id)) {
+        napi_value result;
+        NAPI_CHECK(env, napi_get_null(env, &result));
+        return result;
+    }
+    return toJs(env, index->get(id));
+}
+
+napi_value indexSize(napi_env env, napi_callback_info info) {
+    size_t argc = 0;
+    SimilarityIndex* index = unwrapIndex(env, info, argc, nullptr);
+    if (!index) return nullptr;
+
+    napi_value result;
+    NAPI_CHECK(env, napi_create_uint32(env, static_cast<uint32_t>(index->size()), &result));
+    return result;
+}
+
+// (descriptor, k, excludeId?) -> { id, distance }[], closest first
+napi_value indexQuery(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    SimilarityIndex* index = unwrapIndex(env, info, argc, argv);
+    if (!index) return nullptr;
+
+    std::vector<float> descriptor;
+    if (argc < 1 || !readDescriptor(env, argv[0], descriptor)) {
+        napi_throw_type_error(env, nullptr, "descriptor must be a Float32Array of DESCRIPTOR_LENGTH");
+        return nullptr;
+    }
+    int32_t k = 10;
+    if (argc > 1) napi_get_value_int32(env, argv[1], &k);
+    std::string exclude;
+    if (argc > 2) readString(env, argv[2], exclude);
+
+    return toJs(env, index->query(descriptor, k, exclude));
+}
+
+} // namespace
+
+NAPI_MODULE_INIT() {
+    napi_value stride, descriptorLength, duplicateDistance;
+    napi_create_uint32(env, SAMPLE_STRIDE, &stride);
+    napi_create_uint32(env, TrackDescriptor::DIMENSIONS, &descriptorLength);
+    napi_create_double(env, SimilarityIndex::DUPLICATE_DISTANCE, &duplicateDistance);
+
+    napi_property_descriptor indexMethods[] = {
+        { "add", nullptr, indexAdd, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "remove", nullptr, indexRemove, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "has", nullptr, indexHas, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "get", nullptr, indexGet, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "size", nullptr, indexSize, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "query", nullptr, indexQuery, nullptr, nullptr, nullptr, napi_default, nullptr },
+    };
+    napi_value indexClass;
+    napi_define_class(env, "SimilarityIndex", NAPI_AUTO_LENGTH, indexConstructor, nullptr,
+                      sizeof(indexMethods) / sizeof(indexMethods[0]), indexMethods, &indexClass);
+
+    napi_property_descriptor properties[] = {
+        { "validateTrack", nullptr, validateTrack, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "analyzeTrack", nullptr, analyzeTrack, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "simulateRide", nullptr, simulateRide, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "describeTrack", nullptr, describeTrack, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "simulateRobustness", nullptr, simulateRobustness, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "canonicalTrack", nullptr, canonicalTrack, nullptr, nullptr, nullptr, napi_enumerable, nullptr },
+        { "SimilarityIndex", nullptr, nullptr, nullptr, nullptr, indexClass, napi_enumerable, nullptr },
+        { "SAMPLE_STRIDE", nullptr, nullptr, nullptr, nullptr, stride, napi_enumerable, nullptr },
+        { "DESCRIPTOR_LENGTH", nullptr, nullptr, nullptr, nullptr, descriptorLength, napi_enumerable, nullptr },
+        { "DUPLICATE_DISTANCE", nullptr, nullptr, nullptr, nullptr, duplicateDistance, napi_enumerable, nullptr },
+    };
+    napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties);
+    return exports;
+}
@@ -1,6 +1,7 @@
 /**
  * Roller Coaster Physics Engine - C++ Core
- * Compiled to WebAssembly via Emscripten
+ * Compiled to WebAssembly via Emscripten, or natively (no Emscripten
+ * headers needed) for the Node-API addon in node_addon.cpp
  * 
  * Provides high-performance physics calculations for:
  * - Track spline interpolation (Catmull-Rom)
@@ -9,15 +10,39 @@
  * - Track validation and analysis
  */
 
+#ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
 #include <emscripten/bind.h>
+#endif
 #include <cmath>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <limits>
+#include <unordered_map>
 
+// Background track builds need real threads: native builds always have
+// them, Emscripten builds only when compiled with -pthread.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PHYSICS_HAS_THREADS 1
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#else
+#define PHYSICS_HAS_THREADS 0
+#endif
+
+#ifdef __EMSCRIPTEN__
 using namespace emscripten;
+#endif
 
 // ============================================================================
 // Vector3 Class
@@ -137,11 +162,24 @@ private:
 public:
     CatmullRomSpline() : totalLength(0), isLooped(false), tension(0.5) {}
     
-    void setPoints(const std::vector<Vec3>& pts, bool looped, double t = 0.5) {
+    void setPoints(const std::vector<Vec3>& pts, bool looped, double t = 0.5,
+                   bool computeLengths = true) {
         points = pts;
         isLooped = looped;
         tension = t;
-        computeArcLengths();
+        if (computeLengths) {
+            computeArcLengths();
+        } else {
+            arcLengths.clear();
+            totalLength = 0;
+        }
+    }
+    
+    // Adopt an arc-length table computed elsewhere (e.g. incrementally by
+    // TrackModelBuilder) instead of running computeArcLengths() here.
+    void setArcLengths(std::vector<double> lengths) {
+        arcLengths = std::move(lengths);
+        totalLength = arcLengths.empty() ? 0 : arcLengths.back();
     }
     
     void computeArcLengths() {
@@ -179,8 +217,11 @@ public:
         if (isLooped) {
             i = ((i % n) + n) % n;
         } else {
-            i = std::max(0, std::min(i, segments - 1));
-            if (i == segments - 1) frac = 1.0;
+            if (i >= segments) {
+                i = segments - 1;
+                frac = 1.0;
+            }
+            i = std::max(0, i);
         }
         
         // Get the 4 control points for Catmull-Rom
@@ -260,297 +301,42 @@ public:
 // ============================================================================
 
 constexpr double GRAVITY = 9.81;           // m/s²
-constexpr double AIR_RESISTANCE = 0.02;    // drag coefficient
+constexpr double AIR_RESISTANCE = 8e-4;    // 1/m, drag per unit mass (see below)
 constexpr double ROLLING_FRICTION = 0.015; // friction coefficient
 constexpr double CHAIN_LIFT_SPEED = 3.0;   // m/s constant chain lift speed
+constexpr double STATION_SPEED = 1.0;      // m/s the train leaves the station at
 constexpr double MAX_SAFE_G_FORCE = 5.0;   // G's
 constexpr double MIN_SAFE_G_FORCE = -1.5;  // G's (negative = ejector airtime)
 constexpr double COMFORT_G_LATERAL = 1.5;  // G's
 
-// ============================================================================
-// Physics Engine
-// ============================================================================
+// Drag decelerates the train by AIR_RESISTANCE·v², i.e. ρ·Cd·A / 2m:
+// 1.2 kg/m³ air, Cd 1.0, 4 m² frontal area and a 3000 kg train. A train
+// then loses about 0.08 m/s² at 10 m/s, and only a very long 45° drop
+// approaches its terminal speed of about 90 m/s.
 
-class PhysicsEngine {
-private:
-    CatmullRomSpline spline;
-    std::vector<TrackPointData> trackPoints;
-    PhysicsState state;
-    
-    double simulationTime;
-    double deltaTime;
-    bool hasChainLift;
-    double firstPeakProgress;
-    
-    // Force history for smoothing
-    std::vector<double> gForceHistory;
-    int gForceHistorySize = 10;
-    
-public:
-    PhysicsEngine() : simulationTime(0), deltaTime(1.0/60.0), 
-                      hasChainLift(false), firstPeakProgress(0.2) {
-        reset();
-    }
-    
-    void setTrack(const std::vector<TrackPointData>& points, bool isLooped) {
-        trackPoints = points;
-        
-        std::vector<Vec3> positions;
-        for (const auto& p : points) {
-            positions.push_back(p.position);
-        }
-        
-        spline.setPoints(positions, isLooped, 0.5);
-        
-        // Find first peak for chain lift
-        findFirstPeak();
-        
-        reset();
-    }
-    
-    void findFirstPeak() {
-        if (trackPoints.size() < 3) {
-            firstPeakProgress = 0.2;
-            return;
-        }
-        
-        double maxHeight = trackPoints[0].position.y;
-        int peakIndex = 0;
-        
-        for (size_t i = 1; i < trackPoints.size(); i++) {
-            if (trackPoints[i].position.y > maxHeight) {
-                maxHeight = trackPoints[i].position.y;
-                peakIndex = i;
-            }
-        }
-        
-        int segments = spline.getIsLooped() ? trackPoints.size() : trackPoints.size() - 1;
-        firstPeakProgress = static_cast<double>(peakIndex) / segments;
-        firstPeakProgress = std::min(0.5, std::max(0.1, firstPeakProgress));
-    }
-    
-    void setChainLift(bool enabled) {
-        hasChainLift = enabled;
-    }
-    
-    void reset() {
-        state.position = spline.getPointRaw(0);
-        state.velocity = Vec3(0, 0, 0);
-        state.acceleration = Vec3(0, 0, 0);
-        state.speed = 1.0;  // Start with minimal speed
-        state.gForceVertical = 1.0;
-        state.gForceLateral = 0.0;
-        state.gForceTotal = 1.0;
-        state.progress = 0;
-        state.height = state.position.y;
-        state.isOnChainLift = hasChainLift;
-        state.isInLoop = false;
-        state.bankAngle = 0;
-        
-        simulationTime = 0;
-        gForceHistory.clear();
-    }
-    
-    PhysicsState step(double dt) {
-        if (trackPoints.size() < 2) return state;
-        
-        deltaTime = dt;
-        simulationTime += dt;
-        
-        // Get track sample at current position
-        TrackSample sample = sampleTrack(state.progress);
-        
-        // Calculate physics forces
-        Vec3 gravity(0, -GRAVITY, 0);
-        
-        // Project gravity onto track direction
-        double gravityAlongTrack = gravity.dot(sample.tangent);
-        
-        // Check if on chain lift section
-        state.isOnChainLift = hasChainLift && state.progress < firstPeakProgress;
-        
-        // Calculate speed
-        if (state.isOnChainLift) {
-            // Chain lift: constant speed upward
-            state.speed = CHAIN_LIFT_SPEED;
-        } else {
-            // Physics-based speed calculation
-            double dragForce = AIR_RESISTANCE * state.speed * state.speed;
-            double frictionForce = ROLLING_FRICTION * GRAVITY;
-            
-            double netAcceleration = -gravityAlongTrack - dragForce - frictionForce;
-            
-            state.speed += netAcceleration * dt;
-            state.speed = std::max(0.5, state.speed);  // Minimum speed
-        }
-        
-        // Calculate G-forces
-        calculateGForces(sample, dt);
-        
-        // Update position along track
-        double distanceTraveled = state.speed * dt;
-        double trackLength = spline.getTotalLength();
-        
-        if (trackLength > 0) {
-            state.progress += distanceTraveled / trackLength;
-            
-            // Handle looping or stopping
-            if (spline.getIsLooped()) {
-                while (state.progress >= 1.0) state.progress -= 1.0;
-                while (state.progress < 0) state.progress += 1.0;
-            } else {
-                if (state.progress >= 1.0) {
-                    state.progress = 0;  // Restart
-                    reset();
-                }
-            }
-        }
-        
-        // Update state position and vectors
-        sample = sampleTrack(state.progress);
-        state.position = sample.point;
-        state.velocity = sample.tangent * state.speed;
-        state.height = sample.point.y;
-        state.bankAngle = sample.tilt;
-        state.isInLoop = sample.inLoop;
-        
-        return state;
-    }
-    
-    void calculateGForces(const TrackSample& sample, double dt) {
-        // Centripetal acceleration (v²/r)
-        double centripetalAccel = 0;
-        if (sample.curvature > 1e-6) {
-            double radius = 1.0 / sample.curvature;
-            centripetalAccel = (state.speed * state.speed) / radius;
-        }
-        
-        // Vertical G-force: normal force needed to keep on track
-        // G = 1 + (centripetal_accel_vertical_component / g)
-        double gradeRad = std::atan(sample.grade / 100.0);
-        double vertComponent = std::cos(gradeRad) * centripetalAccel;
-        
-        state.gForceVertical = 1.0 + vertComponent / GRAVITY;
-        
-        // Add effect of going up/down hills
-        state.gForceVertical += std::sin(gradeRad) * (state.speed * state.speed) / (GRAVITY * 10);
-        
-        // Lateral G-force from banking
-        state.gForceLateral = std::sin(sample.tilt) * centripetalAccel / GRAVITY;
-        
-        // Total G-force magnitude
-        state.gForceTotal = std::sqrt(
-            state.gForceVertical * state.gForceVertical + 
-            state.gForceLateral * state.gForceLateral
-        );
-        
-        // Smooth G-forces
-        gForceHistory.push_back(state.gForceTotal);
-        if (gForceHistory.size() > gForceHistorySize) {
-            gForceHistory.erase(gForceHistory.begin());
-        }
-        
-        double smoothedG = 0;
-        for (double g : gForceHistory) smoothedG += g;
-        state.gForceTotal = smoothedG / gForceHistory.size();
-    }
-    
-    TrackSample sampleTrack(double progress) {
-        TrackSample sample;
-        
-        progress = std::max(0.0, std::min(0.9999, progress));
-        
-        sample.point = spline.getPointRaw(progress);
-        sample.tangent = spline.getTangent(progress);
-        sample.curvature = spline.getCurvature(progress);
-        
-        // Calculate up vector (perpendicular to tangent, toward world up)
-        Vec3 worldUp(0, 1, 0);
-        Vec3 right = sample.tangent.cross(worldUp).normalized();
-        sample.up = right.cross(sample.tangent).normalized();
-        sample.right = right;
-        
-        // Interpolate tilt from track points
-        sample.tilt = interpolateTilt(progress);
-        
-        // Apply tilt rotation to up/right vectors
-        if (std::abs(sample.tilt) > 0.001) {
-            double c = std::cos(sample.tilt);
-            double s = std::sin(sample.tilt);
-            Vec3 newUp = sample.up * c + sample.right * s;
-            Vec3 newRight = sample.right * c - sample.up * s;
-            sample.up = newUp;
-            sample.right = newRight;
-        }
-        
-        // Calculate grade (slope percentage)
-        sample.grade = sample.tangent.y * 100.0;
-        
-        // Check if in loop
-        sample.inLoop = isInLoopAtProgress(progress);
-        
-        return sample;
-    }
-    
-    double interpolateTilt(double progress) {
-        if (trackPoints.size() < 2) return 0;
-        
-        int n = trackPoints.size();
-        int segments = spline.getIsLooped() ? n : n - 1;
-        
-        double scaledT = progress * segments;
-        int index = static_cast<int>(std::floor(scaledT));
-        double frac = scaledT - index;
-        
-        if (spline.getIsLooped()) {
-            int i0 = ((index % n) + n) % n;
-            int i1 = ((index + 1) % n + n) % n;
-            return trackPoints[i0].tilt * (1.0 - frac) + trackPoints[i1].tilt * frac;
-        } else {
-            if (index >= n - 1) return trackPoints[n - 1].tilt;
-            return trackPoints[index].tilt * (1.0 - frac) + trackPoints[index + 1].tilt * frac;
-        }
-    }
+// Airtime hysteresis band: starts below ENTER, ends only above EXIT, so
+// G noise around a single threshold does not produce a stream of events
+constexpr double AIRTIME_ENTER_G = 0.5;
+constexpr double AIRTIME_EXIT_G = 0.6;
+
+// Bump whenever step() or the model changes behavior: fingerprints and
+// warm-start tables written by older builds then stop matching
+constexpr int64_t PHYSICS_REVISION = 5;
+
+// Operating conditions step() applies on top of the constants above. The
+// defaults are the nominal case that every analysis and fingerprint
+// assumes; MonteCarloRides varies them per sample.
+struct RideConditions {
+    double dragScale = 1.0;      // nominal train mass over actual (drag is per unit mass)
+    double frictionScale = 1.0;  // rolling friction multiplier
+    double windX = 0;            // m/s, horizontal wind the train moves through
+    double windZ = 0;
     
-    bool isInLoopAtProgress(double progress) {
-        // Simplified: check if near a loop point
-        if (trackPoints.empty()) return false;
-        
-        int n = trackPoints.size();
-        int segments = spline.getIsLooped() ? n : n - 1;
-        
-        for (size_t i = 0; i < trackPoints.size(); i++) {
-            if (trackPoints[i].hasLoop) {
-                double loopProgress = static_cast<double>(i) / segments;
-                double loopLength = 0.05;  // Approximate loop length as % of track
-                
-                if (progress >= loopProgress && progress < loopProgress + loopLength) {
-                    return true;
-                }
-            }
-        }
-        
-        return false;
+    bool operator==(const RideConditions& o) const {
+        return dragScale == o.dragScale && frictionScale == o.frictionScale &&
+               windX == o.windX && windZ == o.windZ;
     }
-    
-    // Getters for JS access
-    double getSpeed() const { return state.speed; }
-    double getGForceVertical() const { return state.gForceVertical; }
-    double getGForceLateral() const { return state.gForceLateral; }
-    double getGForceTotal() const { return state.gForceTotal; }
-    double getProgress() const { return state.progress; }
-    double getHeight() const { return state.height; }
-    bool getIsOnChainLift() const { return state.isOnChainLift; }
-    bool getIsInLoop() const { return state.isInLoop; }
-    double getPositionX() const { return state.position.x; }
-    double getPositionY() const { return state.position.y; }
-    double getPositionZ() const { return state.position.z; }
-    double getVelocityX() const { return state.velocity.x; }
-    double getVelocityY() const { return state.velocity.y; }
-    double getVelocityZ() const { return state.velocity.z; }
-    
-    void setProgress(double p) { state.progress = p; }
-    void setSpeed(double s) { state.speed = s; }
+    bool operator!=(const RideConditions& o) const { return !(*this == o); }
 };
 
 // ============================================================================
@@ -589,59 +375,14 @@ public:
         int segments = isLooped ? points.size() : points.size() - 1;
         
         for (int i = 0; i < segments; i++) {
-            double tStart = static_cast<double>(i) / segments;
-            double tEnd = static_cast<double>(i + 1) / segments;
-            
-            // Sample multiple points along segment
-            for (int s = 0; s < 10; s++) {
-                double t = tStart + (tEnd - tStart) * s / 10.0;
-                Vec3 tangent = spline.getTangent(t);
-                
-                // Check grade (steepness)
-                double grade = std::abs(tangent.y) * 100.0;
-                if (grade > 80) {
-                    results.push_back({
-                        false, 
-                        "Extreme grade detected (" + std::to_string(static_cast<int>(grade)) + "%)",
-                        2, i, grade
-                    });
-                } else if (grade > 60) {
-                    results.push_back({
-                        false,
-                        "Steep grade (" + std::to_string(static_cast<int>(grade)) + "%)",
-                        1, i, grade
-                    });
-                }
-                
-                // Check curvature (tight turns)
-                double curvature = spline.getCurvature(t);
-                if (curvature > 0.5) {  // radius < 2m
-                    results.push_back({
-                        false,
-                        "Turn radius too tight",
-                        2, i, 1.0 / curvature
-                    });
-                } else if (curvature > 0.25) {  // radius < 4m
-                    results.push_back({
-                        false,
-                        "Sharp turn detected",
-                        1, i, 1.0 / curvature
-                    });
-                }
-            }
-            
-            // Check point height
-            if (points[i].position.y < 0.5) {
-                results.push_back({
-                    false,
-                    "Point too low (underground risk)",
-                    1, i, points[i].position.y
-                });
-            }
+            validateSegment(spline, points, i, segments, results);
         }
         
         // Check for self-intersection (simplified)
-        checkSelfIntersection(spline, results, segments);
+        std::vector<Vec3> samples = sampleForIntersection(spline, segments);
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (checkSelfIntersectionRow(samples, i, segments, results)) break;
+        }
         
         if (results.empty()) {
             results.push_back({true, "Track validation passed", 0, -1, 0});
@@ -650,39 +391,4987 @@ public:
         return results;
     }
     
-private:
-    static void checkSelfIntersection(
-        CatmullRomSpline& spline,
-        std::vector<ValidationResult>& results,
-        int segments
+    // The pieces below are also driven incrementally by TrackModelBuilder,
+    // so a sliced build reports exactly what validate() reports.
+    
+    static void validateSegment(
+        const CatmullRomSpline& spline,
+        const std::vector<TrackPointData>& points,
+        int i,
+        int segments,
+        std::vector<ValidationResult>& results
     ) {
-        // Sample track at regular intervals
-        std::vector<Vec3> samples;
-        int numSamples = segments * 5;
-        
-        for (int i = 0; i < numSamples; i++) {
-            double t = static_cast<double>(i) / numSamples;
-            samples.push_back(spline.getPointRaw(t));
-        }
-        
-        // Check for close points that aren't adjacent
-        double minDistance = 2.0;  // meters
+        double tStart = static_cast<double>(i) / segments;
+        double tEnd = static_cast<double>(i + 1) / segments;
         
-        for (size_t i = 0; i < samples.size(); i++) {
-            for (size_t j = i + 5; j < samples.size(); j++) {
-                double dist = samples[i].distanceTo(samples[j]);
-                if (dist < minDistance) {
-                    results.push_back({
-                        false,
-                        "Possible self-intersection detected",
-                        1, 
-                        static_cast<int>(i * segments / numSamples),
-                        dist
-                    });
-                    return;  // Only report first intersection
-                }
-            }
-        }
+        // Sample multiple points along segment
+        for (int s = 0; s < 10; s++) {
+            double t = tStart + (tEnd - tStart) * s / 10.0;
+            Vec3 tangent = spline.getTangent(t);
+            
+            // Check grade (steepness)
+            double grade = std::abs(tangent.y) * 100.0;
+            if (grade > 80) {
+                results.push_back({
+                    false, 
+                    "Extreme grade detected (" + std::to_string(static_cast<int>(grade)) + "%)",
+                    2, i, grade
+                });
+            } else if (grade > 60) {
+                results.push_back({
+                    false,
+                    "Steep grade (" + std::to_string(static_cast<int>(grade)) + "%)",
+                    1, i, grade
+                });
+            }
+            
+            // Check curvature (tight turns)
+            double curvature = spline.getCurvature(t);
+            if (curvature > 0.5) {  // radius < 2m
+                results.push_back({
+                    false,
+                    "Turn radius too tight",
+                    2, i, 1.0 / curvature
+                });
+            } else if (curvature > 0.25) {  // radius < 4m
+                results.push_back({
+                    false,
+                    "Sharp turn detected",
+                    1, i, 1.0 / curvature
+                });
+            }
+        }
+        
+        // Check point height
+        if (points[i].position.y < 0.5) {
+            results.push_back({
+                false,
+                "Point too low (underground risk)",
+                1, i, points[i].position.y
+            });
+        }
+    }
+    
+    static std::vector<Vec3> sampleForIntersection(
+        const CatmullRomSpline& spline,
+        int segments
+    ) {
+        // Sample track at regular intervals
+        std::vector<Vec3> samples;
+        int numSamples = segments * 5;
+        
+        for (int i = 0; i < numSamples; i++) {
+            double t = static_cast<double>(i) / numSamples;
+            samples.push_back(spline.getPointRaw(t));
+        }
+        
+        return samples;
+    }
+    
+    // Checks sample i against every non-adjacent later sample.
+    // Returns true once an intersection has been reported.
+    static bool checkSelfIntersectionRow(
+        const std::vector<Vec3>& samples,
+        size_t i,
+        int segments,
+        std::vector<ValidationResult>& results
+    ) {
+        // Check for close points that aren't adjacent
+        double minDistance = 2.0;  // meters
+        size_t numSamples = samples.size();
+        
+        for (size_t j = i + 5; j < numSamples; j++) {
+            double dist = samples[i].distanceTo(samples[j]);
+            if (dist < minDistance) {
+                results.push_back({
+                    false,
+                    "Possible self-intersection detected",
+                    1, 
+                    static_cast<int>(i * segments / numSamples),
+                    dist
+                });
+                return true;  // Only report first intersection
+            }
+        }
+        
+        return false;
+    }
+};
+
+// ============================================================================
+// Track Model
+// ============================================================================
+
+/**
+ * Which fixed-size chunks of a derived table have been built. Tables that
+ * grow with track length are filled a chunk at a time on first access, so
+ * opening a long track and riding it only pays for the stretch the train
+ * and camera reach. Lives inside a shared TrackModel, so the memo is per
+ * track version, and each chunk is built exactly once under concurrent
+ * readers.
+ */
+class LazyChunks {
+public:
+    static constexpr size_t CHUNK_SIZE = 256;  // table entries per chunk
+    
+    void reset(size_t entries) {
+        count = (entries + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        ready.reset(new std::atomic<uint8_t>[count]);
+        for (size_t c = 0; c < count; c++) ready[c].store(0, std::memory_order_relaxed);
+    }
+    
+    void markAllBuilt() {
+        for (size_t c = 0; c < count; c++) ready[c].store(1, std::memory_order_release);
+    }
+    
+    size_t chunkCount() const { return count; }
+    
+    size_t builtCount() const {
+        size_t built = 0;
+        for (size_t c = 0; c < count; c++) built += ready[c].load(std::memory_order_acquire);
+        return built;
+    }
+    
+    // Runs fill(begin, end) once for each unbuilt chunk overlapping entries
+    // [first, last]; end may run past the table
+    template <typename Fill>
+    void ensure(size_t first, size_t last, Fill&& fill) const {
+        for (size_t c = first / CHUNK_SIZE; c <= last / CHUNK_SIZE && c < count; c++) {
+            if (ready[c].load(std::memory_order_acquire)) continue;
+#if PHYSICS_HAS_THREADS
+            std::lock_guard<std::mutex> lock(buildLock);
+            if (ready[c].load(std::memory_order_relaxed)) continue;
+#endif
+            fill(c * CHUNK_SIZE, (c + 1) * CHUNK_SIZE);
+            ready[c].store(1, std::memory_order_release);
+        }
+    }
+    
+private:
+    size_t count = 0;
+    std::unique_ptr<std::atomic<uint8_t>[]> ready;
+#if PHYSICS_HAS_THREADS
+    mutable std::mutex buildLock;
+#endif
+};
+
+// Precomputed frame at one entry of the arc-length table
+struct TrackFrame {
+    Vec3 point;
+    Vec3 tangent;
+    double curvature;  // 1/radius
+    double tilt;       // radians
+    double arcLength;  // meters from start
+};
+
+// What a stretch of spline is, as recognized by ElementRecognizer
+enum TrackFeatureKind {
+    FEATURE_STRAIGHT = 0,
+    FEATURE_CURVE = 1,         // bends that are none of the below
+    FEATURE_DROP = 2,
+    FEATURE_AIRTIME_HILL = 3,
+    FEATURE_TURN = 4,
+    FEATURE_HELIX = 5,
+    FEATURE_INVERSION = 6
+};
+
+struct TrackFeature {
+    int kind;               // TrackFeatureKind
+    double startProgress;
+    double endProgress;
+    double startDistance;   // meters along the spline
+    double endDistance;
+    double heightChange;    // meters, end minus start
+    double turnAngle;       // radians of heading change, signed
+    double maxCurvature;    // 1/m
+    double maxTorsion;      // 1/m, magnitude
+    double maxBank;         // radians, magnitude
+    double minVerticalG;    // estimated for a frictionless train
+};
+
+// Immutable snapshot of everything derived from one set of track points.
+// Built once per edit (possibly off-thread) and then only ever read, so the
+// engine and any number of readers can share it without locking.
+struct TrackModel {
+    uint32_t version = 0;
+    std::vector<TrackPointData> points;
+    CatmullRomSpline spline;
+    bool isLooped = false;
+    int segments = 0;
+    int samplesPerSegment = 50;
+    
+    // Uniform in spline parameter: frames[i] is at t = i / (frames.size() - 1).
+    // Curvature is filled per chunk on first use; read it through frame(),
+    // frameAt() or after ensureFrames().
+    std::vector<TrackFrame> frames;
+    LazyChunks lazyFrames;
+    
+    // Recognized elements in track order, and the [start, end) progress
+    // intervals among them that isInLoop() reports
+    std::vector<TrackFeature> features;
+    std::vector<std::pair<double, double>> loopZones;
+    
+    std::vector<ValidationResult> validation;
+    double totalLength = 0;
+    double firstPeakProgress = 0.2;
+    
+    void ensureFrames(size_t first, size_t last) const {
+        lazyFrames.ensure(first, last, [this](size_t begin, size_t end) {
+            // Only this fill writes into frames after the build; the model
+            // itself was never created const
+            TrackFrame* data = const_cast<TrackFrame*>(frames.data());
+            double span = static_cast<double>(std::max<size_t>(1, frames.size() - 1));
+            for (size_t i = begin; i < std::min(end, frames.size()); i++) {
+                data[i].curvature = spline.getCurvature(i / span);
+            }
+        });
+    }
+    
+    const TrackFrame& frame(size_t i) const {
+        ensureFrames(i, i);
+        return frames[i];
+    }
+    
+    TrackFrame frameAt(double progress) const {
+        if (frames.empty()) return TrackFrame{Vec3(), Vec3(0, 0, 1), 0, 0, 0};
+        if (frames.size() == 1) return frame(0);
+        
+        double scaled = std::max(0.0, std::min(1.0, progress)) * (frames.size() - 1);
+        size_t i = std::min(static_cast<size_t>(scaled), frames.size() - 2);
+        double frac = scaled - i;
+        ensureFrames(i, i + 1);
+        
+        const TrackFrame& a = frames[i];
+        const TrackFrame& b = frames[i + 1];
+        
+        TrackFrame f;
+        f.point = a.point.lerp(b.point, frac);
+        f.tangent = a.tangent.lerp(b.tangent, frac).normalized();
+        f.curvature = a.curvature + (b.curvature - a.curvature) * frac;
+        f.tilt = a.tilt + (b.tilt - a.tilt) * frac;
+        f.arcLength = a.arcLength + (b.arcLength - a.arcLength) * frac;
+        return f;
+    }
+    
+    bool isInLoop(double progress) const {
+        for (const auto& zone : loopZones) {
+            if (progress >= zone.first && progress < zone.second) return true;
+        }
+        return false;
+    }
+};
+
+// ============================================================================
+// Element Recognition
+// ============================================================================
+
+// Arc length of an inline loop/roll element. Same eased helix as
+// computeRollArcLength() in client/src/lib/trackUtils.ts.
+inline double elementArcLength(double radius, double pitch) {
+    const int steps = 100;
+    const double twoPi = 2.0 * M_PI;
+    double length = 0;
+    
+    for (int i = 0; i < steps; i++) {
+        double t1 = static_cast<double>(i) / steps;
+        double t2 = static_cast<double>(i + 1) / steps;
+        
+        double theta1 = twoPi * (t1 - std::sin(twoPi * t1) / twoPi);
+        double theta2 = twoPi * (t2 - std::sin(twoPi * t2) / twoPi);
+        
+        double dForward = pitch / steps;
+        double dRadial = radius * std::abs(theta2 - theta1);
+        length += std::sqrt(dForward * dForward + dRadial * dRadial);
+    }
+    
+    return length;
+}
+
+/**
+ * Walks an inline loop element in `steps` pieces, laid out as
+ * sampleVerticalLoopAnalytically() in client/src/lib/trackUtils.ts does:
+ * r·sinθ + 0.3·pitch·u along the entry tangent and r·(1 − cosθ) up, in
+ * the plane of the tangent and world up. visit(rise, ds) gets each
+ * piece's height change and length (the length elementArcLength() sums).
+ */
+template <typename Visit>
+inline void walkElement(double radius, double pitch, const Vec3& entryTangent, Visit visit) {
+    const int steps = 100;
+    const double twoPi = 2.0 * M_PI;
+    double forwardY = std::max(-1.0, std::min(1.0, entryTangent.y));
+    double upY = std::sqrt(1.0 - forwardY * forwardY);
+    double previousHeight = 0;
+    double previousTheta = 0;
+    
+    for (int i = 1; i <= steps; i++) {
+        double u = static_cast<double>(i) / steps;
+        double theta = twoPi * (u - std::sin(twoPi * u) / twoPi);
+        double height = forwardY * (radius * std::sin(theta) + 0.3 * pitch * u) +
+                        upY * radius * (1.0 - std::cos(theta));
+        
+        double dForward = pitch / steps;
+        double dRadial = radius * std::abs(theta - previousTheta);
+        visit(height - previousHeight, std::sqrt(dForward * dForward + dRadial * dRadial));
+        previousHeight = height;
+        previousTheta = theta;
+    }
+}
+
+/**
+ * Labels the spline as a sequence of elements in one pass over the frame
+ * table. Each frame gets derivatives from its neighbors' tangents: total,
+ * vertical and heading curvature, and torsion ((T x T') . T'' / |T'|^2). It
+ * also gets a vertical G estimate at the speed a frictionless train would
+ * have after the highest point so far. Each frame gets the first label
+ * that applies:
+ *
+ *   inversion      inside a sustained stretch of invertedFrames()
+ *   airtime hill   estimated vertical G below AIRTIME_ENTER_G
+ *   drop           steeper than DROP_GRADE downhill
+ *   turn           heading changes faster than 1 / TURN_RADIUS
+ *   straight       curvature below 1 / STRAIGHT_RADIUS
+ *   curve          anything else (valleys, crests without airtime)
+ *
+ * Runs of one label become features. A run shorter than MIN_LENGTH is
+ * absorbed by the one before it, unless either is an inversion or airtime. A
+ * turn whose heading changes by HELIX_TURN or more becomes a helix. Inline
+ * elements (hasLoop points) have no spline extent and are listed by the
+ * caller.
+ */
+class ElementRecognizer {
+public:
+    static constexpr double DROP_GRADE = 0.42;         // sin 25 degrees
+    static constexpr double TURN_RADIUS = 60.0;        // meters
+    static constexpr double STRAIGHT_RADIUS = 150.0;   // meters
+    static constexpr double HELIX_TURN = 1.5 * M_PI;   // radians of heading
+    static constexpr double MIN_LENGTH = 3.0;          // meters
+    static constexpr double MIN_INVERSION_LENGTH = 5.0; // meters upside down to count
+    
+    static std::vector<TrackFeature> segment(const TrackModel& model) {
+        std::vector<TrackFeature> features;
+        const std::vector<TrackFrame>& frames = model.frames;
+        const size_t n = frames.size();
+        if (n < 3 || model.totalLength <= 0) return features;
+        
+        const double toProgress = 1.0 / (n - 1);
+        const std::vector<bool> inverted = invertedFrames(frames);
+        double highest = frames[0].point.y;
+        TrackFeature run = {};
+        
+        // Heading and pitch of the previous, current and next frame
+        double headingA = heading(frames[0].tangent), headingF = headingA;
+        double pitchA = pitch(frames[0].tangent), pitchF = pitchA;
+        
+        for (size_t i = 0; i < n; i++) {
+            const TrackFrame& f = frames[i];
+            const TrackFrame& a = frames[i > 0 ? i - 1 : 0];
+            const TrackFrame& b = frames[std::min(i + 1, n - 1)];
+            double headingB = i + 1 < n ? heading(b.tangent) : headingF;
+            double pitchB = i + 1 < n ? pitch(b.tangent) : pitchF;
+            double ds = b.arcLength - a.arcLength;
+            
+            double curvature = 0, torsion = 0, verticalCurvature = 0, turnRate = 0;
+            if (ds > 1e-9) {
+                Vec3 dT = (b.tangent - a.tangent) * (1.0 / ds);
+                curvature = dT.length();
+                if (i > 0 && i + 1 < n && curvature > 1e-4) {
+                    double h = 0.5 * ds;
+                    Vec3 ddT = (b.tangent - f.tangent * 2.0 + a.tangent) * (1.0 / (h * h));
+                    torsion = f.tangent.cross(dT).dot(ddT) / (curvature * curvature);
+                }
+                verticalCurvature = (pitchB - pitchA) / ds;
+                if (std::abs(f.tangent.y) < 0.9) turnRate = wrapAngle(headingB - headingA) / ds;
+            }
+            
+            highest = std::max(highest, f.point.y);
+            double speedSq = CHAIN_LIFT_SPEED * CHAIN_LIFT_SPEED + 2.0 * GRAVITY * (highest - f.point.y);
+            double verticalG = std::sqrt(std::max(0.0, 1.0 - f.tangent.y * f.tangent.y)) +
+                speedSq * verticalCurvature / GRAVITY;
+            
+            int kind;
+            if (inverted[i]) kind = FEATURE_INVERSION;
+            else if (verticalG < AIRTIME_ENTER_G) kind = FEATURE_AIRTIME_HILL;
+            else if (f.tangent.y < -DROP_GRADE) kind = FEATURE_DROP;
+            else if (std::abs(turnRate) > 1.0 / TURN_RADIUS) kind = FEATURE_TURN;
+            else if (curvature < 1.0 / STRAIGHT_RADIUS) kind = FEATURE_STRAIGHT;
+            else kind = FEATURE_CURVE;
+            
+            // Opposite turns are separate features
+            bool turnFlips = kind == FEATURE_TURN && run.kind == FEATURE_TURN &&
+                turnRate * run.turnAngle < 0;
+            if (i == 0 || kind != run.kind || turnFlips) {
+                if (i > 0) close(features, run, f, i * toProgress);
+                run = {};
+                run.kind = kind;
+                run.startProgress = i * toProgress;
+                run.startDistance = f.arcLength;
+                run.heightChange = f.point.y;  // start height until closed
+                run.minVerticalG = verticalG;
+            }
+            
+            run.turnAngle += wrapAngle(headingF - headingA);
+            run.maxCurvature = std::max(run.maxCurvature, curvature);
+            run.maxTorsion = std::max(run.maxTorsion, std::abs(torsion));
+            run.maxBank = std::max(run.maxBank, std::abs(f.tilt));
+            run.minVerticalG = std::min(run.minVerticalG, verticalG);
+            
+            headingA = headingF;
+            headingF = headingB;
+            pitchA = pitchF;
+            pitchF = pitchB;
+        }
+        close(features, run, frames[n - 1], 1.0);
+        return features;
+    }
+    
+    // Loop zones for isInLoop(): inversions on the spline, plus each inline
+    // element from its point for its share of the ride's length
+    static std::vector<std::pair<double, double>> loopZones(const TrackModel& model,
+                                                           const std::vector<TrackFeature>& features) {
+        std::vector<std::pair<double, double>> zones;
+        for (const TrackFeature& feature : features) {
+            if (feature.kind == FEATURE_INVERSION) {
+                zones.push_back({feature.startProgress, feature.endProgress});
+            }
+        }
+        
+        double rideLength = model.totalLength;
+        for (const TrackPointData& p : model.points) {
+            if (p.hasLoop) rideLength += elementArcLength(p.loopRadius, p.loopPitch);
+        }
+        for (size_t i = 0; i < model.points.size(); i++) {
+            const TrackPointData& p = model.points[i];
+            if (!p.hasLoop || model.segments <= 0 || rideLength <= 0) continue;
+            double start = static_cast<double>(i) / model.segments;
+            zones.push_back({start, start + elementArcLength(p.loopRadius, p.loopPitch) / rideLength});
+        }
+        return zones;
+    }
+    
+private:
+    /**
+     * Whether the rider is upside down at each frame, in the frame
+     * sampleTrack() and the renderer build: up is perpendicular to the
+     * tangent toward world up, then rotated by tilt, so only bank past 90
+     * degrees turns it over. Enters below -0.2 and leaves above 0, and
+     * stretches shorter than MIN_INVERSION_LENGTH are cleared.
+     */
+    static std::vector<bool> invertedFrames(const std::vector<TrackFrame>& frames) {
+        const size_t n = frames.size();
+        std::vector<bool> inverted(n, false);
+        bool in = false;
+        for (size_t i = 0; i < n; i++) {
+            const TrackFrame& f = frames[i];
+            // World-up frame: up.y is the tangent's horizontal length and
+            // right is level, so tilt scales it by cos
+            double upY = std::cos(f.tilt) * std::sqrt(std::max(0.0, 1.0 - f.tangent.y * f.tangent.y));
+            if (!in && upY < -0.2) in = true;
+            else if (in && upY > 0.0) in = false;
+            inverted[i] = in;
+        }
+        
+        for (size_t i = 0; i < n;) {
+            if (!inverted[i]) { i++; continue; }
+            size_t end = i;
+            while (end + 1 < n && inverted[end + 1]) end++;
+            if (frames[end].arcLength - frames[i].arcLength < MIN_INVERSION_LENGTH) {
+                std::fill(inverted.begin() + i, inverted.begin() + end + 1, false);
+            }
+            i = end + 1;
+        }
+        return inverted;
+    }
+    
+    static double pitch(const Vec3& tangent) {
+        return std::asin(std::max(-1.0, std::min(1.0, tangent.y)));
+    }
+    
+    static double heading(const Vec3& tangent) { return std::atan2(tangent.x, tangent.z); }
+    
+    static double wrapAngle(double angle) {
+        while (angle > M_PI) angle -= 2.0 * M_PI;
+        while (angle < -M_PI) angle += 2.0 * M_PI;
+        return angle;
+    }
+    
+    // Ends the run at frame `end`; short unprotected runs extend the
+    // previous feature instead, and equal neighbors coalesce
+    static void close(std::vector<TrackFeature>& features, TrackFeature run,
+                      const TrackFrame& end, double endProgress) {
+        run.endProgress = endProgress;
+        run.endDistance = end.arcLength;
+        run.heightChange = end.point.y - run.heightChange;
+        if (run.kind == FEATURE_TURN && std::abs(run.turnAngle) >= HELIX_TURN) run.kind = FEATURE_HELIX;
+        
+        if (!features.empty()) {
+            TrackFeature& prev = features.back();
+            bool turning = run.kind == FEATURE_TURN || run.kind == FEATURE_HELIX;
+            bool continues = prev.kind == run.kind && (!turning || prev.turnAngle * run.turnAngle >= 0);
+            bool absorbed = run.endDistance - run.startDistance < MIN_LENGTH &&
+                !isProtected(run) && !isProtected(prev);
+            if (!continues && !absorbed) {
+                features.push_back(run);
+                return;
+            }
+            
+            prev.endProgress = run.endProgress;
+            prev.endDistance = run.endDistance;
+            prev.heightChange += run.heightChange;
+            prev.turnAngle += run.turnAngle;
+            prev.maxCurvature = std::max(prev.maxCurvature, run.maxCurvature);
+            prev.maxTorsion = std::max(prev.maxTorsion, run.maxTorsion);
+            prev.maxBank = std::max(prev.maxBank, run.maxBank);
+            prev.minVerticalG = std::min(prev.minVerticalG, run.minVerticalG);
+            if (prev.kind == FEATURE_TURN && std::abs(prev.turnAngle) >= HELIX_TURN) prev.kind = FEATURE_HELIX;
+            return;
+        }
+        features.push_back(run);
+    }
+    
+    static bool isProtected(const TrackFeature& feature) {
+        return feature.kind == FEATURE_INVERSION || feature.kind == FEATURE_AIRTIME_HILL;
+    }
+};
+
+// ============================================================================
+// Track Model Builder
+// ============================================================================
+
+/**
+ * Builds a TrackModel in resumable slices. advance() does a bounded amount
+ * of work and returns, so a single-threaded WASM build can spread a large
+ * track over several frames; threaded builds simply run it to completion
+ * on a worker.
+ */
+class TrackModelBuilder {
+private:
+    enum class Stage { Frames, Zones, Validation, IntersectionSamples, Intersection, Done };
+    
+    std::shared_ptr<TrackModel> model;
+    Stage stage;
+    int cursor;
+    std::vector<double> arcLengths;
+    std::vector<Vec3> intersectionSamples;
+    
+public:
+    TrackModelBuilder(const std::vector<TrackPointData>& points, bool isLooped, uint32_t version)
+        : model(std::make_shared<TrackModel>()), stage(Stage::Frames), cursor(0) {
+        model->version = version;
+        model->points = points;
+        model->isLooped = isLooped;
+        
+        if (points.size() < 2) {
+            model->validation.push_back({false, "Need at least 2 points", 2, -1, 0});
+            stage = Stage::Done;
+            return;
+        }
+        
+        std::vector<Vec3> positions;
+        for (const auto& p : points) {
+            positions.push_back(p.position);
+        }
+        model->spline.setPoints(positions, isLooped, 0.5, false);
+        model->segments = isLooped ? points.size() : points.size() - 1;
+        
+        int frameCount = model->segments * model->samplesPerSegment + 1;
+        model->frames.reserve(frameCount);
+        arcLengths.reserve(frameCount);
+    }
+    
+    bool isDone() const { return stage == Stage::Done; }
+    
+    // Performs up to maxUnits units of work. Returns true once complete.
+    bool advance(int maxUnits) {
+        while (maxUnits-- > 0 && stage != Stage::Done) {
+            switch (stage) {
+                case Stage::Frames:       stepFrames(); break;
+                case Stage::Zones:        stepZones(); break;
+#ifndef PHYSICS_RIDE_CORE
+                case Stage::Validation:   stepValidation(); break;
+                case Stage::IntersectionSamples:
+                    intersectionSamples = TrackValidator::sampleForIntersection(
+                        model->spline, model->segments);
+                    stage = Stage::Intersection;
+                    cursor = 0;
+                    break;
+                case Stage::Intersection: stepIntersection(); break;
+#endif
+                default: break;
+            }
+        }
+        return stage == Stage::Done;
+    }
+    
+    // Keeps advancing in small chunks until done or the time budget is spent
+    bool advanceFor(double budgetMs) {
+        auto start = std::chrono::steady_clock::now();
+        while (!advance(64)) {
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budgetMs) return false;
+        }
+        return true;
+    }
+    
+    void runToCompletion() {
+        while (!advance(1024)) {}
+    }
+    
+    // Hands over the finished model; the builder must not be used afterwards
+    std::shared_ptr<const TrackModel> finish() {
+        runToCompletion();
+        return std::move(model);
+    }
+    
+private:
+    void stepFrames() {
+        const CatmullRomSpline& spline = model->spline;
+        int last = model->segments * model->samplesPerSegment;
+        double t = static_cast<double>(cursor) / last;
+        
+        TrackFrame f;
+        f.point = spline.getPointRaw(t);
+        f.tangent = spline.getTangent(t);
+        f.curvature = 0;  // filled lazily, see TrackModel::ensureFrames
+        f.tilt = interpolateTilt(t);
+        f.arcLength = model->frames.empty()
+            ? 0 : model->frames.back().arcLength + model->frames.back().point.distanceTo(f.point);
+        
+        model->frames.push_back(f);
+        arcLengths.push_back(f.arcLength);
+        
+        if (++cursor > last) {
+            model->totalLength = f.arcLength;
+            model->spline.setArcLengths(std::move(arcLengths));
+            model->lazyFrames.reset(model->frames.size());
+            stage = Stage::Zones;
+            cursor = 0;
+        }
+    }
+    
+    void stepZones() {
+        model->features = ElementRecognizer::segment(*model);
+        model->loopZones = ElementRecognizer::loopZones(*model, model->features);
+        findFirstPeak();
+#ifdef PHYSICS_RIDE_CORE
+        // Riding needs the loop zones but never the validation results, so
+        // the core leaves the validator out of every build
+        stage = Stage::Done;
+#else
+        stage = Stage::Validation;
+#endif
+        cursor = 0;
+    }
+    
+    void findFirstPeak() {
+        const std::vector<TrackPointData>& points = model->points;
+        if (points.size() < 3) {
+            model->firstPeakProgress = 0.2;
+            return;
+        }
+        
+        double maxHeight = points[0].position.y;
+        int peakIndex = 0;
+        
+        for (size_t i = 1; i < points.size(); i++) {
+            if (points[i].position.y > maxHeight) {
+                maxHeight = points[i].position.y;
+                peakIndex = i;
+            }
+        }
+        
+        double peak = std::min(0.5, std::max(0.1, static_cast<double>(peakIndex) / model->segments));
+        
+        // Release at the spline crest, not the control point: the curve
+        // keeps climbing past the point when the next one is higher than
+        // the previous, and a train let go on the climb rolls back onto
+        // the chain
+        const std::vector<TrackFrame>& frames = model->frames;
+        size_t last = frames.size() - 1;
+        size_t crest = static_cast<size_t>(std::lround(peak * last));
+        while (crest < last && frames[crest + 1].point.y >= frames[crest].point.y) crest++;
+        model->firstPeakProgress = static_cast<double>(crest) / last;
+    }
+    
+#ifndef PHYSICS_RIDE_CORE
+    void stepValidation() {
+        TrackValidator::validateSegment(
+            model->spline, model->points, cursor, model->segments, model->validation);
+        
+        if (++cursor >= model->segments) {
+            stage = Stage::IntersectionSamples;
+            cursor = 0;
+        }
+    }
+    
+    void stepIntersection() {
+        bool found = static_cast<size_t>(cursor) < intersectionSamples.size() &&
+            TrackValidator::checkSelfIntersectionRow(
+                intersectionSamples, cursor, model->segments, model->validation);
+        
+        if (found || static_cast<size_t>(++cursor) >= intersectionSamples.size()) {
+            if (model->validation.empty()) {
+                model->validation.push_back({true, "Track validation passed", 0, -1, 0});
+            }
+            intersectionSamples.clear();
+            stage = Stage::Done;
+        }
+    }
+#endif
+    
+    double interpolateTilt(double progress) const {
+        const std::vector<TrackPointData>& points = model->points;
+        int n = points.size();
+        int segments = model->segments;
+        
+        double scaledT = progress * segments;
+        int index = static_cast<int>(std::floor(scaledT));
+        double frac = scaledT - index;
+        
+        if (model->isLooped) {
+            int i0 = ((index % n) + n) % n;
+            int i1 = ((index + 1) % n + n) % n;
+            return points[i0].tilt * (1.0 - frac) + points[i1].tilt * frac;
+        } else {
+            if (index >= n - 1) return points[n - 1].tilt;
+            return points[index].tilt * (1.0 - frac) + points[index + 1].tilt * frac;
+        }
+    }
+};
+
+/**
+ * Versioned pointer to the newest published TrackModel. Builders publish,
+ * the engine acquires; an older build finishing late never replaces a
+ * newer one.
+ */
+class TrackModelSlot {
+private:
+    std::shared_ptr<const TrackModel> current;
+    std::atomic<uint32_t> publishedVersion{0};
+    
+public:
+    void publish(std::shared_ptr<const TrackModel> next) {
+        std::shared_ptr<const TrackModel> expected = std::atomic_load(&current);
+        do {
+            if (expected && expected->version >= next->version) return;
+        } while (!std::atomic_compare_exchange_weak(&current, &expected, next));
+        
+        uint32_t seen = publishedVersion.load(std::memory_order_relaxed);
+        while (seen < next->version &&
+               !publishedVersion.compare_exchange_weak(seen, next->version,
+                                                        std::memory_order_release)) {}
+    }
+    
+    std::shared_ptr<const TrackModel> acquire() const {
+        return std::atomic_load(&current);
+    }
+    
+    uint32_t getPublishedVersion() const {
+        return publishedVersion.load(std::memory_order_acquire);
+    }
+};
+
+// State shared between an engine and its background builds
+struct TrackBuildChannel {
+    std::atomic<uint32_t> latestRequest{0};
+    TrackModelSlot slot;
+};
+
+#if PHYSICS_HAS_THREADS
+/**
+ * One long-lived builder thread per engine. submit() replaces any request
+ * not yet started; a build in progress gives up within one slice once a
+ * newer request exists, so dragging a point never queues stale builds or
+ * spawns a thread (a Worker, on Emscripten) per edit. Joined on destruction.
+ */
+class TrackBuildWorker {
+public:
+    explicit TrackBuildWorker(std::shared_ptr<TrackBuildChannel> channel)
+        : channel(std::move(channel)), thread([this]() { run(); }) {}
+    
+    ~TrackBuildWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+    
+    TrackBuildWorker(const TrackBuildWorker&) = delete;
+    TrackBuildWorker& operator=(const TrackBuildWorker&) = delete;
+    
+    void submit(const std::vector<TrackPointData>& points, bool isLooped, uint32_t version) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            request = Request{points, isLooped, version};
+            hasRequest = true;
+        }
+        wake.notify_one();
+    }
+    
+private:
+    static constexpr int SLICE_UNITS = 64;
+    
+    struct Request {
+        std::vector<TrackPointData> points;
+        bool isLooped = false;
+        uint32_t version = 0;
+    };
+    
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this]() { return stopping || hasRequest; });
+            if (stopping) return;
+            Request next = std::move(request);
+            hasRequest = false;
+            lock.unlock();
+            
+            TrackModelBuilder builder(next.points, next.isLooped, next.version);
+            bool superseded = false;
+            while (!superseded && !builder.advance(SLICE_UNITS)) {
+                superseded = stopping.load(std::memory_order_relaxed) ||
+                             channel->latestRequest.load(std::memory_order_relaxed) != next.version;
+            }
+            if (!superseded) channel->slot.publish(builder.finish());
+            
+            lock.lock();
+        }
+    }
+    
+    std::shared_ptr<TrackBuildChannel> channel;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Request request;
+    bool hasRequest = false;
+    std::atomic<bool> stopping{false};
+    std::thread thread;     // last: starts once everything above exists
+};
+#endif
+
+// ============================================================================
+// Track Tables
+// ============================================================================
+
+/**
+ * Warm-start blob of a TrackModel's precomputed tables (frames, features,
+ * loop zones, validation, totals), so reopening an unchanged track is a copy
+ * instead of a rebuild. The blob carries the exact point bits it was built
+ * from. decode() returns null unless those match the points being opened,
+ * the magic, format version, PHYSICS_REVISION and frame layout agree, and
+ * the checksum holds. Callers then rebuild.
+ *
+ * Bump FORMAT_VERSION when the layout changes; model changes bump
+ * PHYSICS_REVISION. Host byte order, like TrackCodec and every WASM and Node target.
+ */
+class TrackTables {
+public:
+    static constexpr uint32_t MAGIC = 0x54435452;  // "RTCT"
+    static constexpr uint32_t FORMAT_VERSION = 3;
+    
+    static std::vector<uint8_t> encode(const TrackModel& model) {
+        std::vector<uint8_t> out;
+        writeHeader(out, model.points, model.isLooped);
+        size_t payloadStart = out.size();
+        put(out, static_cast<uint32_t>(model.segments));
+        put(out, static_cast<uint32_t>(model.samplesPerSegment));
+        put(out, model.totalLength);
+        put(out, model.firstPeakProgress);
+        
+        // Stored fully built, so a warm start never rebuilds chunks
+        if (!model.frames.empty()) model.ensureFrames(0, model.frames.size() - 1);
+        put(out, static_cast<uint32_t>(model.frames.size()));
+        putRaw(out, model.frames.data(), model.frames.size() * sizeof(TrackFrame));
+        
+        put(out, static_cast<uint32_t>(model.features.size()));
+        putRaw(out, model.features.data(), model.features.size() * sizeof(TrackFeature));
+        
+        put(out, static_cast<uint32_t>(model.loopZones.size()));
+        for (const auto& zone : model.loopZones) {
+            put(out, zone.first);
+            put(out, zone.second);
+        }
+        
+        put(out, static_cast<uint32_t>(model.validation.size()));
+        for (const ValidationResult& r : model.validation) {
+            put(out, static_cast<uint8_t>(r.isValid ? 1 : 0));
+            put(out, static_cast<int32_t>(r.severity));
+            put(out, static_cast<int32_t>(r.pointIndex));
+            put(out, r.value);
+            put(out, static_cast<uint32_t>(r.message.size()));
+            putRaw(out, r.message.data(), r.message.size());
+        }
+        
+        put(out, checksum(out.data() + payloadStart, out.size() - payloadStart));
+        return out;
+    }
+    
+    static std::shared_ptr<TrackModel> decode(const uint8_t* data, size_t size,
+                                              const std::vector<TrackPointData>& points,
+                                              bool isLooped) {
+        if (points.size() < 2) return nullptr;
+        
+        // The header is the point bits themselves, so compare it whole
+        std::vector<uint8_t> expected;
+        writeHeader(expected, points, isLooped);
+        if (size < expected.size() + sizeof(uint64_t) ||
+            std::memcmp(data, expected.data(), expected.size()) != 0) {
+            return nullptr;
+        }
+        
+        size_t payloadStart = expected.size();
+        size_t payloadEnd = size - sizeof(uint64_t);
+        uint64_t stored;
+        std::memcpy(&stored, data + payloadEnd, sizeof(stored));
+        if (stored != checksum(data + payloadStart, payloadEnd - payloadStart)) return nullptr;
+        
+        Reader in{data + payloadStart, data + payloadEnd};
+        std::shared_ptr<TrackModel> model = std::make_shared<TrackModel>();
+        model->points = points;
+        model->isLooped = isLooped;
+        
+        uint32_t segments = 0, samplesPerSegment = 0, frameCount = 0;
+        if (!in.get(segments) || !in.get(samplesPerSegment) ||
+            !in.get(model->totalLength) || !in.get(model->firstPeakProgress) ||
+            !in.get(frameCount)) {
+            return nullptr;
+        }
+        // Counts come from the blob, so size math is 64-bit even on wasm32
+        // and the sampling must be the builder's own
+        uint32_t expectedSegments = isLooped ? points.size() : points.size() - 1;
+        if (segments != expectedSegments ||
+            samplesPerSegment != static_cast<uint32_t>(model->samplesPerSegment) ||
+            frameCount != static_cast<uint64_t>(segments) * samplesPerSegment + 1 ||
+            in.remaining() < static_cast<uint64_t>(frameCount) * sizeof(TrackFrame)) {
+            return nullptr;
+        }
+        model->segments = segments;
+        model->frames.resize(frameCount);
+        in.getRaw(model->frames.data(), frameCount * sizeof(TrackFrame));
+        model->lazyFrames.reset(frameCount);
+        model->lazyFrames.markAllBuilt();
+        
+        uint32_t featureCount = 0;
+        if (!in.get(featureCount) || in.remaining() < static_cast<uint64_t>(featureCount) * sizeof(TrackFeature)) {
+            return nullptr;
+        }
+        model->features.resize(featureCount);
+        in.getRaw(model->features.data(), featureCount * sizeof(TrackFeature));
+        // Kinds index per-kind tables (TrackDescriptor)
+        for (const TrackFeature& f : model->features) {
+            if (f.kind < FEATURE_STRAIGHT || f.kind > FEATURE_INVERSION) return nullptr;
+        }
+        
+        uint32_t zoneCount = 0;
+        if (!in.get(zoneCount) || in.remaining() < static_cast<uint64_t>(zoneCount) * 2 * sizeof(double)) {
+            return nullptr;
+        }
+        model->loopZones.resize(zoneCount);
+        for (auto& zone : model->loopZones) {
+            in.get(zone.first);
+            in.get(zone.second);
+        }
+        
+        uint32_t resultCount = 0;
+        if (!in.get(resultCount)) return nullptr;
+        for (uint32_t i = 0; i < resultCount; i++) {
+            uint8_t isValid;
+            int32_t severity, pointIndex;
+            double value;
+            uint32_t length;
+            if (!in.get(isValid) || !in.get(severity) || !in.get(pointIndex) ||
+                !in.get(value) || !in.get(length) || in.remaining() < length) {
+                return nullptr;
+            }
+            std::string message(reinterpret_cast<const char*>(in.at), length);
+            in.at += length;
+            model->validation.push_back({isValid != 0, std::move(message), severity, pointIndex, value});
+        }
+        if (in.remaining() != 0) return nullptr;
+        
+        // The spline only needs its control points and the arc-length column
+        std::vector<Vec3> positions;
+        positions.reserve(points.size());
+        for (const auto& p : points) positions.push_back(p.position);
+        model->spline.setPoints(positions, isLooped, 0.5, false);
+        
+        std::vector<double> arcLengths(frameCount);
+        for (uint32_t i = 0; i < frameCount; i++) arcLengths[i] = model->frames[i].arcLength;
+        model->spline.setArcLengths(std::move(arcLengths));
+        return model;
+    }
+    
+private:
+    static_assert(std::is_trivially_copyable<TrackFrame>::value, "frames are copied as bytes");
+    static_assert(std::is_trivially_copyable<TrackFeature>::value, "features are copied as bytes");
+    
+    template <typename T>
+    static void put(std::vector<uint8_t>& out, T value) {
+        putRaw(out, &value, sizeof(T));
+    }
+    
+    static void putRaw(std::vector<uint8_t>& out, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+    
+    static void writeHeader(std::vector<uint8_t>& out, const std::vector<TrackPointData>& points,
+                            bool isLooped) {
+        put(out, MAGIC);
+        put(out, FORMAT_VERSION);
+        put(out, PHYSICS_REVISION);
+        put(out, static_cast<uint32_t>(sizeof(TrackFrame)));
+        put(out, static_cast<uint8_t>(isLooped ? 1 : 0));
+        put(out, static_cast<uint32_t>(points.size()));
+        for (const TrackPointData& p : points) {
+            put(out, p.position.x);
+            put(out, p.position.y);
+            put(out, p.position.z);
+            put(out, p.tilt);
+            put(out, static_cast<uint8_t>(p.hasLoop ? 1 : 0));
+            put(out, p.loopRadius);
+            put(out, p.loopPitch);
+        }
+    }
+    
+    // FNV-1a over 64-bit words (tail zero-padded): catches truncated or
+    // corrupted storage at a fraction of a rebuild's cost
+    static uint64_t checksum(const uint8_t* data, size_t size) {
+        uint64_t h = 14695981039346656037ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            h = (h ^ word) * 1099511628211ull;
+        }
+        if (i < size) {
+            uint64_t word = 0;
+            std::memcpy(&word, data + i, size - i);
+            h = (h ^ word) * 1099511628211ull;
+        }
+        return h ^ size;
+    }
+    
+    struct Reader {
+        const uint8_t* at;
+        const uint8_t* end;
+        
+        size_t remaining() const { return end - at; }
+        
+        template <typename T>
+        bool get(T& value) {
+            if (remaining() < sizeof(T)) return false;
+            std::memcpy(&value, at, sizeof(T));
+            at += sizeof(T);
+            return true;
+        }
+        
+        void getRaw(void* out, size_t size) {
+            std::memcpy(out, at, size);
+            at += size;
+        }
+    };
+};
+
+// ============================================================================
+// State Publication
+// ============================================================================
+
+/**
+ * Single-writer seqlock. The writer never blocks; readers on any thread
+ * retry until they copy a snapshot no write overlapped, so they never see
+ * a torn value. The payload is stored as relaxed atomic words so
+ * concurrent access stays well-defined.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+    
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    std::atomic<uint32_t> sequence{0};  // odd while a write is in progress
+    std::atomic<uint64_t> words[WORDS];
+    
+public:
+    SeqLock() {
+        for (auto& w : words) w.store(0, std::memory_order_relaxed);
+    }
+    
+    void write(const T& value) {
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+    
+    T read() const {
+        uint64_t buffer[WORDS];
+        uint32_t before, after;
+        
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+    
+    // Number of completed writes; lets readers skip unchanged snapshots
+    uint32_t getVersion() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+// ============================================================================
+// Ride Events
+// ============================================================================
+
+enum RideEventType : int {
+    EVENT_LOOP_ENTER = 0,
+    EVENT_LOOP_EXIT = 1,
+    EVENT_CHAIN_LIFT_ENGAGE = 2,
+    EVENT_CHAIN_LIFT_RELEASE = 3,
+    EVENT_AIRTIME_START = 4,
+    EVENT_AIRTIME_END = 5,
+    EVENT_STATION_CROSSED = 6,
+    EVENT_SEEK = 7,
+};
+
+struct RideEvent {
+    int type;           // RideEventType
+    double time;        // simulation seconds since reset
+    double arcLength;   // meters from start
+    double progress;    // 0-1 along track
+    double value;       // speed (m/s), vertical G for airtime events, or
+                        // the new time for seeks
+};
+
+/**
+ * Fixed-capacity single-producer/single-consumer event queue. The stepping
+ * thread pushes without ever blocking; when the consumer falls behind, new
+ * events are dropped and counted rather than overwriting undrained ones.
+ */
+class EventRing {
+public:
+    static constexpr uint32_t CAPACITY = 256;
+    
+private:
+    RideEvent slots[CAPACITY];
+    std::atomic<uint32_t> head{0};  // written by producer
+    std::atomic<uint32_t> tail{0};  // written by consumer
+    std::atomic<uint32_t> dropped{0};
+    
+public:
+    void push(const RideEvent& event) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slots[h % CAPACITY] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+    
+    std::vector<RideEvent> drain() {
+        std::vector<RideEvent> events;
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        
+        events.reserve(h - t);
+        for (; t != h; t++) {
+            events.push_back(slots[t % CAPACITY]);
+        }
+        
+        tail.store(t, std::memory_order_release);
+        return events;
+    }
+    
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// ============================================================================
+// Audio Control Stream
+// ============================================================================
+
+// Channel layout of one control frame
+enum ControlChannel : uint32_t {
+    CONTROL_SPEED = 0,           // m/s
+    CONTROL_G_VERTICAL = 1,      // G's
+    CONTROL_G_LATERAL = 2,       // G's
+    CONTROL_CHAIN_LIFT = 3,      // 0-1 (fractional across engage/release)
+    CONTROL_WHEEL_NOISE = 4,     // 0-1 intensity from speed and curvature
+    CONTROL_CHANNEL_COUNT = 5,
+};
+
+/**
+ * Ride parameters resampled to a fixed control rate for audio. Frames are
+ * float32 and laid out contiguously so an AudioWorklet can read them from
+ * a typed array view; in the pthreads build that view is backed by a
+ * SharedArrayBuffer and needs no copying at all. Single producer; readers
+ * track their own position against the head.
+ */
+class ControlStream {
+public:
+    static constexpr uint32_t CAPACITY = 2048;  // frames, ~10 s at 200 Hz
+    
+private:
+    float frames[CAPACITY * CONTROL_CHANNEL_COUNT];
+    std::atomic<uint32_t> head{0};  // frames written so far
+    
+public:
+    void push(const float* frame) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        std::memcpy(&frames[(h % CAPACITY) * CONTROL_CHANNEL_COUNT], frame,
+                    CONTROL_CHANNEL_COUNT * sizeof(float));
+        head.store(h + 1, std::memory_order_release);
+    }
+    
+    uint32_t getHead() const { return head.load(std::memory_order_acquire); }
+    const float* data() const { return frames; }
+    const std::atomic<uint32_t>* headAddress() const { return &head; }
+};
+
+// Wheel roar grows with speed and is louder through tight curves
+inline double wheelNoiseIntensity(double speed, double curvature) {
+    double speedFactor = std::min(1.0, std::abs(speed) / 25.0);
+    double curveFactor = std::min(1.0, curvature * 10.0);  // saturates at 10m radius
+    return speedFactor * (0.5 + 0.5 * curveFactor);
+}
+
+// ============================================================================
+// Stall Analysis
+// ============================================================================
+
+enum StallOutcome : int {
+    STALL_NONE = 0,          // clears every hill
+    STALL_SETTLES = 1,       // rolls back and forth and comes to rest in the valley
+    STALL_CHAIN_CATCH = 2,   // rolls back onto the chain lift, which carries it into the same stall again
+    STALL_STATION = 3,       // open track: rolls back into the station
+};
+
+struct StallPrediction {
+    int outcome;               // StallOutcome
+    double stallProgress;      // where the train first stops, -1 if it never does
+    int hillPoint;             // control point nearest the crest it fails, -1 if none
+    double shortfall;          // meters between the stall point and that crest
+    int swings;                // direction reversals after the stall
+    double restProgress;       // where it settles or is caught, -1 if it never stalls
+    double minSpeed;           // lowest speed off the chain lift before any stall
+    double minSpeedProgress;
+};
+
+/**
+ * Predicts stalls from the energy profile instead of a time-domain run.
+ * Per unit mass, kinetic energy along the track obeys
+ *     dK/ds = -g·t_y - μg - 2cK
+ * (c = AIR_RESISTANCE), which integrates in closed form across each frame
+ * interval with the interval's mean slope. Distance is measured the way
+ * step() measures it, totalLength spread evenly over the frames, so the
+ * prediction follows the engine rather than the true arc length.
+ *
+ * After a stall the same walk runs backward and forward through the valley,
+ * one reversal at a time, until the train stops where gravity cannot beat
+ * friction, or reaches the chain lift or the station.
+ */
+class StallAnalyzer {
+public:
+    static constexpr int MAX_SWINGS = 256;
+    
+    static StallPrediction predict(const TrackModel& m, bool chainLift, double startSpeed) {
+        StallPrediction p{STALL_NONE, -1, -1, 0, 0, -1, std::abs(startSpeed), 0};
+        const size_t n = m.frames.size();
+        if (m.points.size() < 2 || n < 2 || m.totalLength <= 0) return p;
+        
+        const double last = static_cast<double>(n - 1);
+        const double interval = m.totalLength / last;   // engine meters per frame interval
+        const double chainEnd = chainLift ? m.firstPeakProgress * last : 0;
+        bool minTracked = false;
+        
+        // Forward from the station until the lap ends or the train stops
+        double kinetic = 0.5 * startSpeed * startSpeed;
+        double stopAt = -1;
+        for (size_t i = 0; i + 1 < n; i++) {
+            if (i < chainEnd) {
+                kinetic = 0.5 * CHAIN_LIFT_SPEED * CHAIN_LIFT_SPEED;
+                continue;
+            }
+            
+            double speed = std::sqrt(2.0 * kinetic);
+            if (!minTracked || speed < p.minSpeed) {
+                p.minSpeed = speed;
+                p.minSpeedProgress = i / last;
+                minTracked = true;
+            }
+            
+            double travelled = 0;
+            kinetic = advance(kinetic, resistance(m, i, +1), interval, travelled);
+            if (kinetic <= 0) {
+                stopAt = i + travelled / interval;
+                break;
+            }
+        }
+        if (stopAt < 0) return p;
+        
+        p.stallProgress = stopAt / last;
+        p.minSpeed = 0;
+        p.minSpeedProgress = p.stallProgress;
+        
+        size_t crest = static_cast<size_t>(stopAt);
+        while (crest + 1 < n && m.frames[crest + 1].point.y >= m.frames[crest].point.y) crest++;
+        p.shortfall = m.frames[crest].point.y - m.frameAt(p.stallProgress).point.y;
+        p.hillPoint = static_cast<int>(std::lround(static_cast<double>(crest) / last * m.segments))
+                      % static_cast<int>(m.points.size());
+        
+        // Swing through the valley, alternating direction, until it sticks
+        double x = stopAt;
+        int dir = -1;
+        p.outcome = STALL_SETTLES;
+        for (; p.swings < MAX_SWINGS; p.swings++) {
+            if (sticks(m, x, dir) && sticks(m, x, -dir)) break;
+            if (sticks(m, x, dir)) dir = -dir;
+            
+            kinetic = 0;
+            double swing = 0;   // meters covered in this swing
+            for (size_t walked = 0; walked < 4 * n; walked++) {
+                if (chainLift && x < chainEnd) {
+                    p.outcome = STALL_CHAIN_CATCH;
+                    p.restProgress = x / last;
+                    return p;
+                }
+                if (dir < 0 && x <= 0) {
+                    if (!m.isLooped) {
+                        p.outcome = STALL_STATION;
+                        p.restProgress = 0;
+                        return p;
+                    }
+                    x += last;
+                }
+                if (dir > 0 && x >= last) {
+                    if (!m.isLooped) break;
+                    x -= last;
+                }
+                
+                size_t i = dir > 0 ? static_cast<size_t>(x) : static_cast<size_t>(std::ceil(x)) - 1;
+                i = std::min(i, n - 2);
+                double boundary = dir > 0 ? i + 1.0 : static_cast<double>(i);
+                double length = std::abs(boundary - x) * interval;
+                if (length <= 0) length = interval;  // x sits on a frame: cross the whole interval
+                
+                double travelled = 0;
+                kinetic = advance(kinetic, resistance(m, i, dir), length, travelled);
+                swing += travelled;
+                if (kinetic <= 0) {
+                    x += dir * travelled / interval;
+                    break;
+                }
+                x = dir > 0 ? i + 1.0 : static_cast<double>(i);
+            }
+            
+            // Millimeter swings about the bottom: settled
+            if (swing < 1e-3) break;
+            dir = -dir;
+        }
+        
+        p.restProgress = x / last;
+        return p;
+    }
+    
+    // Reports a predicted stall alongside the geometry checks
+    static void appendValidation(const StallPrediction& p, std::vector<ValidationResult>& results) {
+        if (p.outcome == STALL_NONE) return;
+        
+        results.erase(std::remove_if(results.begin(), results.end(),
+                                     [](const ValidationResult& r) { return r.isValid; }),
+                      results.end());
+        results.push_back({
+            false,
+            "Train cannot clear hill at point " + std::to_string(p.hillPoint + 1),
+            2, p.hillPoint, p.shortfall
+        });
+    }
+    
+private:
+    // Deceleration per meter moving in `dir` across frame interval i
+    static double resistance(const TrackModel& m, size_t i, int dir) {
+        double slope = 0.5 * (m.frames[i].tangent.y + m.frames[i + 1].tangent.y);
+        return dir * GRAVITY * slope + ROLLING_FRICTION * GRAVITY;
+    }
+    
+    // At rest at x, gravity toward `dir` cannot overcome static friction
+    static bool sticks(const TrackModel& m, double x, int dir) {
+        double slope = m.frameAt(x / (m.frames.size() - 1)).tangent.y;
+        return -dir * GRAVITY * slope <= ROLLING_FRICTION * GRAVITY;
+    }
+    
+    // Integrates dK/ds = -a - 2cK over `length` meters. Returns the energy
+    // at the end, or 0 with `travelled` set if the train stops first.
+    static double advance(double kinetic, double a, double length, double& travelled) {
+        const double c2 = 2.0 * AIR_RESISTANCE;
+        const double b = a / c2;
+        travelled = length;
+        if (a > 0) {
+            double stop = std::log((kinetic + b) / b) / c2;
+            if (stop < length) {
+                travelled = stop;
+                return 0;
+            }
+        }
+        return (kinetic + b) * std::exp(-c2 * length) - b;
+    }
+};
+
+// ============================================================================
+// Track Statistics
+// ============================================================================
+
+struct TrackStats {
+    double totalLength;     // meters, spline plus inline elements
+    double elementLength;   // meters of totalLength inside loop/roll elements
+    double minHeight;       // meters
+    double maxHeight;       // meters
+    double maxGrade;        // degrees from horizontal
+    double maxBank;         // degrees
+    int inversions;
+    int elements;           // loop/roll elements
+    double rideTime;        // seconds for one run of a headless simulation, or until it came to rest
+    double maxSpeed;        // m/s during that run
+    double maxGForce;       // G's during that run
+    bool rideCompleted;     // false if the headless run stalled or hit its time limit
+};
+
+// Energy bookkeeping for one control-point span, per unit mass (J/kg),
+// from a single headless run
+struct EnergySection {
+    double startProgress;
+    double endProgress;
+    double length;          // meters of track geometry
+    double entryHeight;     // meters
+    double peakHeight;      // highest point in the span
+    double peakDistance;    // meters from the span's start to its peak
+    double entrySpeed;      // m/s when the run entered the span
+    double exitSpeed;       // m/s when the run left it
+    double dragLoss;        // energy lost to air resistance in the span
+    double frictionLoss;    // energy lost to rolling friction in the span
+    double dragToPeak;      // drag loss between entry and the peak
+    double liftGain;        // energy added by the chain lift
+    double margin;          // kinetic energy left at the peak; < 0 means a stall
+    bool chainLifted;       // the chain carries the train through this span
+    bool reached;
+};
+
+/**
+ * Per-section energy table plus predictors that answer "does the train
+ * make it over section k" from energy margins, in O(sections), without
+ * another time-domain run. Margins use the geometry for height and
+ * friction (exact per meter) and the reference run for drag.
+ */
+class EnergyBudget {
+public:
+    std::vector<EnergySection> sections;
+    bool completed = false;
+    
+    // Kinetic energy left at the peak of section k for a given entry speed
+    double clearanceMargin(int k, double entrySpeed) const {
+        if (k < 0 || k >= static_cast<int>(sections.size())) return 0;
+        const EnergySection& s = sections[k];
+        if (s.chainLifted) return std::numeric_limits<double>::infinity();
+        return 0.5 * entrySpeed * entrySpeed
+             + GRAVITY * (s.entryHeight - s.peakHeight)
+             - ROLLING_FRICTION * GRAVITY * s.peakDistance
+             - s.dragToPeak;
+    }
+    
+    bool canClearSection(int k, double entrySpeed) const {
+        return clearanceMargin(k, entrySpeed) > 0;
+    }
+    
+    // Carries energy forward span by span from `startSpeed` at the start of
+    // section `from`; returns the first section the train cannot clear,
+    // or -1 if it makes every one
+    int firstStallSection(int from, double startSpeed) const {
+        double energy = 0.5 * startSpeed * startSpeed;  // kinetic, J/kg
+        for (int k = std::max(0, from); k < static_cast<int>(sections.size()); k++) {
+            const EnergySection& s = sections[k];
+            double speed = std::sqrt(std::max(0.0, 2.0 * energy));
+            if (s.chainLifted) {
+                energy = std::max(energy, 0.5 * CHAIN_LIFT_SPEED * CHAIN_LIFT_SPEED);
+                speed = std::sqrt(2.0 * energy);
+            }
+            if (!canClearSection(k, speed)) return k;
+            
+            double exitHeight = k + 1 < static_cast<int>(sections.size())
+                ? sections[k + 1].entryHeight : s.entryHeight;
+            energy += GRAVITY * (s.entryHeight - exitHeight) - s.dragLoss - s.frictionLoss;
+            if (s.chainLifted) energy = std::max(energy, 0.5 * s.exitSpeed * s.exitSpeed);
+        }
+        return -1;
+    }
+};
+
+/**
+ * Ride state as a function of position from one reference lap. While laps
+ * repeat, speed and G depend only on where the train is, so a ride can look
+ * its whole state up by position and only integrate ds/dt.
+ *
+ * Node k holds the progress at the start of reference step k, the speed and
+ * G that step produced, and the track sample at that progress (what the
+ * previous step ended on). A ride stepped at the reference step lands on the
+ * nodes exactly and reproduces the integrator bit for bit; between nodes
+ * (other step sizes) everything is linear in progress.
+ */
+struct SpeedProfile {
+    std::vector<double> progress;  // strictly increasing
+    std::vector<double> speed;     // m/s
+    std::vector<double> time;      // seconds since the station at each node
+    std::vector<double> gVertical;
+    std::vector<double> gLateral;
+    std::vector<double> gTotal;    // smoothed, as step() publishes it
+    std::vector<double> gRaw;      // unsmoothed total step() pushes into its history
+    std::vector<Vec3> point;       // track sample at `progress`
+    std::vector<Vec3> tangent;
+    std::vector<double> tilt;
+    std::vector<double> curvature;
+    std::vector<uint8_t> inLoop;
+    double referenceStep = 0;
+    bool completed = false;        // false: the reference run stalled or turned back
+    
+    // Index of the last node at or before p. `cursor` is the previous
+    // answer; rides move forward a node or two per step, so this is O(1)
+    // amortized and falls back to a binary search for jumps.
+    size_t locate(double p, size_t& cursor) const {
+        const size_t n = progress.size();
+        if (cursor >= n || progress[cursor] > p) {
+            cursor = 0;
+            if (progress.empty() || p <= progress[0]) return cursor;
+            cursor = static_cast<size_t>(std::upper_bound(progress.begin(), progress.end(), p) - progress.begin()) - 1;
+            return cursor;
+        }
+        for (int walk = 0; cursor + 1 < n && progress[cursor + 1] <= p; walk++) {
+            if (walk == 8) {
+                cursor = static_cast<size_t>(std::upper_bound(progress.begin() + cursor, progress.end(), p) - progress.begin()) - 1;
+                break;
+            }
+            cursor++;
+        }
+        return cursor;
+    }
+    
+    // Whether a step from p can be looked up. The last node's step ended
+    // the lap (an open track resets inside it), so from there on integrate.
+    bool covers(double p) const {
+        return progress.size() >= 2 && p < progress.back();
+    }
+    
+    // Node at or before p and the fraction of the way to the next one; 0
+    // on a node, so lookups there return the stored values exactly
+    size_t bracket(double p, size_t& cursor, double& t) const {
+        size_t i = locate(p, cursor);
+        t = i + 1 < progress.size() && p > progress[i]
+            ? (p - progress[i]) / (progress[i + 1] - progress[i]) : 0.0;
+        return i;
+    }
+    
+    template <typename T>
+    static T lerp(const std::vector<T>& column, size_t i, double t) {
+        return t > 0 ? column[i] + (column[i + 1] - column[i]) * t : column[i];
+    }
+    
+    double speedAt(double p, size_t& cursor) const {
+        if (progress.empty()) return 0;
+        double t;
+        size_t i = bracket(p, cursor, t);
+        return lerp(speed, i, t);
+    }
+    
+    double timeAt(double p, size_t& cursor) const {
+        if (progress.empty()) return 0;
+        size_t i = locate(p, cursor);
+        if (i + 1 >= progress.size() || p <= progress[i]) return time[i];
+        double t = (p - progress[i]) / (progress[i + 1] - progress[i]);
+        return time[i] + (time[i + 1] - time[i]) * t;
+    }
+};
+
+// State right after one step of a reference run: enough, with the frame
+// table, to put the engine anywhere on the lap with its G smoothing and
+// event detector consistent
+struct RideTimelineEntry {
+    double progress;
+    double speed;
+    double gForceRaw;      // unsmoothed total that went into the history
+    float gForceVertical;
+    float gForceLateral;
+    float gForceTotal;     // smoothed, as published
+    uint8_t flags;         // TIMELINE_* bits
+};
+
+enum TimelineFlag : uint8_t {
+    TIMELINE_CHAIN_LIFT = 1,
+    TIMELINE_IN_LOOP = 2,
+    TIMELINE_AIRTIME = 4,   // event detector's airtime state
+};
+
+/**
+ * One lap recorded step by step for seeking. Entry k is the state k
+ * reference steps after reset, so time lookups are direct and distance
+ * lookups binary-search the furthest progress reached so far.
+ */
+struct RideTimeline {
+    std::vector<RideTimelineEntry> entries;
+    std::vector<double> reach;      // running maximum of progress
+    double step = 0;
+    bool completed = false;
+    
+    double duration() const { return entries.empty() ? 0 : (entries.size() - 1) * step; }
+    
+    // Time at which the train first reaches progress p, interpolated
+    // within the step that gets there
+    double timeAtProgress(double p) const {
+        if (entries.empty()) return 0;
+        size_t k = static_cast<size_t>(std::lower_bound(reach.begin(), reach.end(), p) - reach.begin());
+        if (k == 0) return 0;
+        if (k >= reach.size()) return duration();
+        double span = reach[k] - reach[k - 1];
+        double t = span > 0 ? (p - reach[k - 1]) / span : 1.0;
+        return (k - 1 + t) * step;
+    }
+};
+
+// Spread of operating conditions for MonteCarloRides
+struct RobustnessOptions {
+    int samples = 2000;
+    uint32_t seed = 1;              // same seed, same draws for every sample index
+    int threads = 0;                // 0 = one per hardware thread (1 in the browser)
+    double minOccupancy = 0;        // fraction of seats filled, uniform between these
+    double maxOccupancy = 1;
+    double frictionSigma = 0.2;     // log-normal spread of the friction multiplier
+    double meanWindSpeed = 4;       // m/s, Rayleigh-distributed, any direction
+};
+
+// One control-point span over all samples; probabilities are fractions of
+// every sample run, not of those that reached the span
+struct RobustnessSection {
+    double startProgress;
+    double endProgress;
+    double reachProbability;
+    double stallProbability;        // the furthest the train got before stalling
+    double exceedanceProbability;   // broke a G limit here at least once
+    double maxVerticalG;            // worst over all samples; 0 if never reached
+    double minVerticalG;
+    double maxLateralG;
+};
+
+struct RobustnessReport {
+    int samples;
+    double stallProbability;        // any section
+    double exceedanceProbability;   // any section
+    std::vector<RobustnessSection> sections;
+};
+
+// ============================================================================
+// Trajectory Samples
+// ============================================================================
+
+// One recorded step of a ride, flat so it maps onto a plain JS object.
+// Orientation is a unit quaternion taking the car's local axes (+Z forward,
+// +Y up) to world space.
+struct TrajectorySample {
+    double time;
+    double x, y, z;
+    double qx, qy, qz, qw;
+    double speed;
+    double gForceVertical;
+    double gForceLateral;
+    
+    TrajectorySample()
+        : time(0), x(0), y(0), z(0), qx(0), qy(0), qz(0), qw(1),
+          speed(0), gForceVertical(0), gForceLateral(0) {}
+    
+    // From an orthonormal right-handed basis (the columns of the rotation)
+    void setOrientation(const Vec3& ax, const Vec3& ay, const Vec3& az) {
+        double trace = ax.x + ay.y + az.z;
+        if (trace > 0) {
+            double s = 0.5 / std::sqrt(trace + 1.0);
+            qw = 0.25 / s;
+            qx = (ay.z - az.y) * s;
+            qy = (az.x - ax.z) * s;
+            qz = (ax.y - ay.x) * s;
+        } else if (ax.x > ay.y && ax.x > az.z) {
+            double s = 2.0 * std::sqrt(1.0 + ax.x - ay.y - az.z);
+            qw = (ay.z - az.y) / s;
+            qx = 0.25 * s;
+            qy = (ay.x + ax.y) / s;
+            qz = (az.x + ax.z) / s;
+        } else if (ay.y > az.z) {
+            double s = 2.0 * std::sqrt(1.0 + ay.y - ax.x - az.z);
+            qw = (az.x - ax.z) / s;
+            qx = (ay.x + ax.y) / s;
+            qy = 0.25 * s;
+            qz = (az.y + ay.z) / s;
+        } else {
+            double s = 2.0 * std::sqrt(1.0 + az.z - ax.x - ay.y);
+            qw = (ax.y - ay.x) / s;
+            qx = (az.x + ax.z) / s;
+            qy = (az.y + ay.z) / s;
+            qz = 0.25 * s;
+        }
+    }
+    
+    // Linear blend; the orientation is nlerped along the shorter arc
+    static TrajectorySample lerp(const TrajectorySample& a, const TrajectorySample& b, double t) {
+        auto mix = [t](double u, double v) { return u + (v - u) * t; };
+        double sign = (a.qx * b.qx + a.qy * b.qy + a.qz * b.qz + a.qw * b.qw) < 0 ? -1.0 : 1.0;
+        
+        TrajectorySample s;
+        s.time = mix(a.time, b.time);
+        s.x = mix(a.x, b.x);
+        s.y = mix(a.y, b.y);
+        s.z = mix(a.z, b.z);
+        s.qx = mix(a.qx, sign * b.qx);
+        s.qy = mix(a.qy, sign * b.qy);
+        s.qz = mix(a.qz, sign * b.qz);
+        s.qw = mix(a.qw, sign * b.qw);
+        double len = std::sqrt(s.qx * s.qx + s.qy * s.qy + s.qz * s.qz + s.qw * s.qw);
+        if (len > 1e-12) {
+            s.qx /= len; s.qy /= len; s.qz /= len; s.qw /= len;
+        }
+        s.speed = mix(a.speed, b.speed);
+        s.gForceVertical = mix(a.gForceVertical, b.gForceVertical);
+        s.gForceLateral = mix(a.gForceLateral, b.gForceLateral);
+        return s;
+    }
+};
+
+// ============================================================================
+// Track Profiles
+// ============================================================================
+
+// Ride quantities at every frame of a model, resampled from one headless
+// run so they can be looked up by frame index like the geometry
+struct RideProfile {
+    std::vector<float> time;        // seconds since the start
+    std::vector<float> speed;       // m/s
+    std::vector<float> gVertical;
+    std::vector<float> gLateral;
+    std::vector<float> gTotal;      // smoothed, as the engine reports it
+    uint32_t reachedFrames = 0;     // frames past this were never reached
+    bool completed = false;         // false if the train stalled or timed out
+};
+
+// Scalar channels a renderer can color the track by
+enum VertexAttribute : int {
+    ATTRIBUTE_SPEED = 0,        // m/s
+    ATTRIBUTE_G_VERTICAL = 1,
+    ATTRIBUTE_G_LATERAL = 2,
+    ATTRIBUTE_G_TOTAL = 3,
+    ATTRIBUTE_TIME = 4,         // seconds since the start of the ride
+    ATTRIBUTE_HEIGHT = 5,       // meters
+    ATTRIBUTE_COUNT = 6
+};
+
+// Douglas-Peucker: indices of the vertices to keep so that no dropped
+// vertex is further than `tolerance` from the simplified line. Coordinates
+// are in whatever space the tolerance is meant in (pixels for drawing).
+inline std::vector<uint32_t> simplifyPolyline(const std::vector<double>& xs,
+                                              const std::vector<double>& ys, double tolerance) {
+    const uint32_t n = static_cast<uint32_t>(xs.size());
+    if (n <= 2) {
+        std::vector<uint32_t> all(n);
+        for (uint32_t i = 0; i < n; i++) all[i] = i;
+        return all;
+    }
+    
+    std::vector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+    const double toleranceSq = tolerance * tolerance;
+    
+    std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0, n - 1 } };
+    while (!stack.empty()) {
+        auto [first, last] = stack.back();
+        stack.pop_back();
+        if (last - first < 2) continue;
+        
+        double ax = xs[first], ay = ys[first];
+        double dx = xs[last] - ax, dy = ys[last] - ay;
+        double lengthSq = dx * dx + dy * dy;
+        
+        double worstSq = -1;
+        uint32_t worst = first;
+        for (uint32_t i = first + 1; i < last; i++) {
+            double px = xs[i] - ax, py = ys[i] - ay;
+            double t = lengthSq > 0 ? std::max(0.0, std::min(1.0, (px * dx + py * dy) / lengthSq)) : 0;
+            double ex = px - t * dx, ey = py - t * dy;
+            double distSq = ex * ex + ey * ey;
+            if (distSq > worstSq) {
+                worstSq = distSq;
+                worst = i;
+            }
+        }
+        
+        if (worstSq > toleranceSq) {
+            keep[worst] = true;
+            stack.push_back({ first, worst });
+            stack.push_back({ worst, last });
+        }
+    }
+    
+    std::vector<uint32_t> kept;
+    for (uint32_t i = 0; i < n; i++) {
+        if (keep[i]) kept.push_back(i);
+    }
+    return kept;
+}
+
+// Last polyline built for one track version and parameter set
+struct PolylineCache {
+    bool valid = false;
+    uint32_t version = 0;
+    double params[3] = { 0, 0, 0 };
+    std::vector<float> data;
+    
+    template <typename Build>
+    const std::vector<float>& get(uint32_t v, double a, double b, double c, Build build) {
+        if (!valid || version != v || params[0] != a || params[1] != b || params[2] != c) {
+            data = build();
+            version = v;
+            params[0] = a;
+            params[1] = b;
+            params[2] = c;
+            valid = true;
+        }
+        return data;
+    }
+};
+
+/**
+ * Arc-length-indexed profiles for the 2D views, built from the model's
+ * frame table and returned as flat float arrays ready to stroke. Scales
+ * are the caller's current pixels per unit, so simplification removes
+ * exactly the vertices that would not move the drawing by more than
+ * tolerancePx.
+ */
+class TrackProfiles {
+public:
+    // [arcLength, height] per vertex
+    static std::vector<float> elevation(const TrackModel& model, double pxPerMeter,
+                                        double pxPerMeterY, double tolerancePx) {
+        return simplified(model, pxPerMeter, pxPerMeterY, tolerancePx,
+                          [](const TrackFrame& f) { return f.point.y; });
+    }
+    
+    // [arcLength, bank in degrees] per vertex
+    static std::vector<float> banking(const TrackModel& model, double pxPerMeter,
+                                      double pxPerDegree, double tolerancePx) {
+        const double toDegrees = 180.0 / M_PI;
+        return simplified(model, pxPerMeter, pxPerDegree, tolerancePx,
+                          [toDegrees](const TrackFrame& f) { return f.tilt * toDegrees; });
+    }
+    
+    // [arcLength, height, verticalCurvature, curvature] per tooth, one tooth
+    // every spacingPx along the track. Vertical curvature is the rate of
+    // change of pitch (1/m, positive when the track bends upward, i.e.
+    // extra vertical G); curvature is the unsigned total.
+    static std::vector<float> curvatureComb(const TrackModel& model, double pxPerMeter, double spacingPx) {
+        std::vector<float> out;
+        const std::vector<TrackFrame>& frames = model.frames;
+        if (frames.size() < 3 || model.totalLength <= 0) return out;
+        
+        const size_t n = frames.size();
+        model.ensureFrames(0, n - 1);
+        std::vector<double> verticalCurvature(n, 0.0);
+        for (size_t i = 1; i + 1 < n; i++) {
+            double ds = frames[i + 1].arcLength - frames[i - 1].arcLength;
+            if (ds <= 1e-9) continue;
+            verticalCurvature[i] = (pitch(frames[i + 1]) - pitch(frames[i - 1])) / ds;
+        }
+        verticalCurvature[0] = verticalCurvature[1];
+        verticalCurvature[n - 1] = verticalCurvature[n - 2];
+        
+        double spacing = std::max(1e-3, spacingPx / std::max(1e-9, pxPerMeter));
+        size_t teeth = static_cast<size_t>(model.totalLength / spacing) + 1;
+        out.reserve(teeth * 4);
+        
+        size_t i = 0;
+        for (size_t k = 0; k < teeth; k++) {
+            double s = k * spacing;
+            while (i + 2 < n && frames[i + 1].arcLength < s) i++;
+            const TrackFrame& a = frames[i];
+            const TrackFrame& b = frames[i + 1];
+            double span = b.arcLength - a.arcLength;
+            double t = span > 0 ? std::max(0.0, std::min(1.0, (s - a.arcLength) / span)) : 0;
+            
+            out.push_back(static_cast<float>(s));
+            out.push_back(static_cast<float>(a.point.y + (b.point.y - a.point.y) * t));
+            out.push_back(static_cast<float>(verticalCurvature[i] + (verticalCurvature[i + 1] - verticalCurvature[i]) * t));
+            out.push_back(static_cast<float>(a.curvature + (b.curvature - a.curvature) * t));
+        }
+        
+        return out;
+    }
+    
+    // [x, z, height, speed] per vertex of the top-down outline, simplified
+    // in the ground plane to toleranceMeters
+    static std::vector<float> minimap(const TrackModel& model, const RideProfile& ride, double toleranceMeters) {
+        const std::vector<TrackFrame>& frames = model.frames;
+        std::vector<double> xs(frames.size()), zs(frames.size());
+        for (size_t i = 0; i < frames.size(); i++) {
+            xs[i] = frames[i].point.x;
+            zs[i] = frames[i].point.z;
+        }
+        
+        std::vector<uint32_t> kept = simplifyPolyline(xs, zs, std::max(0.0, toleranceMeters));
+        std::vector<float> out;
+        out.reserve(kept.size() * 4);
+        for (uint32_t i : kept) {
+            out.push_back(static_cast<float>(frames[i].point.x));
+            out.push_back(static_cast<float>(frames[i].point.z));
+            out.push_back(static_cast<float>(frames[i].point.y));
+            out.push_back(i < ride.speed.size() ? ride.speed[i] : 0.0f);
+        }
+        return out;
+    }
+    
+    // Vertices Track.tsx lays along each inline element (64 steps, both ends)
+    static constexpr int ELEMENT_VERTICES = 65;
+    
+    // One value of `attribute` per rail vertex, in Track.tsx's layout:
+    // samplesPerSegment per control-point span, sampled uniformly in spline
+    // parameter; at each element, a joining vertex (except at point 0) and
+    // ELEMENT_VERTICES more, all holding the value at the element's entry;
+    // then the end of an open track, or the first vertex again on a looped
+    // one. The buffer lines up with the rails vertex for vertex.
+    static std::vector<float> vertexAttribute(const TrackModel& model, const RideProfile& ride,
+                                              int attribute, int samplesPerSegment) {
+        std::vector<float> out;
+        const std::vector<TrackFrame>& frames = model.frames;
+        if (frames.size() < 2 || model.segments <= 0) return out;
+        
+        const std::vector<float>* channel = nullptr;
+        switch (attribute) {
+            case ATTRIBUTE_SPEED: channel = &ride.speed; break;
+            case ATTRIBUTE_G_VERTICAL: channel = &ride.gVertical; break;
+            case ATTRIBUTE_G_LATERAL: channel = &ride.gLateral; break;
+            case ATTRIBUTE_G_TOTAL: channel = &ride.gTotal; break;
+            case ATTRIBUTE_TIME: channel = &ride.time; break;
+            default: break;
+        }
+        if (channel && channel->size() != frames.size()) channel = nullptr;
+        
+        // Frames are uniform in spline parameter, so progress maps straight
+        // onto a frame position
+        auto valueAt = [&](double progress) {
+            double scaled = std::max(0.0, std::min(1.0, progress)) * (frames.size() - 1);
+            size_t i = std::min(static_cast<size_t>(scaled), frames.size() - 2);
+            double t = scaled - i;
+            double a = channel ? (*channel)[i] : frames[i].point.y;
+            double b = channel ? (*channel)[i + 1] : frames[i + 1].point.y;
+            return static_cast<float>(a + (b - a) * t);
+        };
+        
+        const int perSegment = std::max(1, samplesPerSegment);
+        const int pointCount = static_cast<int>(model.points.size());
+        out.reserve(static_cast<size_t>(model.segments) * perSegment + 1);
+        for (int i = 0; i < pointCount; i++) {
+            if (model.points[i].hasLoop) {
+                float entry = valueAt(static_cast<double>(i) / model.segments);
+                out.insert(out.end(), ELEMENT_VERTICES + (i > 0 ? 1 : 0), entry);
+            }
+            if (i >= model.segments) continue;
+            for (int s = 0; s < perSegment; s++) {
+                out.push_back(valueAt((i + static_cast<double>(s) / perSegment) / model.segments));
+            }
+        }
+        out.push_back(model.isLooped ? out.front() : valueAt(1.0));
+        return out;
+    }
+    
+private:
+    static double pitch(const TrackFrame& f) {
+        return std::asin(std::max(-1.0, std::min(1.0, f.tangent.y)));
+    }
+    
+    template <typename Value>
+    static std::vector<float> simplified(const TrackModel& model, double pxPerMeter, double pxPerUnitY,
+                                         double tolerancePx, Value value) {
+        const std::vector<TrackFrame>& frames = model.frames;
+        std::vector<double> xs(frames.size()), ys(frames.size());
+        for (size_t i = 0; i < frames.size(); i++) {
+            xs[i] = frames[i].arcLength * pxPerMeter;
+            ys[i] = value(frames[i]) * pxPerUnitY;
+        }
+        
+        std::vector<uint32_t> kept = simplifyPolyline(xs, ys, std::max(0.0, tolerancePx));
+        std::vector<float> out;
+        out.reserve(kept.size() * 2);
+        for (uint32_t i : kept) {
+            out.push_back(static_cast<float>(frames[i].arcLength));
+            out.push_back(static_cast<float>(value(frames[i])));
+        }
+        return out;
+    }
+};
+
+// ============================================================================
+// Physics Engine
+// ============================================================================
+
+class PhysicsEngine {
+private:
+    std::shared_ptr<const TrackModel> model;
+    std::shared_ptr<TrackBuildChannel> buildChannel;
+    std::unique_ptr<TrackModelBuilder> pendingBuild;  // sliced builds only
+#if PHYSICS_HAS_THREADS
+    std::unique_ptr<TrackBuildWorker> buildWorker;    // started by the first beginTrackBuild()
+#endif
+    PhysicsState state;                 // owned by the stepping thread
+    SeqLock<PhysicsState> published;    // tear-free copy for readers on any thread
+    
+    double simulationTime;
+    double deltaTime;
+    bool hasChainLift;
+    RideConditions conditions;
+    
+    // Force history for smoothing
+    std::vector<double> gForceHistory;
+    int gForceHistorySize = 10;
+    
+    // Memoized getTrackStats() result
+    TrackStats cachedStats;
+    uint32_t cachedStatsVersion = 0;
+    bool cachedStatsChainLift = false;
+    bool hasCachedStats = false;
+    
+    // Memoized getEnergyBudget() result
+    std::shared_ptr<const EnergyBudget> cachedBudget;
+    uint32_t cachedBudgetVersion = 0;
+    bool cachedBudgetChainLift = false;
+    
+    // Memoized getSpeedProfile() result; step() looks speed up in it
+    // while speedProfileStep > 0
+    std::shared_ptr<const SpeedProfile> cachedSpeedProfile;
+    uint32_t cachedSpeedProfileVersion = 0;
+    bool cachedSpeedProfileChainLift = false;
+    double speedProfileStep = 0;
+    size_t speedCursor = 0;
+    
+    // Memoized getRideTimeline() result
+    std::shared_ptr<const RideTimeline> cachedTimeline;
+    uint32_t cachedTimelineVersion = 0;
+    bool cachedTimelineChainLift = false;
+    
+    // Memoized getRideProfile() result
+    std::shared_ptr<const RideProfile> cachedRide;
+    uint32_t cachedRideVersion = 0;
+    bool cachedRideChainLift = false;
+    
+    // Last profile polylines handed to the 2D views
+    PolylineCache minimapOutline;
+    PolylineCache vertexAttribute;
+    PolylineCache elevationProfile;
+    PolylineCache bankingProfile;
+    PolylineCache curvatureComb;
+    
+    // Ride events and the last state the detector saw
+    EventRing events;
+    bool eventInLoop = false;
+    bool eventOnChainLift = false;
+    bool eventAirtime = false;
+    
+    // Audio control stream, allocated by the first setControlRate() above
+    // 0 or view request; headless engines never carry one
+    std::shared_ptr<ControlStream> controlStream;
+    double controlRate = 0;    // Hz
+    double controlPhase = 0;   // seconds since the last control frame
+    
+public:
+    PhysicsEngine() : model(std::make_shared<TrackModel>()),
+                      buildChannel(std::make_shared<TrackBuildChannel>()),
+                      simulationTime(0), deltaTime(1.0/60.0), 
+                      hasChainLift(false) {
+        reset();
+    }
+    
+    // Rides an already built model, e.g. for headless analysis runs that
+    // share the caller's precomputed tables
+    explicit PhysicsEngine(std::shared_ptr<const TrackModel> sharedModel)
+        : model(std::move(sharedModel)),
+          buildChannel(std::make_shared<TrackBuildChannel>()),
+          simulationTime(0), deltaTime(1.0/60.0),
+          hasChainLift(false) {
+        buildChannel->latestRequest = model->version;
+        reset();
+    }
+    
+    // Builds the track model synchronously and restarts the ride
+    void setTrack(const std::vector<TrackPointData>& points, bool isLooped) {
+        setTrackFromTables(points, isLooped, nullptr, 0);
+    }
+    
+    /**
+     * setTrack() that adopts tables saved by getTrackTables() instead of
+     * rebuilding, when they were built from exactly these points. Returns
+     * false, after building normally, if they weren't or don't validate.
+     */
+    bool setTrackFromTables(const std::vector<TrackPointData>& points, bool isLooped,
+                            const uint8_t* tables, size_t size) {
+        uint32_t version = ++buildChannel->latestRequest;
+        pendingBuild.reset();
+        
+        std::shared_ptr<TrackModel> restored =
+            tables ? TrackTables::decode(tables, size, points, isLooped) : nullptr;
+        bool warm = restored != nullptr;
+        if (warm) {
+            restored->version = version;
+            buildChannel->slot.publish(std::move(restored));
+        } else {
+            TrackModelBuilder builder(points, isLooped, version);
+            buildChannel->slot.publish(builder.finish());
+        }
+        adoptLatestModel();
+        
+        reset();
+        return warm;
+    }
+    
+    std::vector<uint8_t> getTrackTables() const { return TrackTables::encode(*model); }
+    
+    /**
+     * Starts building a track model without blocking. The engine keeps
+     * riding the current model until the new one is published, then swaps
+     * to it on the next step() or pumpTrackBuild(). A newer request
+     * supersedes any build still in flight.
+     */
+    void beginTrackBuild(const std::vector<TrackPointData>& points, bool isLooped) {
+        uint32_t version = ++buildChannel->latestRequest;
+        
+#if PHYSICS_HAS_THREADS
+        if (!buildWorker) buildWorker.reset(new TrackBuildWorker(buildChannel));
+        buildWorker->submit(points, isLooped, version);
+#else
+        pendingBuild.reset(new TrackModelBuilder(points, isLooped, version));
+#endif
+    }
+    
+    /**
+     * beginTrackBuild() that adopts tables saved by getTrackTables() at
+     * once when they were built from exactly these points. Returns false,
+     * with the background build started, if they weren't or don't validate.
+     */
+    bool beginTrackBuildFromTables(const std::vector<TrackPointData>& points, bool isLooped,
+                                   const uint8_t* tables, size_t size) {
+        std::shared_ptr<TrackModel> restored = TrackTables::decode(tables, size, points, isLooped);
+        if (!restored) {
+            beginTrackBuild(points, isLooped);
+            return false;
+        }
+        
+        restored->version = ++buildChannel->latestRequest;
+        pendingBuild.reset();
+        buildChannel->slot.publish(std::move(restored));
+        adoptLatestModel();
+        return true;
+    }
+    
+    // Advances a sliced build by up to budgetMs and adopts any finished
+    // model. Returns true when no build is outstanding.
+    bool pumpTrackBuild(double budgetMs) {
+        if (pendingBuild && pendingBuild->advanceFor(budgetMs)) {
+            buildChannel->slot.publish(pendingBuild->finish());
+            pendingBuild.reset();
+        }
+        adoptLatestModel();
+        return !isTrackBuildPending();
+    }
+    
+    bool isTrackBuildPending() const {
+        return buildChannel->latestRequest.load(std::memory_order_relaxed) != model->version;
+    }
+    
+    uint32_t getTrackVersion() const { return model->version; }
+    std::shared_ptr<const TrackModel> getTrackModel() const { return model; }
+    
+    // Exact statistics for the current model, memoized per model version
+    // and chain-lift setting (defined after TrackAnalyzer)
+    TrackStats getTrackStats();
+    
+    // One headless lap sampled at rateHz, for replays and trajectory
+    // encoding (defined after TrackAnalyzer)
+    std::vector<TrajectorySample> recordRide(double rateHz) const;
+    
+    // Stall and G-limit odds per section over many rides with varied
+    // load, friction and wind (defined after MonteCarloRides)
+    RobustnessReport simulateRobustness(const RobustnessOptions& options) const;
+    
+    // Profile polylines for the 2D views (see TrackProfiles), rebuilt only
+    // when the track or the requested scale changes
+    const std::vector<float>& getElevationProfile(double pxPerMeter, double pxPerMeterY, double tolerancePx) {
+        return elevationProfile.get(model->version, pxPerMeter, pxPerMeterY, tolerancePx, [&]() {
+            return TrackProfiles::elevation(*model, pxPerMeter, pxPerMeterY, tolerancePx);
+        });
+    }
+    
+    const std::vector<float>& getBankingProfile(double pxPerMeter, double pxPerDegree, double tolerancePx) {
+        return bankingProfile.get(model->version, pxPerMeter, pxPerDegree, tolerancePx, [&]() {
+            return TrackProfiles::banking(*model, pxPerMeter, pxPerDegree, tolerancePx);
+        });
+    }
+    
+    // Speed and G at every frame from one headless run, memoized like
+    // getTrackStats() (defined after TrackAnalyzer)
+    std::shared_ptr<const RideProfile> getRideProfile();
+    
+    // Drag/friction losses per control-point span and clearance margins,
+    // memoized like getTrackStats() (defined after TrackAnalyzer)
+    std::shared_ptr<const EnergyBudget> getEnergyBudget();
+    std::vector<EnergySection> getEnergySections() { return getEnergyBudget()->sections; }
+    bool canClearSection(int k, double entrySpeed) { return getEnergyBudget()->canClearSection(k, entrySpeed); }
+    double getClearanceMargin(int k, double entrySpeed) { return getEnergyBudget()->clearanceMargin(k, entrySpeed); }
+    int getFirstStallSection(int from, double startSpeed) {
+        return getEnergyBudget()->firstStallSection(from, startSpeed);
+    }
+    
+    // Speed versus position from one reference run at `referenceStep`
+    // seconds, memoized per model version, chain lift and step (defined
+    // after TrackAnalyzer)
+    std::shared_ptr<const SpeedProfile> getSpeedProfile(double referenceStep);
+    
+    // Steps look the ride state up in the profile instead of integrating
+    // forces wherever laps repeat (see activeSpeedProfile()); 0 returns to
+    // the integrator. Stepping at referenceStep matches it exactly.
+    void setSpeedProfileStep(double referenceStep) {
+        speedProfileStep = std::max(0.0, referenceStep);
+        speedCursor = 0;
+    }
+    
+    double getSpeedProfileStep() const { return speedProfileStep; }
+    
+    double getSpeedAtProgress(double p) {
+        size_t cursor = 0;
+        return getSpeedProfile(speedProfileStep > 0 ? speedProfileStep : 1.0 / 60.0)->speedAt(p, cursor);
+    }
+    
+    double getSpeedAtDistance(double meters) {
+        return model->totalLength > 0 ? getSpeedAtProgress(meters / model->totalLength) : 0;
+    }
+    
+    // One lap recorded for seeking, memoized like getTrackStats()
+    // (defined after TrackAnalyzer)
+    std::shared_ptr<const RideTimeline> getRideTimeline();
+    double getRideDuration() { return getRideTimeline()->duration(); }
+    
+    /**
+     * Puts the train where the reference lap is `time` seconds after the
+     * station: speed, G smoothing window, chain/loop/airtime flags and the
+     * simulation clock all match what stepping there would have produced.
+     * Lands on the recorded step at or before `time` and steps the rest.
+     * Queues an EVENT_SEEK so event consumers can drop stale state; no
+     * transition events fire for the jump itself.
+     */
+    bool seekToTime(double time) {
+        std::shared_ptr<const RideTimeline> timeline = getRideTimeline();
+        if (timeline->entries.empty()) return false;
+        
+        time = std::max(0.0, std::min(time, timeline->duration()));
+        size_t k = std::min(timeline->entries.size() - 1,
+                            static_cast<size_t>(time / timeline->step + 1e-9));
+        restoreTimelineEntry(*timeline, k);
+        emitEvent(EVENT_SEEK, state.progress, time);
+        
+        double remaining = time - k * timeline->step;
+        if (remaining > 1e-9) step(remaining);
+        published.write(state);
+        return true;
+    }
+    
+    // Seeks to the first time the train reaches `meters` along the track
+    bool seekToDistance(double meters) {
+        if (model->totalLength <= 0) return false;
+        return seekToTime(getRideTimeline()->timeAtProgress(meters / model->totalLength));
+    }
+    
+    // Top-down outline with height and ride speed per vertex
+    const std::vector<float>& getMinimapPolyline(double toleranceMeters) {
+        std::shared_ptr<const RideProfile> ride = getRideProfile();
+        return minimapOutline.get(model->version, toleranceMeters, hasChainLift ? 1 : 0, 0, [&]() {
+            return TrackProfiles::minimap(*model, *ride, toleranceMeters);
+        });
+    }
+    
+    // Per-vertex coloring channel from the ride profile (see VertexAttribute)
+    const std::vector<float>& getVertexAttribute(int attribute, int samplesPerSegment) {
+        std::shared_ptr<const RideProfile> ride = getRideProfile();
+        return vertexAttribute.get(model->version, attribute, samplesPerSegment, hasChainLift ? 1 : 0, [&]() {
+            return TrackProfiles::vertexAttribute(*model, *ride, attribute, samplesPerSegment);
+        });
+    }
+    
+    const std::vector<float>& getCurvatureComb(double pxPerMeter, double spacingPx) {
+        return curvatureComb.get(model->version, pxPerMeter, spacingPx, 0, [&]() {
+            return TrackProfiles::curvatureComb(*model, pxPerMeter, spacingPx);
+        });
+    }
+    double getTrackLength() const { return model->totalLength; }
+    
+    // Lazily built frame chunks (see LazyChunks): total and built so far
+    unsigned getFrameChunkCount() const { return model->lazyFrames.chunkCount(); }
+    unsigned getBuiltFrameChunkCount() const { return model->lazyFrames.builtCount(); }
+    
+    // Recognized elements along the spline (see ElementRecognizer)
+    std::vector<TrackFeature> getTrackFeatures() const { return model->features; }
+    
+    // Geometry checks from the model plus the stall prediction for the
+    // current chain-lift setting
+    std::vector<ValidationResult> getValidation() const {
+        std::vector<ValidationResult> results = model->validation;
+        StallAnalyzer::appendValidation(predictStall(STATION_SPEED), results);
+        return results;
+    }
+    
+    // Similarity search key: element counts, ride scalars and shape
+    // signatures (defined after TrackDescriptor)
+    std::vector<float> getTrackDescriptor();
+    
+    // Canonical key for caching analysis of this track and chain-lift
+    // setting (defined after TrackFingerprint)
+    std::string getTrackFingerprint() const;
+    
+    // Where (and whether) a train leaving the station at startSpeed stalls,
+    // and how the rollback ends; microseconds, no simulation
+    StallPrediction predictStall(double startSpeed) const {
+        return StallAnalyzer::predict(*model, hasChainLift, startSpeed);
+    }
+    
+    void setChainLift(bool enabled) {
+        hasChainLift = enabled;
+    }
+    
+    // Load, friction and wind for this engine's rides: stepping, the speed
+    // profile, seeking and the stats and ride profile all follow them.
+    // Stall prediction, the energy budget and fingerprints stay nominal.
+    void setRideConditions(const RideConditions& c) {
+        if (c == conditions) return;
+        conditions = c;
+        
+        // Everything recorded from a headless ride described the old ones
+        hasCachedStats = false;
+        cachedSpeedProfile.reset();
+        cachedTimeline.reset();
+        cachedRide.reset();
+        minimapOutline.valid = false;
+        vertexAttribute.valid = false;
+        speedCursor = 0;
+    }
+    RideConditions getRideConditions() const { return conditions; }
+    
+    void reset() {
+        state.position = model->spline.getPointRaw(0);
+        state.velocity = Vec3(0, 0, 0);
+        state.acceleration = Vec3(0, 0, 0);
+        state.speed = STATION_SPEED;
+        state.gForceVertical = 1.0;
+        state.gForceLateral = 0.0;
+        state.gForceTotal = 1.0;
+        state.progress = 0;
+        state.height = state.position.y;
+        state.isOnChainLift = hasChainLift;
+        state.isInLoop = false;
+        state.bankAngle = 0;
+        
+        simulationTime = 0;
+        gForceHistory.clear();
+        
+        eventInLoop = state.isInLoop;
+        eventOnChainLift = state.isOnChainLift;
+        eventAirtime = false;
+        
+        published.write(state);
+    }
+    
+    PhysicsState step(double dt) {
+        adoptLatestModel();
+        if (model->points.size() < 2) return state;
+        
+        deltaTime = dt;
+        simulationTime += dt;
+        
+        const SpeedProfile* profile = activeSpeedProfile();
+        if (profile && profile->covers(state.progress)) return stepFromProfile(*profile, dt);
+        
+        float controlFrom[CONTROL_CHANNEL_COUNT] = {};
+        if (controlRate > 0) captureControlFrame(controlFrom);
+        
+        // Get track sample at current position
+        TrackSample sample = sampleTrack(state.progress);
+        
+        // Calculate physics forces
+        Vec3 gravity(0, -GRAVITY, 0);
+        
+        // Project gravity onto track direction
+        double gravityAlongTrack = gravity.dot(sample.tangent);
+        
+        // Check if on chain lift section
+        state.isOnChainLift = hasChainLift && state.progress < model->firstPeakProgress;
+        
+        // Calculate speed
+        if (state.isOnChainLift) {
+            // Chain lift: constant speed upward
+            state.speed = CHAIN_LIFT_SPEED;
+        } else {
+            // Physics-based speed calculation. Speed is signed (negative
+            // rolls back) and drag and friction oppose the motion.
+            double v = state.speed;
+            double frictionForce = ROLLING_FRICTION * conditions.frictionScale * GRAVITY;
+            
+            // Drag acts on speed through the air: wind along the track
+            // moves the air with or against the train
+            double air = v - (conditions.windX * sample.tangent.x + conditions.windZ * sample.tangent.z);
+            
+            // gravityAlongTrack is positive going downhill
+            double netAcceleration = gravityAlongTrack - AIR_RESISTANCE * conditions.dragScale * air * std::abs(air);
+            
+            if (v != 0) {
+                netAcceleration -= std::copysign(frictionForce, v);
+            } else if (std::abs(netAcceleration) <= frictionForce) {
+                netAcceleration = 0;  // at rest and gravity cannot overcome friction
+            } else {
+                netAcceleration -= std::copysign(frictionForce, netAcceleration);
+            }
+            
+            double next = v + netAcceleration * dt;
+            
+            // Friction can stop the train but never reverse it
+            if (v != 0 && (next > 0) != (v > 0) && std::abs(gravityAlongTrack) <= frictionForce) next = 0;
+            state.speed = next;
+        }
+        
+        // Calculate G-forces
+        calculateGForces(sample, dt);
+        
+        // Update position along track
+        advanceProgress(state.speed * dt);
+        
+        // Update state position and vectors
+        sample = sampleTrack(state.progress);
+        state.position = sample.point;
+        state.velocity = sample.tangent * state.speed;
+        state.height = sample.point.y;
+        state.bankAngle = sample.tilt;
+        state.isInLoop = sample.inLoop;
+        
+        detectEvents();
+        emitControlFrames(controlFrom, sample.curvature, dt);
+        
+        published.write(state);
+        return state;
+    }
+    
+    /**
+     * step() while a profile is active: speed and G come from the nodes
+     * around the train and its new position from the nodes around where it
+     * lands, so a step is two cursor lookups and ds/dt with no track
+     * sampling or force math. Events and control frames still see every
+     * step.
+     */
+    PhysicsState stepFromProfile(const SpeedProfile& profile, double dt) {
+        double t;
+        size_t i = profile.bracket(state.progress, speedCursor, t);
+        
+        float controlFrom[CONTROL_CHANNEL_COUNT] = {};
+        if (controlRate > 0) captureControlFrame(controlFrom, SpeedProfile::lerp(profile.curvature, i, t));
+        
+        state.isOnChainLift = hasChainLift && state.progress < model->firstPeakProgress;
+        state.speed = SpeedProfile::lerp(profile.speed, i, t);
+        state.gForceVertical = SpeedProfile::lerp(profile.gVertical, i, t);
+        state.gForceLateral = SpeedProfile::lerp(profile.gLateral, i, t);
+        state.gForceTotal = SpeedProfile::lerp(profile.gTotal, i, t);
+        
+        // Keeps the smoothing window right for when integration resumes
+        gForceHistory.push_back(SpeedProfile::lerp(profile.gRaw, i, t));
+        if (gForceHistory.size() > static_cast<size_t>(gForceHistorySize)) {
+            gForceHistory.erase(gForceHistory.begin());
+        }
+        
+        advanceProgress(state.speed * dt);
+        
+        i = profile.bracket(state.progress, speedCursor, t);
+        Vec3 tangent = t > 0 ? SpeedProfile::lerp(profile.tangent, i, t).normalized() : profile.tangent[i];
+        state.position = SpeedProfile::lerp(profile.point, i, t);
+        state.velocity = tangent * state.speed;
+        state.height = state.position.y;
+        state.bankAngle = SpeedProfile::lerp(profile.tilt, i, t);
+        state.isInLoop = profile.inLoop[t < 0.5 ? i : i + 1] != 0;
+        
+        detectEvents();
+        emitControlFrames(controlFrom, SpeedProfile::lerp(profile.curvature, i, t), dt);
+        
+        published.write(state);
+        return state;
+    }
+    
+    // Moves the train `distance` meters along the track, wrapping looped
+    // tracks and restarting open ones at the station
+    void advanceProgress(double distance) {
+        double trackLength = model->totalLength;
+        if (trackLength <= 0) return;
+        
+        state.progress += distance / trackLength;
+        
+        // Handle looping or stopping
+        if (model->isLooped) {
+            if (state.progress >= 1.0) emitEvent(EVENT_STATION_CROSSED, 1.0, state.speed);
+            while (state.progress >= 1.0) state.progress -= 1.0;
+            while (state.progress < 0) state.progress += 1.0;
+        } else {
+            if (state.progress >= 1.0) {
+                emitEvent(EVENT_STATION_CROSSED, 1.0, state.speed);
+                state.progress = 0;  // Restart
+                reset();
+            } else if (state.progress < 0) {
+                // Rolled back into the station buffers
+                state.progress = 0;
+                state.speed = 0;
+            }
+        }
+    }
+    
+    void restoreTimelineEntry(const RideTimeline& timeline, size_t k) {
+        const RideTimelineEntry& e = timeline.entries[k];
+        TrackSample sample = sampleTrack(e.progress);
+        
+        state.progress = e.progress;
+        state.speed = e.speed;
+        state.position = sample.point;
+        state.velocity = sample.tangent * e.speed;
+        state.height = sample.point.y;
+        state.bankAngle = sample.tilt;
+        state.isOnChainLift = (e.flags & TIMELINE_CHAIN_LIFT) != 0;
+        state.isInLoop = (e.flags & TIMELINE_IN_LOOP) != 0;
+        state.gForceVertical = e.gForceVertical;
+        state.gForceLateral = e.gForceLateral;
+        state.gForceTotal = e.gForceTotal;
+        
+        // The smoothing window holds the raw totals of the last steps;
+        // entry 0 is the reset state, which has none
+        gForceHistory.clear();
+        size_t first = k >= static_cast<size_t>(gForceHistorySize) ? k - gForceHistorySize + 1 : 1;
+        for (size_t j = first; j <= k; j++) gForceHistory.push_back(timeline.entries[j].gForceRaw);
+        
+        simulationTime = k * timeline.step;
+        eventInLoop = state.isInLoop;
+        eventOnChainLift = state.isOnChainLift;
+        eventAirtime = (e.flags & TIMELINE_AIRTIME) != 0;
+        speedCursor = 0;
+        controlPhase = 0;
+    }
+    
+    // Unsmoothed total G of the last step, as pushed into the history
+    double getRawGForceTotal() const { return gForceHistory.empty() ? state.gForceTotal : gForceHistory.back(); }
+    bool getEventAirtime() const { return eventAirtime; }
+    
+    // Profile step() should read the state from, or null to integrate.
+    // Only while every lap repeats the reference lap: open tracks restart
+    // from the station, and a chain lift resets a looped train's speed.
+    const SpeedProfile* activeSpeedProfile() {
+        if (speedProfileStep <= 0 || (model->isLooped && !hasChainLift)) return nullptr;
+        const SpeedProfile* profile = getSpeedProfile(speedProfileStep).get();
+        return profile->completed ? profile : nullptr;
+    }
+    
+    // Sets the audio control rate in Hz; 0 disables the control stream
+    void setControlRate(double hz) {
+        controlRate = std::max(0.0, hz);
+        controlPhase = 0;
+        if (controlRate > 0) ensureControlStream();
+    }
+    
+    // Hands the engine a stream allocated elsewhere, e.g. by SimulationHost
+    // on the caller's thread so its views exist before the first frame
+    void attachControlStream(std::shared_ptr<ControlStream> stream) {
+        controlStream = std::move(stream);
+    }
+    
+    ControlStream& ensureControlStream() {
+        if (!controlStream) controlStream = std::make_shared<ControlStream>();
+        return *controlStream;
+    }
+    
+    void captureControlFrame(float* frame, double curvature = -1) const {
+        if (curvature < 0) curvature = model->frameAt(state.progress).curvature;
+        frame[CONTROL_SPEED] = static_cast<float>(state.speed);
+        frame[CONTROL_G_VERTICAL] = static_cast<float>(state.gForceVertical);
+        frame[CONTROL_G_LATERAL] = static_cast<float>(state.gForceLateral);
+        frame[CONTROL_CHAIN_LIFT] = state.isOnChainLift ? 1.0f : 0.0f;
+        frame[CONTROL_WHEEL_NOISE] = static_cast<float>(wheelNoiseIntensity(state.speed, curvature));
+    }
+    
+    // Emits every control frame that falls inside the step just taken,
+    // linearly interpolated between the states at its start and end, so the
+    // stream stays uniform however irregular the step sizes are
+    void emitControlFrames(const float* from, double curvature, double dt) {
+        if (controlRate <= 0 || dt <= 0 || !controlStream) return;
+        
+        float to[CONTROL_CHANNEL_COUNT];
+        captureControlFrame(to, curvature);
+        
+        double interval = 1.0 / controlRate;
+        controlPhase += dt;
+        
+        while (controlPhase >= interval) {
+            controlPhase -= interval;
+            float alpha = static_cast<float>(1.0 - controlPhase / dt);
+            
+            float frame[CONTROL_CHANNEL_COUNT];
+            for (uint32_t c = 0; c < CONTROL_CHANNEL_COUNT; c++) {
+                frame[c] = from[c] + (to[c] - from[c]) * alpha;
+            }
+            controlStream->push(frame);
+        }
+    }
+    
+    uint32_t getControlHead() const { return controlStream ? controlStream->getHead() : 0; }
+    uint32_t getControlCapacity() const { return ControlStream::CAPACITY; }
+    uint32_t getControlChannels() const { return CONTROL_CHANNEL_COUNT; }
+    const ControlStream& getControlStream() { return ensureControlStream(); }
+    
+    // Compares the new state with what the detector last saw and queues an
+    // event for every transition
+    void detectEvents() {
+        if (state.isInLoop != eventInLoop) {
+            eventInLoop = state.isInLoop;
+            emitEvent(eventInLoop ? EVENT_LOOP_ENTER : EVENT_LOOP_EXIT, state.progress, state.speed);
+        }
+        
+        if (state.isOnChainLift != eventOnChainLift) {
+            eventOnChainLift = state.isOnChainLift;
+            emitEvent(eventOnChainLift ? EVENT_CHAIN_LIFT_ENGAGE : EVENT_CHAIN_LIFT_RELEASE,
+                      state.progress, state.speed);
+        }
+        
+        if (!eventAirtime && state.gForceVertical < AIRTIME_ENTER_G) {
+            eventAirtime = true;
+            emitEvent(EVENT_AIRTIME_START, state.progress, state.gForceVertical);
+        } else if (eventAirtime && state.gForceVertical > AIRTIME_EXIT_G) {
+            eventAirtime = false;
+            emitEvent(EVENT_AIRTIME_END, state.progress, state.gForceVertical);
+        }
+    }
+    
+    void emitEvent(RideEventType type, double progress, double value) {
+        events.push({type, simulationTime, model->frameAt(progress).arcLength, progress, value});
+    }
+    
+    // Returns all events queued since the last drain. Call once per frame;
+    // safe from a different thread than the one stepping.
+    std::vector<RideEvent> drainEvents() { return events.drain(); }
+    uint32_t getDroppedEventCount() const { return events.getDroppedCount(); }
+    
+    void calculateGForces(const TrackSample& sample, double dt) {
+        // Centripetal acceleration (v²/r)
+        double centripetalAccel = 0;
+        if (sample.curvature > 1e-6) {
+            double radius = 1.0 / sample.curvature;
+            centripetalAccel = (state.speed * state.speed) / radius;
+        }
+        
+        // Vertical G-force: normal force needed to keep on track
+        // G = 1 + (centripetal_accel_vertical_component / g)
+        double gradeRad = std::atan(sample.grade / 100.0);
+        double vertComponent = std::cos(gradeRad) * centripetalAccel;
+        
+        state.gForceVertical = 1.0 + vertComponent / GRAVITY;
+        
+        // Add effect of going up/down hills
+        state.gForceVertical += std::sin(gradeRad) * (state.speed * state.speed) / (GRAVITY * 10);
+        
+        // Lateral G-force from banking
+        state.gForceLateral = std::sin(sample.tilt) * centripetalAccel / GRAVITY;
+        
+        // Total G-force magnitude
+        state.gForceTotal = std::sqrt(
+            state.gForceVertical * state.gForceVertical + 
+            state.gForceLateral * state.gForceLateral
+        );
+        
+        // Smooth G-forces
+        gForceHistory.push_back(state.gForceTotal);
+        if (gForceHistory.size() > gForceHistorySize) {
+            gForceHistory.erase(gForceHistory.begin());
+        }
+        
+        double smoothedG = 0;
+        for (double g : gForceHistory) smoothedG += g;
+        state.gForceTotal = smoothedG / gForceHistory.size();
+    }
+    
+    TrackSample sampleTrack(double progress) {
+        TrackSample sample;
+        
+        progress = std::max(0.0, std::min(0.9999, progress));
+        
+        TrackFrame frame = model->frameAt(progress);
+        sample.point = frame.point;
+        sample.tangent = frame.tangent;
+        sample.curvature = frame.curvature;
+        
+        // Calculate up vector (perpendicular to tangent, toward world up)
+        Vec3 worldUp(0, 1, 0);
+        Vec3 right = sample.tangent.cross(worldUp).normalized();
+        sample.up = right.cross(sample.tangent).normalized();
+        sample.right = right;
+        
+        // Tilt is interpolated from track points when the model is built
+        sample.tilt = frame.tilt;
+        
+        // Apply tilt rotation to up/right vectors
+        if (std::abs(sample.tilt) > 0.001) {
+            double c = std::cos(sample.tilt);
+            double s = std::sin(sample.tilt);
+            Vec3 newUp = sample.up * c + sample.right * s;
+            Vec3 newRight = sample.right * c - sample.up * s;
+            sample.up = newUp;
+            sample.right = newRight;
+        }
+        
+        // Calculate grade (slope percentage)
+        sample.grade = sample.tangent.y * 100.0;
+        
+        // Check if in loop
+        sample.inLoop = model->isInLoop(progress);
+        
+        return sample;
+    }
+    
+    // Swaps to the newest published model, if any. The ride continues from
+    // the same progress on the new geometry rather than restarting.
+    void adoptLatestModel() {
+        if (buildChannel->slot.getPublishedVersion() <= model->version) return;
+        
+        std::shared_ptr<const TrackModel> latest = buildChannel->slot.acquire();
+        if (!latest || latest->version <= model->version) return;
+        
+        model = std::move(latest);
+        state.progress = std::max(0.0, std::min(state.progress, 0.9999));
+        gForceHistory.clear();
+    }
+    
+    const PhysicsState& getState() const { return state; }
+    
+    // Consistent copy of the last published state; safe from any thread
+    // while another thread is stepping
+    PhysicsState readSnapshot() const { return published.read(); }
+    uint32_t getSnapshotVersion() const { return published.getVersion(); }
+    
+    // Getters for JS access
+    double getSpeed() const { return state.speed; }
+    double getGForceVertical() const { return state.gForceVertical; }
+    double getGForceLateral() const { return state.gForceLateral; }
+    double getGForceTotal() const { return state.gForceTotal; }
+    double getProgress() const { return state.progress; }
+    double getHeight() const { return state.height; }
+    bool getIsOnChainLift() const { return state.isOnChainLift; }
+    bool getIsInLoop() const { return state.isInLoop; }
+    double getPositionX() const { return state.position.x; }
+    double getPositionY() const { return state.position.y; }
+    double getPositionZ() const { return state.position.z; }
+    double getVelocityX() const { return state.velocity.x; }
+    double getVelocityY() const { return state.velocity.y; }
+    double getVelocityZ() const { return state.velocity.z; }
+    
+    void setProgress(double p) { state.progress = p; published.write(state); }
+    void setSpeed(double s) { state.speed = s; published.write(state); }
+};
+
+// ============================================================================
+// Track Analyzer
+// ============================================================================
+
+class TrackAnalyzer {
+public:
+    static constexpr double RIDE_TIME_STEP = 1.0 / 60.0;   // seconds
+    static constexpr double RIDE_TIME_LIMIT = 600.0;       // seconds
+    
+    // A lap ends when progress jumps back by more than half the track (a
+    // wrap or an open-track restart); rolling back moves it a step at a time
+    static bool lapFinished(double previousProgress, double progress) {
+        return progress < previousProgress - 0.5;
+    }
+    
+    // step() only holds speed at exactly zero while gravity cannot
+    // overcome friction, so two such steps in a row mean the train is stuck
+    static bool stuck(double previousSpeed, double speed) {
+        return previousSpeed == 0 && speed == 0;
+    }
+    
+    // Geometry in one pass over the model's frame table, plus one headless
+    // run for timing
+    static TrackStats computeStats(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                                   const RideConditions& conditions) {
+        TrackStats stats = computeGeometryStats(*model);
+        if (model->points.size() >= 2) {
+            simulateRide(model, chainLift, conditions, stats);
+        }
+        return stats;
+    }
+    
+    static TrackStats computeGeometryStats(const TrackModel& model) {
+        TrackStats stats = {};
+        if (model.frames.empty()) return stats;
+        
+        const double toDegrees = 180.0 / M_PI;
+        stats.minHeight = model.frames[0].point.y;
+        stats.maxHeight = model.frames[0].point.y;
+        
+        for (const TrackFrame& f : model.frames) {
+            stats.minHeight = std::min(stats.minHeight, f.point.y);
+            stats.maxHeight = std::max(stats.maxHeight, f.point.y);
+            
+            double grade = std::asin(std::max(-1.0, std::min(1.0, f.tangent.y))) * toDegrees;
+            stats.maxGrade = std::max(stats.maxGrade, std::abs(grade));
+            stats.maxBank = std::max(stats.maxBank, std::abs(f.tilt) * toDegrees);
+        }
+        
+        // Inversions on the spline are sustained stretches banked past
+        // 90 degrees; see ElementRecognizer::invertedFrames
+        for (const TrackFeature& feature : model.features) {
+            if (feature.kind == FEATURE_INVERSION) stats.inversions++;
+        }
+        
+        // Inline elements leave the spline: their tops and climbs count
+        // toward height and grade
+        for (size_t i = 0; i < model.points.size(); i++) {
+            const TrackPointData& p = model.points[i];
+            if (!p.hasLoop) continue;
+            stats.elements++;
+            stats.inversions++;
+            stats.elementLength += elementArcLength(p.loopRadius, p.loopPitch);
+            
+            TrackFrame entry = model.frameAt(elementEntry(model, i));
+            double height = entry.point.y;
+            walkElement(p.loopRadius, p.loopPitch, entry.tangent, [&](double rise, double ds) {
+                height += rise;
+                stats.minHeight = std::min(stats.minHeight, height);
+                stats.maxHeight = std::max(stats.maxHeight, height);
+                if (ds > 0) {
+                    double grade = std::asin(std::min(1.0, std::abs(rise) / ds)) * toDegrees;
+                    stats.maxGrade = std::max(stats.maxGrade, grade);
+                }
+            });
+        }
+        
+        stats.totalLength = model.totalLength + stats.elementLength;
+        return stats;
+    }
+    
+    // Progress where the inline element at point i begins, as loopZones()
+    // places it
+    static double elementEntry(const TrackModel& model, size_t i) {
+        return model.segments > 0 ? std::min(1.0, static_cast<double>(i) / model.segments) : 0.0;
+    }
+    
+    /**
+     * Seconds to ride an inline element entered at `speed`, under the same
+     * gravity, rolling friction and drag as the engine. Negative if the
+     * train runs out of speed inside it.
+     */
+    static double elementTime(const TrackPointData& p, const Vec3& entryTangent, double speed) {
+        double kinetic = 0.5 * speed * speed;   // per unit mass
+        double time = 0;
+        bool stalled = false;
+        walkElement(p.loopRadius, p.loopPitch, entryTangent, [&](double rise, double ds) {
+            if (stalled) return;
+            double next = kinetic - GRAVITY * (rise + ROLLING_FRICTION * ds) -
+                          2.0 * AIR_RESISTANCE * kinetic * ds;
+            if (next <= 0) {
+                stalled = true;
+                return;
+            }
+            time += ds / (0.5 * (std::sqrt(2.0 * kinetic) + std::sqrt(2.0 * next)));
+            kinetic = next;
+        });
+        return stalled ? -1.0 : time;
+    }
+    
+    // Same run as simulateRide(), keeping every step
+    static std::vector<TrajectorySample> recordRide(const std::shared_ptr<const TrackModel>& model,
+                                                    bool chainLift, const RideConditions& conditions,
+                                                    double rateHz) {
+        std::vector<TrajectorySample> samples;
+        if (model->points.size() < 2) return samples;
+        
+        const double dt = 1.0 / std::max(1.0, rateHz);
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.setRideConditions(conditions);
+        engine.reset();
+        
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / dt);
+        samples.reserve(std::min(maxSteps, 1 << 16) + 1);
+        samples.push_back(toTrajectorySample(engine, engine.getState(), 0));
+        double previousProgress = 0;
+        double previousSpeed = engine.getState().speed;
+        
+        for (int i = 1; i <= maxSteps; i++) {
+            PhysicsState s = engine.step(dt);
+            if (lapFinished(previousProgress, s.progress)) break;
+            samples.push_back(toTrajectorySample(engine, s, i * dt));
+            if (stuck(previousSpeed, s.speed)) break;
+            previousProgress = s.progress;
+            previousSpeed = s.speed;
+        }
+        
+        return samples;
+    }
+    
+    // Runs the ride once and resamples speed and G onto the frame table.
+    // Engine progress indexes frames directly, so each frame takes the
+    // values interpolated between the two steps that straddle it.
+    static RideProfile profileRide(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                                   const RideConditions& conditions) {
+        RideProfile ride;
+        const size_t n = model->frames.size();
+        ride.time.assign(n, 0.0f);
+        ride.speed.assign(n, 0.0f);
+        ride.gVertical.assign(n, 0.0f);
+        ride.gLateral.assign(n, 0.0f);
+        ride.gTotal.assign(n, 0.0f);
+        if (model->points.size() < 2 || n < 2) return ride;
+        
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.setRideConditions(conditions);
+        engine.reset();
+        
+        struct Step { double time, progress, speed, gVertical, gLateral, gTotal; };
+        auto toStep = [](const PhysicsState& s, double time) {
+            return Step{ time, s.progress, s.speed, s.gForceVertical, s.gForceLateral, s.gForceTotal };
+        };
+        
+        Step previous = toStep(engine.getState(), 0);
+        size_t next = 0;
+        auto fill = [&](const Step& a, const Step& b) {
+            while (next < n) {
+                double target = static_cast<double>(next) / (n - 1);
+                if (target > b.progress) break;
+                double span = b.progress - a.progress;
+                double t = span > 1e-12 ? std::max(0.0, (target - a.progress) / span) : 1.0;
+                ride.time[next] = static_cast<float>(a.time + (b.time - a.time) * t);
+                ride.speed[next] = static_cast<float>(a.speed + (b.speed - a.speed) * t);
+                ride.gVertical[next] = static_cast<float>(a.gVertical + (b.gVertical - a.gVertical) * t);
+                ride.gLateral[next] = static_cast<float>(a.gLateral + (b.gLateral - a.gLateral) * t);
+                ride.gTotal[next] = static_cast<float>(a.gTotal + (b.gTotal - a.gTotal) * t);
+                next++;
+            }
+        };
+        fill(previous, previous);
+        
+        const double dt = RIDE_TIME_STEP;
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / dt);
+        for (int i = 1; i <= maxSteps && next < n; i++) {
+            Step current = toStep(engine.step(dt), i * dt);
+            
+            if (stuck(previous.speed, current.speed)) break;
+            
+            // Wrapped or restarted: this step finished the lap
+            if (lapFinished(previous.progress, current.progress)) {
+                current.progress = 1.0;
+                fill(previous, current);
+                ride.completed = true;
+                break;
+            }
+            
+            fill(previous, current);
+            previous = current;
+        }
+        
+        ride.reachedFrames = static_cast<uint32_t>(next);
+        ride.completed = ride.completed || next == n;
+        return ride;
+    }
+    
+    // One lap at RIDE_TIME_STEP keeping the full post-step state
+    static RideTimeline rideTimeline(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                                     const RideConditions& conditions) {
+        RideTimeline timeline;
+        timeline.step = RIDE_TIME_STEP;
+        if (model->points.size() < 2) return timeline;
+        
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.setRideConditions(conditions);
+        engine.reset();
+        
+        auto record = [&](const PhysicsEngine& e) {
+            const PhysicsState& s = e.getState();
+            uint8_t flags = (s.isOnChainLift ? TIMELINE_CHAIN_LIFT : 0) | (s.isInLoop ? TIMELINE_IN_LOOP : 0) |
+                            (e.getEventAirtime() ? TIMELINE_AIRTIME : 0);
+            timeline.entries.push_back({ s.progress, s.speed, e.getRawGForceTotal(),
+                static_cast<float>(s.gForceVertical), static_cast<float>(s.gForceLateral),
+                static_cast<float>(s.gForceTotal), flags });
+            double furthest = timeline.reach.empty() ? s.progress : std::max(timeline.reach.back(), s.progress);
+            timeline.reach.push_back(furthest);
+        };
+        record(engine);
+        
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / RIDE_TIME_STEP);
+        timeline.entries.reserve(std::min(maxSteps, 1 << 16) + 1);
+        double previousProgress = 0;
+        double previousSpeed = engine.getState().speed;
+        for (int i = 1; i <= maxSteps; i++) {
+            const PhysicsState& s = engine.step(RIDE_TIME_STEP);
+            if (lapFinished(previousProgress, s.progress)) {
+                timeline.completed = true;
+                break;
+            }
+            record(engine);
+            if (stuck(previousSpeed, s.speed)) break;
+            previousProgress = s.progress;
+            previousSpeed = s.speed;
+        }
+        return timeline;
+    }
+    
+    // One run at referenceStep keeping every SpeedProfile column per step.
+    // Stops short, incomplete, if the run stalls or turns back.
+    static SpeedProfile speedProfile(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                                     const RideConditions& conditions, double referenceStep) {
+        SpeedProfile profile;
+        profile.referenceStep = referenceStep;
+        if (model->points.size() < 2 || referenceStep <= 0) return profile;
+        
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.setRideConditions(conditions);
+        engine.reset();
+        
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / referenceStep);
+        double before = engine.getState().progress;
+        for (int i = 1; i <= maxSteps; i++) {
+            // The sample step() ends on when it reaches this progress
+            TrackSample sample = engine.sampleTrack(before);
+            const PhysicsState& s = engine.step(referenceStep);
+            profile.progress.push_back(before);
+            profile.speed.push_back(s.speed);
+            profile.time.push_back((i - 1) * referenceStep);
+            profile.gVertical.push_back(s.gForceVertical);
+            profile.gLateral.push_back(s.gForceLateral);
+            profile.gTotal.push_back(s.gForceTotal);
+            profile.gRaw.push_back(engine.getRawGForceTotal());
+            profile.point.push_back(sample.point);
+            profile.tangent.push_back(sample.tangent);
+            profile.tilt.push_back(sample.tilt);
+            profile.curvature.push_back(sample.curvature);
+            profile.inLoop.push_back(sample.inLoop ? 1 : 0);
+            
+            if (lapFinished(before, s.progress)) {
+                profile.completed = true;
+                break;
+            }
+            if (s.progress <= before) break;  // stalled or rolling back
+            before = s.progress;
+        }
+        return profile;
+    }
+    
+    // One run, integrating drag and friction work separately per
+    // control-point span. Heights and peak distances come from the frame
+    // table; the run supplies entry speeds and drag.
+    static EnergyBudget energyBudget(const std::shared_ptr<const TrackModel>& model, bool chainLift) {
+        EnergyBudget budget;
+        const TrackModel& m = *model;
+        if (m.points.size() < 2 || m.segments <= 0 || m.frames.size() < 2) return budget;
+        
+        const int segments = m.segments;
+        const size_t lastFrame = m.frames.size() - 1;
+        budget.sections.resize(segments);
+        std::vector<double> peakProgress(segments);
+        
+        for (int k = 0; k < segments; k++) {
+            EnergySection& s = budget.sections[k];
+            s = EnergySection{};
+            s.startProgress = static_cast<double>(k) / segments;
+            s.endProgress = static_cast<double>(k + 1) / segments;
+            
+            size_t first = static_cast<size_t>(std::llround(s.startProgress * lastFrame));
+            size_t last = std::min(lastFrame, static_cast<size_t>(std::llround(s.endProgress * lastFrame)));
+            s.entryHeight = m.frames[first].point.y;
+            s.length = m.frames[last].arcLength - m.frames[first].arcLength;
+            
+            size_t peak = first;
+            for (size_t i = first; i <= last; i++) {
+                if (m.frames[i].point.y > m.frames[peak].point.y) peak = i;
+            }
+            s.peakHeight = m.frames[peak].point.y;
+            s.peakDistance = m.frames[peak].arcLength - m.frames[first].arcLength;
+            peakProgress[k] = static_cast<double>(peak) / lastFrame;
+        }
+        
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.reset();
+        
+        auto sectionOf = [segments](double progress) {
+            return std::max(0, std::min(segments - 1, static_cast<int>(progress * segments)));
+        };
+        auto energyOf = [](const PhysicsState& s) { return 0.5 * s.speed * s.speed + GRAVITY * s.height; };
+        
+        PhysicsState before = engine.getState();
+        int current = 0;
+        budget.sections[0].entrySpeed = before.speed;
+        budget.sections[0].reached = true;
+        
+        const double dt = RIDE_TIME_STEP;
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / dt);
+        for (int i = 1; i <= maxSteps; i++) {
+            PhysicsState after = engine.step(dt);
+            bool wrapped = lapFinished(before.progress, after.progress);
+            EnergySection& s = budget.sections[current];
+            
+            if (after.isOnChainLift) {
+                s.chainLifted = true;
+                s.liftGain += energyOf(after) - energyOf(before);
+            } else {
+                // Same force terms step() applies, times the distance moved
+                double ds = std::abs(after.speed) * dt;
+                double drag = AIR_RESISTANCE * before.speed * before.speed * ds;
+                s.dragLoss += drag;
+                s.frictionLoss += ROLLING_FRICTION * GRAVITY * ds;
+                if (before.progress < peakProgress[current]) s.dragToPeak += drag;
+            }
+            
+            if (wrapped) {
+                s.exitSpeed = after.speed;
+                budget.completed = true;
+                break;
+            }
+            
+            // The table describes the forward run; stop at the first stall
+            // rather than booking the rollback against the failed section
+            if (!after.isOnChainLift && after.speed <= 0) break;
+            
+            int next = sectionOf(after.progress);
+            while (current < next) {
+                budget.sections[current].exitSpeed = after.speed;
+                current++;
+                budget.sections[current].entrySpeed = after.speed;
+                budget.sections[current].reached = true;
+            }
+            before = after;
+        }
+        
+        for (int k = 0; k < segments; k++) {
+            EnergySection& s = budget.sections[k];
+            s.margin = s.chainLifted ? s.liftGain : budget.clearanceMargin(k, s.entrySpeed);
+        }
+        return budget;
+    }
+    
+private:
+    static TrajectorySample toTrajectorySample(PhysicsEngine& engine, const PhysicsState& s, double time) {
+        TrackSample frame = engine.sampleTrack(s.progress);
+        
+        TrajectorySample sample;
+        sample.time = time;
+        sample.x = s.position.x;
+        sample.y = s.position.y;
+        sample.z = s.position.z;
+        sample.setOrientation(frame.up.cross(frame.tangent), frame.up, frame.tangent);
+        sample.speed = s.speed;
+        sample.gForceVertical = s.gForceVertical;
+        sample.gForceLateral = s.gForceLateral;
+        return sample;
+    }
+    
+    // One run from the station until the train gets back to the start
+    // (looped) or reaches the end (open)
+    static void simulateRide(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                             const RideConditions& conditions, TrackStats& stats) {
+        PhysicsEngine engine(model);
+        engine.setChainLift(chainLift);
+        engine.setRideConditions(conditions);
+        engine.reset();
+        
+        // The engine rides the spline straight through inline elements;
+        // their time is added as the train passes each entry
+        std::vector<size_t> elements;
+        for (size_t i = 0; i < model->points.size(); i++) {
+            if (model->points[i].hasLoop) elements.push_back(i);
+        }
+        size_t nextElement = 0;
+        double elementSeconds = 0;
+        
+        int maxSteps = static_cast<int>(RIDE_TIME_LIMIT / RIDE_TIME_STEP);
+        double previousProgress = 0;
+        double previousSpeed = engine.getState().speed;
+        
+        for (int i = 1; i <= maxSteps; i++) {
+            const PhysicsState& s = engine.step(RIDE_TIME_STEP);
+            
+            if (lapFinished(previousProgress, s.progress)) {
+                stats.rideTime = i * RIDE_TIME_STEP + elementSeconds;
+                stats.rideCompleted = true;
+                return;
+            }
+            
+            while (nextElement < elements.size() &&
+                   elementEntry(*model, elements[nextElement]) < s.progress) {
+                const TrackPointData& p = model->points[elements[nextElement]];
+                double time = elementTime(p, model->frameAt(elementEntry(*model, elements[nextElement])).tangent,
+                                          std::abs(s.speed));
+                if (time < 0) {
+                    // Too slow to get over the top
+                    stats.rideTime = i * RIDE_TIME_STEP + elementSeconds;
+                    stats.rideCompleted = false;
+                    return;
+                }
+                elementSeconds += time;
+                nextElement++;
+            }
+            
+            stats.maxSpeed = std::max(stats.maxSpeed, std::abs(s.speed));
+            stats.maxGForce = std::max(stats.maxGForce, s.gForceTotal);
+            if (stuck(previousSpeed, s.speed)) {
+                // Came to rest on the previous step
+                stats.rideTime = (i - 1) * RIDE_TIME_STEP + elementSeconds;
+                stats.rideCompleted = false;
+                return;
+            }
+            previousProgress = s.progress;
+            previousSpeed = s.speed;
+        }
+        
+        stats.rideTime = RIDE_TIME_LIMIT;
+        stats.rideCompleted = false;
+    }
+};
+
+inline TrackStats PhysicsEngine::getTrackStats() {
+    if (!hasCachedStats || cachedStatsVersion != model->version ||
+        cachedStatsChainLift != hasChainLift) {
+        cachedStats = TrackAnalyzer::computeStats(model, hasChainLift, conditions);
+        cachedStatsVersion = model->version;
+        cachedStatsChainLift = hasChainLift;
+        hasCachedStats = true;
+    }
+    return cachedStats;
+}
+
+inline std::shared_ptr<const EnergyBudget> PhysicsEngine::getEnergyBudget() {
+    if (!cachedBudget || cachedBudgetVersion != model->version || cachedBudgetChainLift != hasChainLift) {
+        cachedBudget = std::make_shared<const EnergyBudget>(TrackAnalyzer::energyBudget(model, hasChainLift));
+        cachedBudgetVersion = model->version;
+        cachedBudgetChainLift = hasChainLift;
+    }
+    return cachedBudget;
+}
+
+inline std::shared_ptr<const SpeedProfile> PhysicsEngine::getSpeedProfile(double referenceStep) {
+    if (!cachedSpeedProfile || cachedSpeedProfileVersion != model->version ||
+        cachedSpeedProfileChainLift != hasChainLift || cachedSpeedProfile->referenceStep != referenceStep) {
+        cachedSpeedProfile = std::make_shared<const SpeedProfile>(
+            TrackAnalyzer::speedProfile(model, hasChainLift, conditions, referenceStep));
+        cachedSpeedProfileVersion = model->version;
+        cachedSpeedProfileChainLift = hasChainLift;
+        speedCursor = 0;
+    }
+    return cachedSpeedProfile;
+}
+
+inline std::shared_ptr<const RideTimeline> PhysicsEngine::getRideTimeline() {
+    if (!cachedTimeline || cachedTimelineVersion != model->version || cachedTimelineChainLift != hasChainLift) {
+        cachedTimeline = std::make_shared<const RideTimeline>(TrackAnalyzer::rideTimeline(model, hasChainLift, conditions));
+        cachedTimelineVersion = model->version;
+        cachedTimelineChainLift = hasChainLift;
+    }
+    return cachedTimeline;
+}
+
+inline std::shared_ptr<const RideProfile> PhysicsEngine::getRideProfile() {
+    if (!cachedRide || cachedRideVersion != model->version || cachedRideChainLift != hasChainLift) {
+        cachedRide = std::make_shared<const RideProfile>(TrackAnalyzer::profileRide(model, hasChainLift, conditions));
+        cachedRideVersion = model->version;
+        cachedRideChainLift = hasChainLift;
+    }
+    return cachedRide;
+}
+
+inline std::vector<TrajectorySample> PhysicsEngine::recordRide(double rateHz) const {
+    return TrackAnalyzer::recordRide(model, hasChainLift, conditions, rateHz);
+}
+
+// ============================================================================
+// Robustness
+// ============================================================================
+
+/**
+ * Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+ * 3"): a counter-based generator. Draw block `stream` of sample `index` is
+ * a pure function of (seed, index, stream), so samples can run on any
+ * thread, in any order, alone or in a batch, and still draw the same values.
+ */
+class CounterRng {
+public:
+    struct Block { uint32_t v[4]; };
+    
+    static Block generate(uint64_t seed, uint32_t index, uint32_t stream) {
+        uint32_t c[4] = { index, stream, 0, 0 };
+        uint32_t k[2] = { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+        for (int round = 0; round < 10; round++) {
+            if (round > 0) {
+                k[0] += 0x9E3779B9u;
+                k[1] += 0xBB67AE85u;
+            }
+            uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c[0];
+            uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c[2];
+            uint32_t next[4] = {
+                static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<uint32_t>(p0)
+            };
+            std::memcpy(c, next, sizeof(c));
+        }
+        return Block{ { c[0], c[1], c[2], c[3] } };
+    }
+    
+    // Open interval (0, 1), so logs of it stay finite
+    static double uniform(uint32_t bits) { return (bits + 0.5) / 4294967296.0; }
+};
+
+/**
+ * Many headless rides of one shared model under perturbed conditions:
+ * passenger load (which scales drag per unit mass), rolling friction and
+ * wind. Each worker thread owns an engine and a tally; samples are handed
+ * out in chunks from one counter. Sample i's conditions depend only on
+ * (seed, i), and tallies merge with sums and extremes, so the report is
+ * identical whatever the thread count or scheduling.
+ */
+class MonteCarloRides {
+public:
+    // Drag was tuned for a train this heavy with NOMINAL_OCCUPANCY of
+    // FULL_LOAD aboard (kg)
+    static constexpr double TRAIN_MASS = 5000;
+    static constexpr double FULL_LOAD = 2000;
+    static constexpr double NOMINAL_OCCUPANCY = 0.5;
+    
+    static constexpr int MAX_SAMPLES = 100000;
+    static constexpr int MAX_THREADS = 64;
+    static constexpr uint32_t CHUNK = 16;   // samples a worker claims at a time
+    
+    static RideConditions conditions(const RobustnessOptions& options, uint32_t index) {
+        CounterRng::Block a = CounterRng::generate(options.seed, index, 0);
+        CounterRng::Block b = CounterRng::generate(options.seed, index, 1);
+        
+        double occupancy = options.minOccupancy +
+            (options.maxOccupancy - options.minOccupancy) * CounterRng::uniform(a.v[0]);
+        double normal = std::sqrt(-2.0 * std::log(CounterRng::uniform(a.v[1]))) *
+            std::cos(2.0 * M_PI * CounterRng::uniform(a.v[2]));
+        
+        // Rayleigh speed with the requested mean, from a uniform heading
+        double windSpeed = options.meanWindSpeed / std::sqrt(M_PI / 2.0) *
+            std::sqrt(-2.0 * std::log(CounterRng::uniform(a.v[3])));
+        double heading = 2.0 * M_PI * CounterRng::uniform(b.v[0]);
+        
+        RideConditions c;
+        c.dragScale = (TRAIN_MASS + NOMINAL_OCCUPANCY * FULL_LOAD) / (TRAIN_MASS + occupancy * FULL_LOAD);
+        c.frictionScale = std::exp(options.frictionSigma * normal);
+        c.windX = windSpeed * std::cos(heading);
+        c.windZ = windSpeed * std::sin(heading);
+        return c;
+    }
+    
+    static RobustnessReport run(const std::shared_ptr<const TrackModel>& model, bool chainLift,
+                                const RobustnessOptions& options) {
+        RobustnessReport report = {};
+        const int segments = model->segments;
+        const uint32_t samples = static_cast<uint32_t>(std::max(0, std::min(MAX_SAMPLES, options.samples)));
+        if (model->points.size() < 2 || segments < 1 || model->frames.empty() || samples == 0) return report;
+        
+        // Fill every lazy chunk once up front rather than having the
+        // workers queue on the chunk lock
+        model->ensureFrames(0, model->frames.size() - 1);
+        
+        int threads = 1;
+#if PHYSICS_HAS_THREADS
+        threads = options.threads;
+#ifndef __EMSCRIPTEN__
+        if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+#endif
+        threads = std::max(1, std::min({ threads, MAX_THREADS, static_cast<int>((samples + CHUNK - 1) / CHUNK) }));
+#endif
+        
+        std::atomic<uint32_t> next{0};
+        std::vector<Tally> tallies(threads, Tally(segments));
+        auto work = [&](Tally& tally) {
+            PhysicsEngine engine(model);
+            engine.setChainLift(chainLift);
+            for (;;) {
+                uint32_t first = next.fetch_add(CHUNK, std::memory_order_relaxed);
+                if (first >= samples) break;
+                for (uint32_t i = first; i < std::min(samples, first + CHUNK); i++) {
+                    runSample(engine, options, i, tally);
+                }
+            }
+        };
+        
+#if PHYSICS_HAS_THREADS
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; t++) workers.emplace_back(work, std::ref(tallies[t]));
+        work(tallies[0]);
+        for (std::thread& worker : workers) worker.join();
+#else
+        work(tallies[0]);
+#endif
+        
+        Tally& total = tallies[0];
+        for (int t = 1; t < threads; t++) total.merge(tallies[t]);
+        
+        const double scale = 1.0 / samples;
+        report.samples = static_cast<int>(samples);
+        report.stallProbability = total.stalled * scale;
+        report.exceedanceProbability = total.anyExceeded * scale;
+        report.sections.resize(segments);
+        for (int k = 0; k < segments; k++) {
+            RobustnessSection& s = report.sections[k];
+            bool reached = total.reached[k] > 0;
+            s.startProgress = static_cast<double>(k) / segments;
+            s.endProgress = static_cast<double>(k + 1) / segments;
+            s.reachProbability = total.reached[k] * scale;
+            s.stallProbability = total.stalls[k] * scale;
+            s.exceedanceProbability = total.exceeded[k] * scale;
+            s.maxVerticalG = reached ? total.maxVertical[k] : 0;
+            s.minVerticalG = reached ? total.minVertical[k] : 0;
+            s.maxLateralG = reached ? total.maxLateral[k] : 0;
+        }
+        return report;
+    }
+    
+private:
+    // Counts and extremes from one worker's samples
+    struct Tally {
+        std::vector<uint32_t> reached, stalls, exceeded;
+        std::vector<double> maxVertical, minVertical, maxLateral;
+        uint32_t stalled = 0;
+        uint32_t anyExceeded = 0;
+        
+        // Last sample (index + 1) counted per section, so each sample
+        // counts once per section without clearing flags between samples
+        std::vector<uint32_t> reachedMark, exceededMark;
+        
+        explicit Tally(int segments)
+            : reached(segments), stalls(segments), exceeded(segments),
+              maxVertical(segments, -std::numeric_limits<double>::infinity()),
+              minVertical(segments, std::numeric_limits<double>::infinity()),
+              maxLateral(segments, 0), reachedMark(segments), exceededMark(segments) {}
+        
+        void merge(const Tally& o) {
+            for (size_t k = 0; k < reached.size(); k++) {
+                reached[k] += o.reached[k];
+                stalls[k] += o.stalls[k];
+                exceeded[k] += o.exceeded[k];
+                maxVertical[k] = std::max(maxVertical[k], o.maxVertical[k]);
+                minVertical[k] = std::min(minVertical[k], o.minVertical[k]);
+                maxLateral[k] = std::max(maxLateral[k], o.maxLateral[k]);
+            }
+            stalled += o.stalled;
+            anyExceeded += o.anyExceeded;
+        }
+    };
+    
+    static bool exceedsLimits(const PhysicsState& s) {
+        return s.gForceVertical > MAX_SAFE_G_FORCE || s.gForceVertical < MIN_SAFE_G_FORCE ||
+               std::abs(s.gForceLateral) > COMFORT_G_LATERAL;
+    }
+    
+    // One lap, stopped at the first stall like the energy budget's run: a
+    // train that rolls to a stop or back has failed the section it is in
+    static void runSample(PhysicsEngine& engine, const RobustnessOptions& options, uint32_t index, Tally& tally) {
+        const int segments = static_cast<int>(tally.reached.size());
+        const uint32_t mark = index + 1;
+        auto sectionOf = [segments](double progress) {
+            return std::max(0, std::min(segments - 1, static_cast<int>(progress * segments)));
+        };
+        
+        engine.setRideConditions(conditions(options, index));
+        engine.reset();
+        
+        PhysicsState before = engine.getState();
+        int furthest = 0;
+        tally.reachedMark[0] = mark;
+        tally.reached[0]++;
+        bool completed = false, exceeded = false;
+        
+        const double dt = TrackAnalyzer::RIDE_TIME_STEP;
+        const int maxSteps = static_cast<int>(TrackAnalyzer::RIDE_TIME_LIMIT / dt);
+        for (int i = 1; i <= maxSteps; i++) {
+            PhysicsState s = engine.step(dt);
+            if (TrackAnalyzer::lapFinished(before.progress, s.progress)) {
+                completed = true;
+                break;
+            }
+            
+            int k = sectionOf(s.progress);
+            for (; furthest < k; furthest++) {
+                if (tally.reachedMark[furthest + 1] != mark) {
+                    tally.reachedMark[furthest + 1] = mark;
+                    tally.reached[furthest + 1]++;
+                }
+            }
+            
+            tally.maxVertical[k] = std::max(tally.maxVertical[k], s.gForceVertical);
+            tally.minVertical[k] = std::min(tally.minVertical[k], s.gForceVertical);
+            tally.maxLateral[k] = std::max(tally.maxLateral[k], std::abs(s.gForceLateral));
+            if (exceedsLimits(s)) {
+                exceeded = true;
+                if (tally.exceededMark[k] != mark) {
+                    tally.exceededMark[k] = mark;
+                    tally.exceeded[k]++;
+                }
+            }
+            
+            if (!s.isOnChainLift && s.speed <= 0) break;
+            before = s;
+        }
+        
+        if (!completed) {
+            tally.stalls[furthest]++;
+            tally.stalled++;
+        }
+        if (exceeded) tally.anyExceeded++;
+    }
+};
+
+inline RobustnessReport PhysicsEngine::simulateRobustness(const RobustnessOptions& options) const {
+    return MonteCarloRides::run(model, hasChainLift, options);
+}
+
+// ============================================================================
+// State Ring
+// ============================================================================
+
+// Flat state record laid out for direct Float64Array access from JS
+struct StateRecord {
+    double simTime;        // seconds of simulated time
+    double progress;
+    double speed;
+    double positionX, positionY, positionZ;
+    double velocityX, velocityY, velocityZ;
+    double gForceVertical;
+    double gForceLateral;
+    double gForceTotal;
+    double height;
+    double bankAngle;
+    double flags;          // bit 0 = chain lift, bit 1 = in loop
+    double reserved;
+    
+    static StateRecord from(const PhysicsState& s, double time) {
+        StateRecord r;
+        r.simTime = time;
+        r.progress = s.progress;
+        r.speed = s.speed;
+        r.positionX = s.position.x;
+        r.positionY = s.position.y;
+        r.positionZ = s.position.z;
+        r.velocityX = s.velocity.x;
+        r.velocityY = s.velocity.y;
+        r.velocityZ = s.velocity.z;
+        r.gForceVertical = s.gForceVertical;
+        r.gForceLateral = s.gForceLateral;
+        r.gForceTotal = s.gForceTotal;
+        r.height = s.height;
+        r.bankAngle = s.bankAngle;
+        r.flags = (s.isOnChainLift ? 1 : 0) + (s.isInLoop ? 2 : 0);
+        r.reserved = 0;
+        return r;
+    }
+};
+
+constexpr uint32_t STATE_RECORD_STRIDE = sizeof(StateRecord) / sizeof(double);
+static_assert(sizeof(StateRecord) == 16 * sizeof(double), "StateRecord must stay 16 doubles");
+
+/**
+ * Lock-free single-producer/single-consumer ring of StateRecords. The
+ * producer never waits; the consumer only ever wants the newest two
+ * records and re-checks the head after copying to detect being lapped.
+ * Slots are stored as relaxed atomic words, like SeqLock's payload, so a
+ * copy that overlaps a write is a detectable retry rather than a data race.
+ * The words are laid out exactly as StateRecord[CAPACITY], and in a
+ * pthreads build the ring lives in shared WASM memory, so the render
+ * thread can read it straight from HEAPF64 without calling into the module.
+ */
+class StateRing {
+public:
+    static constexpr uint32_t CAPACITY = 64;  // power of two so head wrap stays consistent
+    
+private:
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(double), "slot words must alias doubles");
+    
+    std::atomic<uint64_t> words[CAPACITY * STATE_RECORD_STRIDE];
+    std::atomic<uint32_t> head{0};  // records published so far
+    
+    void load(uint32_t index, StateRecord& record) const {
+        uint64_t buffer[STATE_RECORD_STRIDE];
+        const std::atomic<uint64_t>* slot = &words[(index % CAPACITY) * STATE_RECORD_STRIDE];
+        for (uint32_t i = 0; i < STATE_RECORD_STRIDE; i++) {
+            buffer[i] = slot[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&record, buffer, sizeof(StateRecord));
+    }
+    
+public:
+    StateRing() {
+        for (auto& w : words) w.store(0, std::memory_order_relaxed);
+    }
+    
+    void publish(const StateRecord& record) {
+        uint64_t buffer[STATE_RECORD_STRIDE];
+        std::memcpy(buffer, &record, sizeof(StateRecord));
+        
+        uint32_t h = head.load(std::memory_order_relaxed);
+        // A reader that copies any of these words also sees the head that
+        // made this slot the oldest, and so retries
+        std::atomic_thread_fence(std::memory_order_release);
+        std::atomic<uint64_t>* slot = &words[(h % CAPACITY) * STATE_RECORD_STRIDE];
+        for (uint32_t i = 0; i < STATE_RECORD_STRIDE; i++) {
+            slot[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        head.store(h + 1, std::memory_order_release);
+    }
+    
+    bool readLatestPair(StateRecord& previous, StateRecord& latest) const {
+        for (int attempt = 0; attempt < 4; attempt++) {
+            uint32_t h = head.load(std::memory_order_acquire);
+            if (h < 2) return false;
+            
+            load(h - 2, previous);
+            load(h - 1, latest);
+            
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (head.load(std::memory_order_relaxed) - h < CAPACITY - 2) return true;
+        }
+        return false;
+    }
+    
+    uint32_t getHead() const { return head.load(std::memory_order_acquire); }
+    uintptr_t getSlotsPointer() const { return reinterpret_cast<uintptr_t>(words); }
+    uintptr_t getHeadPointer() const { return reinterpret_cast<uintptr_t>(&head); }
+};
+
+#if PHYSICS_HAS_THREADS
+
+// ============================================================================
+// Simulation Host
+// ============================================================================
+
+/**
+ * Runs a PhysicsEngine on its own thread (a Web Worker in the Emscripten
+ * pthreads build) at a fixed rate and publishes every step into a
+ * StateRing. The engine is only ever touched by the simulation thread;
+ * calls from other threads are queued and applied between steps.
+ */
+class SimulationHost {
+private:
+    PhysicsEngine engine;
+    StateRing ring;
+    std::shared_ptr<ControlStream> controlStream;  // caller's side; see getControlStream()
+    std::thread worker;
+    std::atomic<bool> running{false};
+    
+    std::mutex commandMutex;
+    std::vector<std::function<void(PhysicsEngine&)>> commands;
+    
+    double rateHz;
+    double simTime;
+    
+public:
+    SimulationHost() : rateHz(120), simTime(0) {}
+    ~SimulationHost() { stop(); }
+    
+    void start(double hz) {
+        if (running.load()) return;
+        rateHz = std::max(1.0, hz);
+        running.store(true);
+        worker = std::thread([this]() { run(); });
+    }
+    
+    void stop() {
+        running.store(false);
+        if (worker.joinable()) worker.join();
+    }
+    
+    bool isRunning() const { return running.load(); }
+    
+    // Latest stepped state, for readers that want a value rather than
+    // interpolating from the ring
+    PhysicsState getSnapshot() const { return engine.readSnapshot(); }
+    uint32_t getSnapshotVersion() const { return engine.getSnapshotVersion(); }
+    
+    // Events produced on the simulation thread since the last drain
+    std::vector<RideEvent> drainEvents() { return engine.drainEvents(); }
+    
+    void setControlRate(double hz) {
+        if (hz > 0) getControlStream();
+        enqueue([hz](PhysicsEngine& e) { e.setControlRate(hz); });
+    }
+    
+    // Allocated here on first use and handed to the simulation thread; that
+    // thread writes it, readers only follow its atomic head
+    const ControlStream& getControlStream() {
+        if (!controlStream) {
+            controlStream = std::make_shared<ControlStream>();
+            enqueue([stream = controlStream](PhysicsEngine& e) { e.attachControlStream(stream); });
+        }
+        return *controlStream;
+    }
+    
+    // Track edits go through the background builder so stepping never stalls
+    void setTrack(const std::vector<TrackPointData>& points, bool isLooped) {
+        enqueue([points, isLooped](PhysicsEngine& e) { e.beginTrackBuild(points, isLooped); });
+    }
+    
+    void setChainLift(bool enabled) {
+        enqueue([enabled](PhysicsEngine& e) { e.setChainLift(enabled); });
+    }
+    
+    void setRideConditions(const RideConditions& c) {
+        enqueue([c](PhysicsEngine& e) { e.setRideConditions(c); });
+    }
+    
+    void reset() {
+        enqueue([](PhysicsEngine& e) { e.reset(); });
+    }
+    
+    void setSpeed(double s) {
+        enqueue([s](PhysicsEngine& e) { e.setSpeed(s); });
+    }
+    
+    void setProgress(double p) {
+        enqueue([p](PhysicsEngine& e) { e.setProgress(p); });
+    }
+    
+    // Shared-memory layout for the JS reader
+    uintptr_t getRingStatesPointer() const { return ring.getSlotsPointer(); }
+    uintptr_t getRingHeadPointer() const { return ring.getHeadPointer(); }
+    uint32_t getRingCapacity() const { return StateRing::CAPACITY; }
+    uint32_t getRecordStride() const { return STATE_RECORD_STRIDE; }
+    
+private:
+    void enqueue(std::function<void(PhysicsEngine&)> command) {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commands.push_back(std::move(command));
+    }
+    
+    void drainCommands() {
+        std::vector<std::function<void(PhysicsEngine&)>> pending;
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            pending.swap(commands);
+        }
+        for (auto& command : pending) command(engine);
+    }
+    
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        const double dt = 1.0 / rateHz;
+        const Clock::duration period =
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        Clock::time_point next = Clock::now();
+        
+        while (running.load(std::memory_order_relaxed)) {
+            drainCommands();
+            engine.step(dt);
+            simTime += dt;
+            ring.publish(StateRecord::from(engine.getState(), simTime));
+            
+            // Resync instead of bursting to catch up after a long stall
+            // (e.g. the tab was backgrounded and the worker throttled)
+            next += period;
+            Clock::time_point now = Clock::now();
+            if (now - next > period * 8) next = now;
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+#endif // PHYSICS_HAS_THREADS
+
+// ============================================================================
+// Track Codec
+// ============================================================================
+
+/**
+ * Compact binary format for saved tracks. Positions are quantized to
+ * millimeters and angles to 0.1 degree, every channel is delta-coded
+ * against the previous point or element, and the residuals go through an
+ * adaptive binary range coder. Layout:
+ *
+ *   "RCTK"  u8 version  <range-coded body>
+ *
+ * The body holds the looped flag, the point and element counts, then per
+ * point (dx, dy, dz, dtilt) and per element (dpointIndex, type, direction,
+ * dradius, dpitch, drotation).
+ */
+
+// Element kinds, in the order of TrackElementType in the client store
+enum TrackElementKind : uint32_t {
+    ELEMENT_LOOP = 0,
+    ELEMENT_CORKSCREW = 1,
+    ELEMENT_HELIX = 2,
+    ELEMENT_IMMELMAN = 3,
+    ELEMENT_ZERO_G_ROLL = 4,
+    ELEMENT_COBRA_ROLL = 5,
+    ELEMENT_KIND_COUNT = 6
+};
+
+struct SavedTrackPoint {
+    double x, y, z;
+    double tilt;        // degrees
+    
+    SavedTrackPoint() : x(0), y(0), z(0), tilt(0) {}
+};
+
+struct SavedTrackElement {
+    uint32_t pointIndex; // entry point
+    uint32_t type;       // TrackElementKind
+    double radius;
+    double pitch;
+    double rotation;     // degrees
+    bool leftHanded;
+    
+    SavedTrackElement()
+        : pointIndex(0), type(ELEMENT_LOOP), radius(8), pitch(12), rotation(360), leftHanded(false) {}
+};
+
+struct SavedTrack {
+    std::vector<SavedTrackPoint> points;
+    std::vector<SavedTrackElement> elements;
+    bool isLooped = false;
+};
+
+namespace rangecoder {
+
+constexpr uint32_t PROB_BITS = 11;
+constexpr uint16_t PROB_INIT = 1 << (PROB_BITS - 1);
+constexpr uint32_t MOVE_BITS = 5;
+constexpr uint32_t TOP = 1u << 24;
+
+// Adaptive binary range coder (the LZMA construction): every modeled bit
+// is coded against an 11-bit probability that follows what its context
+// has seen so far.
+class Encoder {
+private:
+    std::vector<uint8_t>& out;
+    uint64_t low = 0;
+    uint32_t range = 0xFFFFFFFFu;
+    uint8_t cache = 0;
+    uint64_t cacheSize = 1;
+    
+    void shiftLow() {
+        if (static_cast<uint32_t>(low) < 0xFF000000u || (low >> 32) != 0) {
+            uint8_t carry = static_cast<uint8_t>(low >> 32);
+            uint8_t pending = cache;
+            do {
+                out.push_back(static_cast<uint8_t>(pending + carry));
+                pending = 0xFF;
+            } while (--cacheSize != 0);
+            cache = static_cast<uint8_t>(low >> 24);
+        }
+        cacheSize++;
+        low = (low & 0x00FFFFFFu) << 8;
+    }
+    
+    void normalize() {
+        while (range < TOP) {
+            range <<= 8;
+            shiftLow();
+        }
+    }
+    
+public:
+    explicit Encoder(std::vector<uint8_t>& output) : out(output) {}
+    
+    void encodeBit(uint16_t& prob, uint32_t bit) {
+        uint32_t bound = (range >> PROB_BITS) * prob;
+        if (bit == 0) {
+            range = bound;
+            prob += ((1u << PROB_BITS) - prob) >> MOVE_BITS;
+        } else {
+            low += bound;
+            range -= bound;
+            prob -= prob >> MOVE_BITS;
+        }
+        normalize();
+    }
+    
+    // Equiprobable bits, most significant first
+    void encodeDirect(uint32_t value, int bits) {
+        for (int i = bits - 1; i >= 0; --i) {
+            range >>= 1;
+            if ((value >> i) & 1) low += range;
+            normalize();
+        }
+    }
+    
+    void flush() {
+        for (int i = 0; i < 5; ++i) shiftLow();
+    }
+};
+
+class Decoder {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    uint32_t range = 0xFFFFFFFFu;
+    uint32_t code = 0;
+    
+    // Reads past the end yield zeros; overrun() reports it afterwards
+    uint8_t next() { return pos < size ? data[pos++] : (pos++, 0); }
+    
+    void normalize() {
+        while (range < TOP) {
+            range <<= 8;
+            code = (code << 8) | next();
+        }
+    }
+    
+public:
+    Decoder(const uint8_t* bytes, size_t length) : data(bytes), size(length) {
+        for (int i = 0; i < 5; ++i) code = (code << 8) | next();
+    }
+    
+    uint32_t decodeBit(uint16_t& prob) {
+        uint32_t bound = (range >> PROB_BITS) * prob;
+        uint32_t bit;
+        if (code < bound) {
+            range = bound;
+            prob += ((1u << PROB_BITS) - prob) >> MOVE_BITS;
+            bit = 0;
+        } else {
+            code -= bound;
+            range -= bound;
+            prob -= prob >> MOVE_BITS;
+            bit = 1;
+        }
+        normalize();
+        return bit;
+    }
+    
+    uint32_t decodeDirect(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i) {
+            range >>= 1;
+            uint32_t bit = code >= range ? 1 : 0;
+            if (bit) code -= range;
+            value = (value << 1) | bit;
+            normalize();
+        }
+        return value;
+    }
+    
+    bool overrun() const { return pos > size; }
+};
+
+// Adaptive model for one stream of signed integers. The bit length of the
+// zigzagged value goes through a 7-level bit tree; the bits below its
+// leading one are sent raw. Small residuals, the common case after delta
+// coding, cost a few bits each.
+class IntegerModel {
+private:
+    uint16_t lengthTree[128];
+    
+public:
+    IntegerModel() { std::fill(std::begin(lengthTree), std::end(lengthTree), PROB_INIT); }
+    
+    void encode(Encoder& rc, int64_t value) {
+        uint64_t u = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        uint32_t length = 0;
+        while (length < 64 && (u >> length) != 0) length++;
+        
+        uint32_t node = 1;
+        for (int i = 6; i >= 0; --i) {
+            uint32_t bit = (length >> i) & 1;
+            rc.encodeBit(lengthTree[node], bit);
+            node = (node << 1) | bit;
+        }
+        
+        for (int remaining = static_cast<int>(length) - 1; remaining > 0; ) {
+            int chunk = std::min(remaining, 16);
+            remaining -= chunk;
+            rc.encodeDirect(static_cast<uint32_t>((u >> remaining) & ((1u << chunk) - 1)), chunk);
+        }
+    }
+    
+    int64_t decode(Decoder& rc) {
+        uint32_t node = 1;
+        for (int i = 0; i < 7; ++i) node = (node << 1) | rc.decodeBit(lengthTree[node]);
+        uint32_t length = node - 128;
+        if (length == 0) return 0;
+        if (length > 64) length = 64;  // corrupt input; caught by range checks
+        
+        uint64_t u = 1;
+        for (int remaining = static_cast<int>(length) - 1; remaining > 0; ) {
+            int chunk = std::min(remaining, 16);
+            remaining -= chunk;
+            u = (u << chunk) | rc.decodeDirect(chunk);
+        }
+        return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+    }
+};
+
+} // namespace rangecoder
+
+class TrackCodec {
+public:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr double POSITION_SCALE = 1000.0;  // millimeters
+    static constexpr double ANGLE_SCALE = 10.0;       // tenths of a degree
+    static constexpr uint32_t MAX_POINTS = 1u << 20;
+    static constexpr uint32_t MAX_ELEMENTS = 1u << 16;
+    static constexpr int64_t MAX_QUANTIZED = 1000000000000LL;  // quantize() clamps to this
+    
+    // Densest possible coding: a point or element is at least 28 adaptive
+    // decisions, each costing at least log2(2048 / 2017) bits, so fewer
+    // than 13 fit in a byte. Counts beyond this are corrupt.
+    static constexpr uint64_t MAX_ITEMS_PER_BYTE = 16;
+    
+    static std::vector<uint8_t> encode(const SavedTrack& track) {
+        std::vector<uint8_t> out = { 'R', 'C', 'T', 'K', FORMAT_VERSION };
+        out.reserve(16 + track.points.size() * 6 + track.elements.size() * 8);
+        
+        rangecoder::Encoder rc(out);
+        Models m;
+        
+        rc.encodeBit(m.looped, track.isLooped ? 1 : 0);
+        m.count.encode(rc, static_cast<int64_t>(track.points.size()));
+        m.count.encode(rc, static_cast<int64_t>(track.elements.size()));
+        
+        int64_t px = 0, py = 0, pz = 0, pt = 0;
+        for (const auto& p : track.points) {
+            int64_t x = quantize(p.x, POSITION_SCALE);
+            int64_t y = quantize(p.y, POSITION_SCALE);
+            int64_t z = quantize(p.z, POSITION_SCALE);
+            int64_t t = quantize(p.tilt, ANGLE_SCALE);
+            m.x.encode(rc, x - px);
+            m.y.encode(rc, y - py);
+            m.z.encode(rc, z - pz);
+            m.tilt.encode(rc, t - pt);
+            px = x; py = y; pz = z; pt = t;
+        }
+        
+        int64_t pi = 0, pr = 0, pp = 0, prot = 0;
+        for (const auto& e : track.elements) {
+            int64_t r = quantize(e.radius, POSITION_SCALE);
+            int64_t p = quantize(e.pitch, POSITION_SCALE);
+            int64_t rot = quantize(e.rotation, ANGLE_SCALE);
+            m.pointIndex.encode(rc, static_cast<int64_t>(e.pointIndex) - pi);
+            encodeType(rc, m, std::min<uint32_t>(e.type, ELEMENT_KIND_COUNT - 1));
+            rc.encodeBit(m.leftHanded, e.leftHanded ? 1 : 0);
+            m.radius.encode(rc, r - pr);
+            m.pitch.encode(rc, p - pp);
+            m.rotation.encode(rc, rot - prot);
+            pi = e.pointIndex; pr = r; pp = p; prot = rot;
+        }
+        
+        rc.flush();
+        return out;
+    }
+    
+    // Returns false (leaving `out` unspecified) for anything that is not a
+    // complete, well-formed track of a known version
+    static bool decode(const uint8_t* data, size_t size, SavedTrack& out) {
+        if (size < 5 || std::memcmp(data, "RCTK", 4) != 0 || data[4] != FORMAT_VERSION) {
+            return false;
+        }
+        
+        rangecoder::Decoder rc(data + 5, size - 5);
+        Models m;
+        
+        out.isLooped = rc.decodeBit(m.looped) != 0;
+        int64_t pointCount = m.count.decode(rc);
+        int64_t elementCount = m.count.decode(rc);
+        if (pointCount < 0 || pointCount > MAX_POINTS ||
+            elementCount < 0 || elementCount > MAX_ELEMENTS ||
+            static_cast<uint64_t>(pointCount + elementCount) > (size - 5) * MAX_ITEMS_PER_BYTE) {
+            return false;
+        }
+        
+        out.points.resize(static_cast<size_t>(pointCount));
+        int64_t px = 0, py = 0, pz = 0, pt = 0;
+        for (auto& p : out.points) {
+            if (!accumulate(px, m.x.decode(rc)) || !accumulate(py, m.y.decode(rc)) ||
+                !accumulate(pz, m.z.decode(rc)) || !accumulate(pt, m.tilt.decode(rc))) {
+                return false;
+            }
+            p.x = px / POSITION_SCALE;
+            p.y = py / POSITION_SCALE;
+            p.z = pz / POSITION_SCALE;
+            p.tilt = pt / ANGLE_SCALE;
+        }
+        
+        out.elements.resize(static_cast<size_t>(elementCount));
+        int64_t pi = 0, pr = 0, pp = 0, prot = 0;
+        for (auto& e : out.elements) {
+            if (!accumulate(pi, m.pointIndex.decode(rc)) || pi < 0 || pi >= pointCount) return false;
+            e.pointIndex = static_cast<uint32_t>(pi);
+            e.type = decodeType(rc, m);
+            if (e.type >= ELEMENT_KIND_COUNT) return false;
+            e.leftHanded = rc.decodeBit(m.leftHanded) != 0;
+            if (!accumulate(pr, m.radius.decode(rc)) || !accumulate(pp, m.pitch.decode(rc)) ||
+                !accumulate(prot, m.rotation.decode(rc))) {
+                return false;
+            }
+            e.radius = pr / POSITION_SCALE;
+            e.pitch = pp / POSITION_SCALE;
+            e.rotation = prot / ANGLE_SCALE;
+        }
+        
+        return !rc.overrun();
+    }
+    
+    static int64_t quantize(double value, double scale) {
+        if (!std::isfinite(value)) return 0;
+        return static_cast<int64_t>(std::llround(std::max(-1e12, std::min(1e12, value * scale))));
+    }
+    
+private:
+    // Adds a decoded delta, rejecting anything quantize() could not have
+    // produced before it can overflow
+    static bool accumulate(int64_t& total, int64_t delta) {
+        if (delta < -2 * MAX_QUANTIZED || delta > 2 * MAX_QUANTIZED) return false;
+        total += delta;
+        return total >= -MAX_QUANTIZED && total <= MAX_QUANTIZED;
+    }
+    
+    // Fresh models per call so encoder and decoder adapt in lockstep
+    struct Models {
+        uint16_t looped = rangecoder::PROB_INIT;
+        uint16_t leftHanded = rangecoder::PROB_INIT;
+        uint16_t typeTree[8];
+        rangecoder::IntegerModel count;
+        rangecoder::IntegerModel x, y, z, tilt;
+        rangecoder::IntegerModel pointIndex, radius, pitch, rotation;
+        
+        Models() { std::fill(std::begin(typeTree), std::end(typeTree), rangecoder::PROB_INIT); }
+    };
+    
+    static void encodeType(rangecoder::Encoder& rc, Models& m, uint32_t type) {
+        uint32_t node = 1;
+        for (int i = 2; i >= 0; --i) {
+            uint32_t bit = (type >> i) & 1;
+            rc.encodeBit(m.typeTree[node], bit);
+            node = (node << 1) | bit;
+        }
+    }
+    
+    static uint32_t decodeType(rangecoder::Decoder& rc, Models& m) {
+        uint32_t node = 1;
+        for (int i = 0; i < 3; ++i) node = (node << 1) | rc.decodeBit(m.typeTree[node]);
+        return node - 8;
+    }
+};
+
+// ============================================================================
+// Track Fingerprint
+// ============================================================================
+
+/**
+ * Canonical 64-bit key for everything that determines analysis results:
+ * points and element parameters quantized like TrackCodec (millimeters,
+ * 0.1 degree), the looped and chain-lift flags, and the physics constants.
+ * IDs never reach the engine and sub-millimeter float noise rounds away,
+ * so re-uploads, forks and imports of one design share a key. Bump
+ * PHYSICS_REVISION whenever step() changes behavior, so results cached
+ * under old keys stop matching.
+ */
+class TrackFingerprint {
+public:
+    static constexpr double CONSTANT_SCALE = 1e6;
+    
+    static uint64_t compute(const std::vector<TrackPointData>& points, bool isLooped, bool chainLift) {
+        // FNV-1a, then a splitmix64 finalizer so nearby inputs spread over
+        // the whole key space
+        uint64_t state = 14695981039346656037ull;
+        for (unsigned char byte : canonical(points, isLooped, chainLift)) {
+            state ^= byte;
+            state *= 1099511628211ull;
+        }
+        state = (state ^ (state >> 30)) * 0xbf58476d1ce4e5b9ull;
+        state = (state ^ (state >> 27)) * 0x94d049bb133111ebull;
+        return state ^ (state >> 31);
+    }
+    
+    /**
+     * The quantized values compute() keys on, as little-endian 64-bit
+     * words. 64 bits is plenty to tell one client's edits apart but not to
+     * key a shared cache, so the server hashes these bytes with SHA-256.
+     */
+    static std::string canonical(const std::vector<TrackPointData>& points, bool isLooped, bool chainLift) {
+        std::string out;
+        out.reserve(8 * (10 + 7 * points.size()));
+        auto add = [&out](int64_t value) {
+            uint64_t v = static_cast<uint64_t>(value);
+            for (int i = 0; i < 8; i++, v >>= 8) out.push_back(static_cast<char>(v & 0xFF));
+        };
+        
+        add(PHYSICS_REVISION);
+        for (double constant : { GRAVITY, AIR_RESISTANCE, ROLLING_FRICTION, CHAIN_LIFT_SPEED,
+                                 STATION_SPEED, TrackAnalyzer::RIDE_TIME_STEP }) {
+            add(TrackCodec::quantize(constant, CONSTANT_SCALE));
+        }
+        
+        add(isLooped ? 1 : 0);
+        add(chainLift ? 1 : 0);
+        add(static_cast<int64_t>(points.size()));
+        
+        const double toDegrees = 180.0 / M_PI;
+        for (const TrackPointData& p : points) {
+            add(TrackCodec::quantize(p.position.x, TrackCodec::POSITION_SCALE));
+            add(TrackCodec::quantize(p.position.y, TrackCodec::POSITION_SCALE));
+            add(TrackCodec::quantize(p.position.z, TrackCodec::POSITION_SCALE));
+            add(TrackCodec::quantize(p.tilt * toDegrees, TrackCodec::ANGLE_SCALE));
+            
+            // Element parameters only matter where there is an element
+            add(p.hasLoop ? 1 : 0);
+            if (p.hasLoop) {
+                add(TrackCodec::quantize(p.loopRadius, TrackCodec::POSITION_SCALE));
+                add(TrackCodec::quantize(p.loopPitch, TrackCodec::POSITION_SCALE));
+            }
+        }
+        return out;
+    }
+    
+    // 16 lowercase hex digits; JS numbers cannot hold all 64 bits
+    static std::string toHex(uint64_t value) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 15; i >= 0; --i, value >>= 4) out[i] = digits[value & 0xF];
+        return out;
+    }
+};
+
+inline std::string PhysicsEngine::getTrackFingerprint() const {
+    return TrackFingerprint::toHex(TrackFingerprint::compute(model->points, model->isLooped, hasChainLift));
+}
+
+// ============================================================================
+// Track Similarity
+// ============================================================================
+
+/**
+ * Fixed-length summary of a design for "rides like this one" searches:
+ * recognized element counts, ride scalars from the headless run, and
+ * height, curvature and bank signatures averaged over SIGNATURE_SAMPLES
+ * equal stretches of arc length (so a point-dense design and a sparse one
+ * with the same shape line up). Every component is pre-scaled so that one
+ * unit is roughly a noticeable difference; plain Euclidean distance then
+ * ranks designs without per-dimension weights. The discriminating scalars
+ * come first so SimilarityIndex can abandon a far row early.
+ */
+class TrackDescriptor {
+public:
+    static constexpr int SIGNATURE_SAMPLES = 32;
+    
+    static constexpr int COUNTS_OFFSET = 0;        // drops, airtime hills, turns, helices, inversions
+    static constexpr int RIDE_OFFSET = 5;          // see compute()
+    static constexpr int HEIGHT_OFFSET = 16;
+    static constexpr int CURVATURE_OFFSET = HEIGHT_OFFSET + SIGNATURE_SAMPLES;
+    static constexpr int BANK_OFFSET = CURVATURE_OFFSET + SIGNATURE_SAMPLES;
+    static constexpr int DIMENSIONS = BANK_OFFSET + SIGNATURE_SAMPLES;   // 112
+    
+    // One unit of distance per this much difference
+    static constexpr double HEIGHT_SCALE = 8.0;         // meters
+    static constexpr double CURVATURE_SCALE = 0.02;     // 1/m
+    static constexpr double BANK_SCALE = 20.0 * M_PI / 180.0;
+    static constexpr double SPEED_SCALE = 4.0;          // m/s
+    static constexpr double G_SCALE = 1.0;
+    static constexpr double RATIO_SCALE = 1.25;         // lengths and times, multiplicative
+    static constexpr double SHARE_SCALE = 0.05;         // fraction of the ride
+    static constexpr double DROP_SCALE = 10.0 * M_PI / 180.0;
+    
+    static std::vector<float> compute(const TrackModel& model, const RideProfile& ride) {
+        std::vector<float> d(DIMENSIONS, 0.0f);
+        const size_t n = model.frames.size();
+        if (n < 2 || model.totalLength <= 0) return d;
+        model.ensureFrames(0, n - 1);
+        
+        int elementCount = 0;
+        double elementLength = 0;
+        for (const TrackPointData& p : model.points) {
+            if (!p.hasLoop) continue;
+            elementCount++;
+            elementLength += elementArcLength(p.loopRadius, p.loopPitch);
+        }
+        
+        int kinds[FEATURE_INVERSION + 1] = {};
+        for (const TrackFeature& f : model.features) kinds[f.kind]++;
+        d[COUNTS_OFFSET + 0] = static_cast<float>(kinds[FEATURE_DROP]);
+        d[COUNTS_OFFSET + 1] = static_cast<float>(kinds[FEATURE_AIRTIME_HILL]);
+        d[COUNTS_OFFSET + 2] = static_cast<float>(kinds[FEATURE_TURN]);
+        d[COUNTS_OFFSET + 3] = static_cast<float>(kinds[FEATURE_HELIX]);
+        d[COUNTS_OFFSET + 4] = static_cast<float>(kinds[FEATURE_INVERSION] + elementCount);
+        
+        // Signatures: per-stretch means, an empty stretch (sparse frames on
+        // a long span) repeating the one before it
+        double minY = model.frames[0].point.y, maxY = minY, steepestDrop = 0;
+        for (const TrackFrame& f : model.frames) {
+            minY = std::min(minY, f.point.y);
+            maxY = std::max(maxY, f.point.y);
+            steepestDrop = std::max(steepestDrop, -std::asin(std::clamp(f.tangent.y, -1.0, 1.0)));
+        }
+        
+        double height[SIGNATURE_SAMPLES] = {}, curvature[SIGNATURE_SAMPLES] = {}, bank[SIGNATURE_SAMPLES] = {};
+        int count[SIGNATURE_SAMPLES] = {};
+        for (const TrackFrame& f : model.frames) {
+            int bin = std::min(SIGNATURE_SAMPLES - 1,
+                               static_cast<int>(f.arcLength / model.totalLength * SIGNATURE_SAMPLES));
+            bin = std::max(0, bin);
+            height[bin] += f.point.y - minY;
+            curvature[bin] += f.curvature;
+            bank[bin] += std::abs(f.tilt);
+            count[bin]++;
+        }
+        
+        // Scaled by 1/sqrt(samples): a signature's distance is the RMS
+        // difference along the ride, whatever SIGNATURE_SAMPLES is
+        const double weight = 1.0 / std::sqrt(static_cast<double>(SIGNATURE_SAMPLES));
+        for (int b = 0; b < SIGNATURE_SAMPLES; b++) {
+            if (count[b] == 0) {
+                if (b > 0) {
+                    d[HEIGHT_OFFSET + b] = d[HEIGHT_OFFSET + b - 1];
+                    d[CURVATURE_OFFSET + b] = d[CURVATURE_OFFSET + b - 1];
+                    d[BANK_OFFSET + b] = d[BANK_OFFSET + b - 1];
+                }
+                continue;
+            }
+            d[HEIGHT_OFFSET + b] = static_cast<float>(height[b] / count[b] / HEIGHT_SCALE * weight);
+            d[CURVATURE_OFFSET + b] = static_cast<float>(curvature[b] / count[b] / CURVATURE_SCALE * weight);
+            d[BANK_OFFSET + b] = static_cast<float>(bank[b] / count[b] / BANK_SCALE * weight);
+        }
+        
+        // Ride scalars over the frames the train actually reached
+        double maxSpeed = 0, maxG = 0, minVertical = 1, maxVertical = 1, maxLateral = 0, rideTime = 0;
+        double speedSum = 0;
+        size_t airtimeFrames = 0;
+        const size_t reached = std::min<size_t>(ride.reachedFrames, ride.speed.size());
+        if (reached > 0) {
+            minVertical = maxVertical = ride.gVertical[0];
+            rideTime = ride.time[reached - 1];
+        }
+        for (size_t i = 0; i < reached; i++) {
+            maxSpeed = std::max(maxSpeed, static_cast<double>(ride.speed[i]));
+            maxG = std::max(maxG, static_cast<double>(ride.gTotal[i]));
+            minVertical = std::min(minVertical, static_cast<double>(ride.gVertical[i]));
+            maxVertical = std::max(maxVertical, static_cast<double>(ride.gVertical[i]));
+            maxLateral = std::max(maxLateral, std::abs(static_cast<double>(ride.gLateral[i])));
+            speedSum += ride.speed[i];
+            if (ride.gVertical[i] < AIRTIME_ENTER_G) airtimeFrames++;
+        }
+        
+        const double logRatio = std::log(RATIO_SCALE);
+        d[RIDE_OFFSET + 0] = static_cast<float>(std::log(std::max(1.0, model.totalLength + elementLength)) / logRatio);
+        d[RIDE_OFFSET + 1] = static_cast<float>(std::log(std::max(1.0, rideTime)) / logRatio);
+        d[RIDE_OFFSET + 2] = static_cast<float>((maxY - minY) / HEIGHT_SCALE);
+        d[RIDE_OFFSET + 3] = static_cast<float>(maxSpeed / SPEED_SCALE);
+        d[RIDE_OFFSET + 4] = static_cast<float>(maxG / G_SCALE);
+        d[RIDE_OFFSET + 5] = static_cast<float>(minVertical / G_SCALE);
+        d[RIDE_OFFSET + 6] = static_cast<float>(maxVertical / G_SCALE);
+        d[RIDE_OFFSET + 7] = static_cast<float>(maxLateral / G_SCALE);
+        if (reached > 0) {
+            d[RIDE_OFFSET + 8] = static_cast<float>(speedSum / reached / SPEED_SCALE);
+            d[RIDE_OFFSET + 9] = static_cast<float>(static_cast<double>(airtimeFrames) / n / SHARE_SCALE);
+        }
+        d[RIDE_OFFSET + 10] = static_cast<float>(steepestDrop / DROP_SCALE);
+        return d;
+    }
+};
+
+struct SimilarityMatch {
+    std::string id;
+    float distance;     // in TrackDescriptor units
+};
+
+/**
+ * Exact k-nearest-neighbor search over TrackDescriptors. A query is one
+ * scan that keeps the best k in a max-heap. The first BLOCK components of
+ * every row (element counts and ride scalars, which spread designs out the
+ * most) sit in their own contiguous array, one cache line per design; the
+ * rest of a row is only read when its head is nearer than the current
+ * k-th best. Most of the library is rejected on the head alone, which keeps
+ * tens of thousands of designs to a millisecond or two with no build step
+ * and no approximation. Not synchronized: use it from one thread, like the
+ * engine.
+ */
+class SimilarityIndex {
+public:
+    static constexpr int DIMENSIONS = TrackDescriptor::DIMENSIONS;
+    static constexpr int BLOCK = 16;
+    static constexpr int TAIL = DIMENSIONS - BLOCK;
+    static constexpr int LANES = 8;
+    
+    // At or under this distance two designs are the same ride for any
+    // practical purpose (re-saves, nudged points, jittered imports)
+    static constexpr float DUPLICATE_DISTANCE = 0.5f;
+    
+    static_assert(DIMENSIONS % BLOCK == 0 && BLOCK % LANES == 0, "rows are scanned in whole blocks");
+    
+    // Inserts or replaces; false if the descriptor has the wrong length
+    bool add(const std::string& id, const std::vector<float>& descriptor) {
+        if (descriptor.size() != static_cast<size_t>(DIMENSIONS)) return false;
+        auto it = slots.find(id);
+        size_t slot = it != slots.end() ? it->second : ids.size();
+        if (slot == ids.size()) {
+            ids.push_back(id);
+            heads.resize(heads.size() + BLOCK);
+            tails.resize(tails.size() + TAIL);
+            slots[id] = slot;
+        }
+        std::copy(descriptor.begin(), descriptor.begin() + BLOCK, heads.begin() + slot * BLOCK);
+        std::copy(descriptor.begin() + BLOCK, descriptor.end(), tails.begin() + slot * TAIL);
+        return true;
+    }
+    
+    // Moves the last row into the hole, so slots stay dense
+    bool remove(const std::string& id) {
+        auto it = slots.find(id);
+        if (it == slots.end()) return false;
+        size_t slot = it->second, last = ids.size() - 1;
+        slots.erase(it);
+        if (slot != last) {
+            std::copy(heads.begin() + last * BLOCK, heads.end(), heads.begin() + slot * BLOCK);
+            std::copy(tails.begin() + last * TAIL, tails.end(), tails.begin() + slot * TAIL);
+            ids[slot] = std::move(ids[last]);
+            slots[ids[slot]] = slot;
+        }
+        ids.pop_back();
+        heads.resize(last * BLOCK);
+        tails.resize(last * TAIL);
+        return true;
+    }
+    
+    bool contains(const std::string& id) const { return slots.count(id) > 0; }
+    size_t size() const { return ids.size(); }
+    
+    // Empty if `id` isn't indexed
+    std::vector<float> get(const std::string& id) const {
+        auto it = slots.find(id);
+        if (it == slots.end()) return {};
+        std::vector<float> descriptor(heads.begin() + it->second * BLOCK, heads.begin() + (it->second + 1) * BLOCK);
+        descriptor.insert(descriptor.end(), tails.begin() + it->second * TAIL, tails.begin() + (it->second + 1) * TAIL);
+        return descriptor;
+    }
+    
+    // The k nearest rows, closest first. Pass `exclude` to skip the query's
+    // own entry when searching from an indexed design.
+    std::vector<SimilarityMatch> query(const std::vector<float>& descriptor, int k,
+                                       const std::string& exclude = std::string()) const {
+        std::vector<SimilarityMatch> matches;
+        if (descriptor.size() != static_cast<size_t>(DIMENSIONS) || k <= 0) return matches;
+        
+        auto skip = slots.find(exclude);
+        const size_t skipSlot = skip != slots.end() ? skip->second : ids.size();
+        const size_t want = std::min(static_cast<size_t>(k), ids.size() - (skipSlot < ids.size() ? 1 : 0));
+        if (want == 0) return matches;
+        
+        // Max-heap on squared distance; heap.front() is the current k-th best
+        std::vector<std::pair<float, size_t>> heap;
+        heap.reserve(want + 1);
+        float worst = std::numeric_limits<float>::infinity();
+        const float* q = descriptor.data();
+        
+        for (size_t slot = 0; slot < ids.size(); slot++) {
+            if (slot == skipSlot) continue;
+            float sum = blockDistance(heads.data() + slot * BLOCK, q, 0);
+            const float* tail = tails.data() + slot * TAIL;
+            for (int block = 0; block < TAIL && sum < worst; block += BLOCK) {
+                sum = blockDistance(tail + block, q + BLOCK + block, sum);
+            }
+            if (sum >= worst) continue;
+            
+            heap.push_back({ sum, slot });
+            std::push_heap(heap.begin(), heap.end());
+            if (heap.size() > want) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+            if (heap.size() == want) worst = heap.front().first;
+        }
+        
+        std::sort_heap(heap.begin(), heap.end());
+        matches.reserve(heap.size());
+        for (const auto& entry : heap) {
+            matches.push_back({ ids[entry.second], std::sqrt(entry.first) });
+        }
+        return matches;
+    }
+    
+private:
+    std::vector<float> heads;           // BLOCK floats per entry, slot order
+    std::vector<float> tails;           // the other TAIL floats
+    std::vector<std::string> ids;       // by slot
+    std::unordered_map<std::string, size_t> slots;
+    
+    // `sum` plus the squared distance over one block. LANES independent
+    // partial sums: float addition isn't associative, so without them the
+    // compiler can't vectorize the reduction.
+    static float blockDistance(const float* row, const float* q, float sum) {
+        float lanes[LANES] = {};
+        for (int j = 0; j < BLOCK; j += LANES) {
+            for (int l = 0; l < LANES; l++) {
+                float diff = row[j + l] - q[j + l];
+                lanes[l] += diff * diff;
+            }
+        }
+        for (int l = 0; l < LANES; l++) sum += lanes[l];
+        return sum;
+    }
+};
+
+inline std::vector<float> PhysicsEngine::getTrackDescriptor() {
+    std::shared_ptr<const RideProfile> ride = getRideProfile();
+    return TrackDescriptor::compute(*model, *ride);
+}
+
+// ============================================================================
+// Trajectory Codec
+// ============================================================================
+
+// Quantization steps; every channel's reconstruction error is at most half
+// its step. orientationStep applies per stored quaternion component.
+struct TrajectoryCodecOptions {
+    double timeStep = 1e-4;         // seconds
+    double positionStep = 1e-3;     // meters
+    double speedStep = 0.01;        // m/s
+    double gForceStep = 0.01;       // G's
+    double orientationStep = 1e-3;
+    bool smallestThree = true;      // 2-bit index + 3 components instead of 4
+    uint32_t blockSize = 64;        // samples per independently decodable block
+};
+
+/**
+ * Compressed recording of a ride. Samples are grouped into blocks that
+ * each start with a keyframe, so any block decodes on its own; inside a
+ * block every channel is predicted from the previous two quantized values
+ * (constant velocity) and the residuals are range-coded. Layout:
+ *
+ *   "RCTJ" u8 version u8 flags
+ *   f64 steps[5]  u32 sampleCount  u32 blockSize  u32 blockCount
+ *   u32 blockOffsets[blockCount + 1]  f64 blockStartTimes[blockCount]
+ *   block data
+ *
+ * Header fields are little-endian. Offsets are relative to the start of
+ * the block data, so a player can fetch the header, then only the blocks
+ * it needs.
+ */
+class TrajectoryCodec {
+public:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t FLAG_SMALLEST_THREE = 1;
+    static constexpr size_t FIXED_HEADER_SIZE = 6 + 5 * 8 + 3 * 4;
+    static constexpr uint32_t MAX_BLOCK_SIZE = 1u << 16;
+    
+    struct Header {
+        TrajectoryCodecOptions options;
+        uint32_t sampleCount = 0;
+        uint32_t blockCount = 0;
+        std::vector<uint32_t> blockOffsets;
+        std::vector<double> blockStartTimes;
+        size_t dataStart = 0;   // byte offset of block data
+    };
+    
+    static std::vector<uint8_t> encode(const std::vector<TrajectorySample>& samples,
+                                       const TrajectoryCodecOptions& requested) {
+        TrajectoryCodecOptions options = sanitize(requested);
+        uint32_t count = static_cast<uint32_t>(samples.size());
+        uint32_t blockCount = (count + options.blockSize - 1) / options.blockSize;
+        
+        std::vector<uint8_t> data;
+        std::vector<uint32_t> offsets;
+        std::vector<double> startTimes;
+        for (uint32_t b = 0; b < blockCount; b++) {
+            uint32_t first = b * options.blockSize;
+            uint32_t last = std::min(count, first + options.blockSize);
+            offsets.push_back(static_cast<uint32_t>(data.size()));
+            startTimes.push_back(samples[first].time);
+            encodeBlock(samples, first, last, options, data);
+        }
+        offsets.push_back(static_cast<uint32_t>(data.size()));
+        
+        std::vector<uint8_t> out = { 'R', 'C', 'T', 'J', FORMAT_VERSION,
+                                     static_cast<uint8_t>(options.smallestThree ? FLAG_SMALLEST_THREE : 0) };
+        out.reserve(FIXED_HEADER_SIZE + offsets.size() * 4 + startTimes.size() * 8 + data.size());
+        for (double step : { options.timeStep, options.positionStep, options.speedStep,
+                             options.gForceStep, options.orientationStep }) {
+            putRaw(out, step);
+        }
+        putRaw(out, count);
+        putRaw(out, options.blockSize);
+        putRaw(out, blockCount);
+        for (uint32_t offset : offsets) putRaw(out, offset);
+        for (double t : startTimes) putRaw(out, t);
+        out.insert(out.end(), data.begin(), data.end());
+        return out;
+    }
+    
+    // Parses the header and block index. Needs only the bytes up to the
+    // start of block data; returns false if they are missing or malformed.
+    static bool readHeader(const uint8_t* bytes, size_t size, Header& header) {
+        if (size < FIXED_HEADER_SIZE || std::memcmp(bytes, "RCTJ", 4) != 0 ||
+            bytes[4] != FORMAT_VERSION) {
+            return false;
+        }
+        
+        size_t pos = 6;
+        TrajectoryCodecOptions& o = header.options;
+        o.smallestThree = (bytes[5] & FLAG_SMALLEST_THREE) != 0;
+        getRaw(bytes, pos, o.timeStep);
+        getRaw(bytes, pos, o.positionStep);
+        getRaw(bytes, pos, o.speedStep);
+        getRaw(bytes, pos, o.gForceStep);
+        getRaw(bytes, pos, o.orientationStep);
+        getRaw(bytes, pos, header.sampleCount);
+        getRaw(bytes, pos, o.blockSize);
+        getRaw(bytes, pos, header.blockCount);
+        
+        for (double step : { o.timeStep, o.positionStep, o.speedStep, o.gForceStep, o.orientationStep }) {
+            if (!(step > 0) || !std::isfinite(step)) return false;
+        }
+        if (o.blockSize == 0 || o.blockSize > MAX_BLOCK_SIZE ||
+            header.blockCount != (header.sampleCount + o.blockSize - 1) / o.blockSize) {
+            return false;
+        }
+        
+        // Index is (blockCount + 1) u32 offsets plus blockCount f64 times
+        size_t available = size - pos;
+        if (available < 4 || header.blockCount > (available - 4) / 12) return false;
+        
+        header.blockOffsets.resize(header.blockCount + 1);
+        header.blockStartTimes.resize(header.blockCount);
+        for (uint32_t& offset : header.blockOffsets) getRaw(bytes, pos, offset);
+        for (double& t : header.blockStartTimes) getRaw(bytes, pos, t);
+        for (uint32_t b = 0; b < header.blockCount; b++) {
+            if (header.blockOffsets[b + 1] < header.blockOffsets[b]) return false;
+        }
+        
+        header.dataStart = pos;
+        return true;
+    }
+    
+    // Decodes block b from its own bytes (blockOffsets[b] to [b + 1])
+    static bool decodeBlock(const Header& header, uint32_t b, const uint8_t* data, size_t size,
+                            std::vector<TrajectorySample>& out) {
+        const TrajectoryCodecOptions& o = header.options;
+        uint32_t first = b * o.blockSize;
+        uint32_t count = std::min(header.sampleCount - first, o.blockSize);
+        
+        rangecoder::Decoder rc(data, size);
+        BlockModels m;
+        out.resize(count);
+        
+        for (TrajectorySample& s : out) {
+            s.time = m.time.decode(rc) * o.timeStep;
+            s.x = m.x.decode(rc) * o.positionStep;
+            s.y = m.y.decode(rc) * o.positionStep;
+            s.z = m.z.decode(rc) * o.positionStep;
+            s.speed = m.speed.decode(rc) * o.speedStep;
+            s.gForceVertical = m.gVertical.decode(rc) * o.gForceStep;
+            s.gForceLateral = m.gLateral.decode(rc) * o.gForceStep;
+            decodeOrientation(rc, m, o, s);
+        }
+        
+        return !rc.overrun();
+    }
+    
+private:
+    // Integer channel predicted from its last two values. The first sample
+    // of a block has no history, which makes it the keyframe.
+    // Prediction arithmetic wraps modulo 2^64 on both sides: valid streams
+    // round-trip exactly as before, and corrupt residuals decode to garbage
+    // values instead of overflowing int64_t
+    class PredictedChannel {
+    private:
+        rangecoder::IntegerModel model;
+        uint64_t previous = 0;
+        uint64_t velocity = 0;
+        bool primed = false;
+        
+        void advance(uint64_t value) {
+            velocity = primed ? value - previous : 0;
+            previous = value;
+            primed = true;
+        }
+        
+    public:
+        void encode(rangecoder::Encoder& rc, int64_t value) {
+            uint64_t v = static_cast<uint64_t>(value);
+            model.encode(rc, static_cast<int64_t>(v - (previous + velocity)));
+            advance(v);
+        }
+        
+        int64_t decode(rangecoder::Decoder& rc) {
+            uint64_t value = previous + velocity + static_cast<uint64_t>(model.decode(rc));
+            advance(value);
+            return static_cast<int64_t>(value);
+        }
+        
+        // The prediction is meaningless across a change of quaternion layout
+        void resetVelocity() { velocity = 0; }
+    };
+    
+    struct BlockModels {
+        PredictedChannel time, x, y, z, speed, gVertical, gLateral;
+        PredictedChannel quat[4];
+        uint16_t largestTree[4];
+        uint32_t previousLargest = 0;
+        
+        BlockModels() { std::fill(std::begin(largestTree), std::end(largestTree), rangecoder::PROB_INIT); }
+    };
+    
+    static TrajectoryCodecOptions sanitize(TrajectoryCodecOptions o) {
+        const TrajectoryCodecOptions defaults;
+        if (!(o.timeStep > 0)) o.timeStep = defaults.timeStep;
+        if (!(o.positionStep > 0)) o.positionStep = defaults.positionStep;
+        if (!(o.speedStep > 0)) o.speedStep = defaults.speedStep;
+        if (!(o.gForceStep > 0)) o.gForceStep = defaults.gForceStep;
+        if (!(o.orientationStep > 0)) o.orientationStep = defaults.orientationStep;
+        o.blockSize = std::max(1u, std::min(MAX_BLOCK_SIZE, o.blockSize));
+        return o;
+    }
+    
+    static int64_t quantize(double value, double step) {
+        if (!std::isfinite(value)) return 0;
+        return static_cast<int64_t>(std::llround(std::max(-1e15, std::min(1e15, value / step))));
+    }
+    
+    static void encodeBlock(const std::vector<TrajectorySample>& samples, uint32_t first, uint32_t last,
+                            const TrajectoryCodecOptions& o, std::vector<uint8_t>& out) {
+        rangecoder::Encoder rc(out);
+        BlockModels m;
+        
+        for (uint32_t i = first; i < last; i++) {
+            const TrajectorySample& s = samples[i];
+            m.time.encode(rc, quantize(s.time, o.timeStep));
+            m.x.encode(rc, quantize(s.x, o.positionStep));
+            m.y.encode(rc, quantize(s.y, o.positionStep));
+            m.z.encode(rc, quantize(s.z, o.positionStep));
+            m.speed.encode(rc, quantize(s.speed, o.speedStep));
+            m.gVertical.encode(rc, quantize(s.gForceVertical, o.gForceStep));
+            m.gLateral.encode(rc, quantize(s.gForceLateral, o.gForceStep));
+            encodeOrientation(rc, m, o, s);
+        }
+        
+        rc.flush();
+    }
+    
+    // Smallest-three: q and -q are the same rotation, so flip the largest
+    // component positive, send its index and the other three, and rebuild
+    // it from the unit norm on decode
+    static void encodeOrientation(rangecoder::Encoder& rc, BlockModels& m,
+                                  const TrajectoryCodecOptions& o, const TrajectorySample& s) {
+        double q[4] = { s.qx, s.qy, s.qz, s.qw };
+        
+        if (!o.smallestThree) {
+            for (int c = 0; c < 4; c++) m.quat[c].encode(rc, quantize(q[c], o.orientationStep));
+            return;
+        }
+        
+        uint32_t largest = 0;
+        for (uint32_t c = 1; c < 4; c++) {
+            if (std::abs(q[c]) > std::abs(q[largest])) largest = c;
+        }
+        double sign = q[largest] < 0 ? -1.0 : 1.0;
+        
+        rc.encodeBit(m.largestTree[1], largest >> 1);
+        rc.encodeBit(m.largestTree[2 + (largest >> 1)], largest & 1);
+        if (largest != m.previousLargest) {
+            for (auto& channel : m.quat) channel.resetVelocity();
+            m.previousLargest = largest;
+        }
+        
+        for (uint32_t c = 0, slot = 0; c < 4; c++) {
+            if (c == largest) continue;
+            m.quat[slot++].encode(rc, quantize(sign * q[c], o.orientationStep));
+        }
+    }
+    
+    static void decodeOrientation(rangecoder::Decoder& rc, BlockModels& m,
+                                  const TrajectoryCodecOptions& o, TrajectorySample& s) {
+        double q[4];
+        
+        if (!o.smallestThree) {
+            for (int c = 0; c < 4; c++) q[c] = m.quat[c].decode(rc) * o.orientationStep;
+        } else {
+            uint32_t high = rc.decodeBit(m.largestTree[1]);
+            uint32_t largest = (high << 1) | rc.decodeBit(m.largestTree[2 + high]);
+            if (largest != m.previousLargest) {
+                for (auto& channel : m.quat) channel.resetVelocity();
+                m.previousLargest = largest;
+            }
+            
+            double sumSq = 0;
+            for (uint32_t c = 0, slot = 0; c < 4; c++) {
+                if (c == largest) continue;
+                q[c] = m.quat[slot++].decode(rc) * o.orientationStep;
+                sumSq += q[c] * q[c];
+            }
+            q[largest] = std::sqrt(std::max(0.0, 1.0 - sumSq));
+        }
+        
+        double len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (len < 1e-12) {
+            q[0] = q[1] = q[2] = 0;
+            q[3] = len = 1;
+        }
+        s.qx = q[0] / len;
+        s.qy = q[1] / len;
+        s.qz = q[2] / len;
+        s.qw = q[3] / len;
+    }
+    
+    template <typename T>
+    static void putRaw(std::vector<uint8_t>& out, T value) {
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+    
+    template <typename T>
+    static void getRaw(const uint8_t* bytes, size_t& pos, T& value) {
+        std::memcpy(&value, bytes + pos, sizeof(T));
+        pos += sizeof(T);
+    }
+};
+
+/**
+ * Random access into an encoded trajectory by time. Bytes can be appended
+ * as they stream in; a time is playable once the block containing it (and
+ * the start of the next, for interpolation) has arrived. Decoded blocks
+ * are cached, so sequential playback decodes each block once.
+ */
+class TrajectoryReader {
+private:
+    std::vector<uint8_t> bytes;
+    TrajectoryCodec::Header header;
+    bool headerValid = false;
+    bool corrupt = false;
+    
+    // Two decoded blocks: interpolation near a boundary touches both
+    struct CachedBlock {
+        int64_t index = -1;
+        std::vector<TrajectorySample> samples;
+    };
+    CachedBlock cache[2];
+    uint32_t nextEvict = 0;
+    
+public:
+    void append(const std::vector<uint8_t>& chunk) {
+        bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+        if (!headerValid && !corrupt) {
+            headerValid = TrajectoryCodec::readHeader(bytes.data(), bytes.size(), header);
+            
+            // Magic or version is wrong: not a trajectory this build reads,
+            // however many more bytes arrive
+            if (!headerValid && bytes.size() >= 5 &&
+                (std::memcmp(bytes.data(), "RCTJ", 4) != 0 ||
+                 bytes[4] != TrajectoryCodec::FORMAT_VERSION)) {
+                corrupt = true;
+            }
+        }
+    }
+    
+    bool isValid() const { return headerValid && !corrupt; }
+    uint32_t getSampleCount() const { return headerValid ? header.sampleCount : 0; }
+    uint32_t getBlockCount() const { return headerValid ? header.blockCount : 0; }
+    
+    double getStartTime() const {
+        return headerValid && header.blockCount > 0 ? header.blockStartTimes[0] : 0;
+    }
+    
+    // Time of the last sample whose block has fully arrived
+    double getLoadedEndTime() {
+        uint32_t loaded = loadedBlockCount();
+        if (loaded == 0) return getStartTime();
+        const std::vector<TrajectorySample>* block = decoded(loaded - 1);
+        return block && !block->empty() ? block->back().time : getStartTime();
+    }
+    
+    // Interpolated sample at `time`, clamped to what has loaded so far
+    TrajectorySample sampleAt(double time) {
+        uint32_t loaded = loadedBlockCount();
+        if (loaded == 0) return TrajectorySample();
+        
+        const std::vector<double>& starts = header.blockStartTimes;
+        auto it = std::upper_bound(starts.begin(), starts.begin() + loaded, time);
+        uint32_t b = it == starts.begin() ? 0 : static_cast<uint32_t>(it - starts.begin()) - 1;
+        
+        const std::vector<TrajectorySample>* block = decoded(b);
+        if (!block || block->empty()) return TrajectorySample();
+        const std::vector<TrajectorySample>& current = *block;
+        
+        if (time <= current.front().time) return current.front();
+        
+        auto after = std::upper_bound(current.begin(), current.end(), time,
+            [](double t, const TrajectorySample& s) { return t < s.time; });
+        if (after != current.end()) {
+            const TrajectorySample& a = *(after - 1);
+            return TrajectorySample::lerp(a, *after, (time - a.time) / (after->time - a.time));
+        }
+        
+        // Past this block's last sample: blend toward the next block's first
+        if (b + 1 < loaded) {
+            const std::vector<TrajectorySample>* next = decoded(b + 1);
+            if (next && !next->empty()) {
+                const TrajectorySample& a = current.back();
+                const TrajectorySample& n = next->front();
+                double span = n.time - a.time;
+                return span > 0 ? TrajectorySample::lerp(a, n, std::min(1.0, (time - a.time) / span)) : n;
+            }
+        }
+        return current.back();
+    }
+    
+private:
+    uint32_t loadedBlockCount() const {
+        if (!isValid()) return 0;
+        size_t available = bytes.size() - header.dataStart;
+        auto end = std::upper_bound(header.blockOffsets.begin() + 1, header.blockOffsets.end(),
+                                    static_cast<uint32_t>(std::min<size_t>(available, UINT32_MAX)));
+        return static_cast<uint32_t>(end - (header.blockOffsets.begin() + 1));
+    }
+    
+    const std::vector<TrajectorySample>* decoded(uint32_t b) {
+        // Least recently used slot goes first, so the block being
+        // interpolated from survives decoding its successor
+        for (uint32_t i = 0; i < 2; i++) {
+            if (cache[i].index == b) {
+                nextEvict = i ^ 1;
+                return &cache[i].samples;
+            }
+        }
+        
+        CachedBlock& slot = cache[nextEvict];
+        nextEvict ^= 1;
+        const uint8_t* start = bytes.data() + header.dataStart + header.blockOffsets[b];
+        size_t size = header.blockOffsets[b + 1] - header.blockOffsets[b];
+        if (!TrajectoryCodec::decodeBlock(header, b, start, size, slot.samples)) {
+            slot.index = -1;
+            corrupt = true;
+            return nullptr;
+        }
+        slot.index = b;
+        return &slot.samples;
     }
 };
 
@@ -735,10 +5424,120 @@ public:
     }
 };
 
+#ifdef __EMSCRIPTEN__
+
 // ============================================================================
 // Emscripten Bindings
 // ============================================================================
 
+// Typed-array views straight onto the control stream in WASM memory. In the
+// pthreads build these are backed by a SharedArrayBuffer that can be handed
+// to an AudioWorklet. Views detach when memory grows; fetch them again then.
+template <typename Owner>
+val getControlFramesView(Owner& owner) {
+    return val(typed_memory_view(ControlStream::CAPACITY * CONTROL_CHANNEL_COUNT,
+                                 owner.getControlStream().data()));
+}
+
+template <typename Owner>
+val getControlHeadView(Owner& owner) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "head must be a plain u32");
+    return val(typed_memory_view(1, reinterpret_cast<const uint32_t*>(
+        owner.getControlStream().headAddress())));
+}
+
+// Encoded bytes are copied into a fresh Uint8Array; a view onto the
+// temporary vector would dangle as soon as this returns
+val encodeTrack(const SavedTrack& track) {
+    std::vector<uint8_t> bytes = TrackCodec::encode(track);
+    return val::global("Uint8Array").new_(typed_memory_view(bytes.size(), bytes.data()));
+}
+
+bool decodeTrack(const val& bytes, SavedTrack& out) {
+    std::vector<uint8_t> data = convertJSArrayToNumberVector<uint8_t>(bytes);
+    return TrackCodec::decode(data.data(), data.size(), out);
+}
+
+std::string computeTrackFingerprint(const std::vector<TrackPointData>& points, bool isLooped, bool chainLift) {
+    return TrackFingerprint::toHex(TrackFingerprint::compute(points, isLooped, chainLift));
+}
+
+val encodeTrajectory(const std::vector<TrajectorySample>& samples, const TrajectoryCodecOptions& options) {
+    std::vector<uint8_t> bytes = TrajectoryCodec::encode(samples, options);
+    return val::global("Uint8Array").new_(typed_memory_view(bytes.size(), bytes.data()));
+}
+
+// Polylines are copied out so they stay valid across later calls and
+// memory growth
+val toFloat32Array(const std::vector<float>& data) {
+    return val::global("Float32Array").new_(typed_memory_view(data.size(), data.data()));
+}
+
+val getMinimapPolylineArray(PhysicsEngine& engine, double toleranceMeters) {
+    return toFloat32Array(engine.getMinimapPolyline(toleranceMeters));
+}
+
+val getVertexAttributeArray(PhysicsEngine& engine, int attribute, int samplesPerSegment) {
+    return toFloat32Array(engine.getVertexAttribute(attribute, samplesPerSegment));
+}
+
+val getElevationProfileArray(PhysicsEngine& engine, double pxPerMeter, double pxPerMeterY, double tolerancePx) {
+    return toFloat32Array(engine.getElevationProfile(pxPerMeter, pxPerMeterY, tolerancePx));
+}
+
+val getBankingProfileArray(PhysicsEngine& engine, double pxPerMeter, double pxPerDegree, double tolerancePx) {
+    return toFloat32Array(engine.getBankingProfile(pxPerMeter, pxPerDegree, tolerancePx));
+}
+
+val getCurvatureCombArray(PhysicsEngine& engine, double pxPerMeter, double spacingPx) {
+    return toFloat32Array(engine.getCurvatureComb(pxPerMeter, spacingPx));
+}
+
+// Steps return nothing to JS; a PhysicsState handle per step would have to
+// be deleted by the caller. Read the state through the getters or
+// readSnapshot() instead.
+void stepEngine(PhysicsEngine& engine, double dt) {
+    engine.step(dt);
+}
+
+val getTrackTablesArray(const PhysicsEngine& engine) {
+    std::vector<uint8_t> bytes = engine.getTrackTables();
+    return val::global("Uint8Array").new_(typed_memory_view(bytes.size(), bytes.data()));
+}
+
+bool setTrackFromTablesBytes(PhysicsEngine& engine, const std::vector<TrackPointData>& points,
+                             bool isLooped, const val& tables) {
+    std::vector<uint8_t> data = convertJSArrayToNumberVector<uint8_t>(tables);
+    return engine.setTrackFromTables(points, isLooped, data.data(), data.size());
+}
+
+bool beginTrackBuildFromTablesBytes(PhysicsEngine& engine, const std::vector<TrackPointData>& points,
+                                    bool isLooped, const val& tables) {
+    std::vector<uint8_t> data = convertJSArrayToNumberVector<uint8_t>(tables);
+    return engine.beginTrackBuildFromTables(points, isLooped, data.data(), data.size());
+}
+
+val getTrackDescriptorArray(PhysicsEngine& engine) {
+    return toFloat32Array(engine.getTrackDescriptor());
+}
+
+bool addSimilarityDescriptor(SimilarityIndex& index, const std::string& id, const val& descriptor) {
+    return index.add(id, convertJSArrayToNumberVector<float>(descriptor));
+}
+
+val getSimilarityDescriptor(const SimilarityIndex& index, const std::string& id) {
+    return toFloat32Array(index.get(id));
+}
+
+std::vector<SimilarityMatch> querySimilarityIndex(const SimilarityIndex& index, const val& descriptor,
+                                                  int k, const std::string& exclude) {
+    return index.query(convertJSArrayToNumberVector<float>(descriptor), k, exclude);
+}
+
+void appendTrajectoryBytes(TrajectoryReader& reader, const val& chunk) {
+    reader.append(convertJSArrayToNumberVector<uint8_t>(chunk));
+}
+
 EMSCRIPTEN_BINDINGS(physics_engine) {
     // Vec3 class
     class_<Vec3>("Vec3")
@@ -784,19 +5583,48 @@ EMSCRIPTEN_BINDINGS(physics_engine) {
         .property("curvature", &TrackSample::curvature)
         .property("grade", &TrackSample::grade);
     
-    // ValidationResult struct  
-    class_<ValidationResult>("ValidationResult")
-        .property("isValid", &ValidationResult::isValid)
-        .property("message", &ValidationResult::message)
-        .property("severity", &ValidationResult::severity)
-        .property("pointIndex", &ValidationResult::pointIndex)
-        .property("value", &ValidationResult::value);
+    // RideEvent struct
+    class_<RideEvent>("RideEvent")
+        .property("type", &RideEvent::type)
+        .property("time", &RideEvent::time)
+        .property("arcLength", &RideEvent::arcLength)
+        .property("progress", &RideEvent::progress)
+        .property("value", &RideEvent::value);
     
-    // PhysicsEngine class
-    class_<PhysicsEngine>("PhysicsEngine")
+    // Load, friction and wind applied by step()
+    value_object<RideConditions>("RideConditions")
+        .field("dragScale", &RideConditions::dragScale)
+        .field("frictionScale", &RideConditions::frictionScale)
+        .field("windX", &RideConditions::windX)
+        .field("windZ", &RideConditions::windZ);
+    
+    // PhysicsEngine class: riding, seeking and the output streams. Editor
+    // and analysis methods are added below outside the ride-only build.
+    class_<PhysicsEngine> engine("PhysicsEngine");
+    engine
         .constructor<>()
+        .function("setTrack", &PhysicsEngine::setTrack)
+        .function("setTrackFromTables", &setTrackFromTablesBytes)
+        .function("beginTrackBuild", &PhysicsEngine::beginTrackBuild)
+        .function("beginTrackBuildFromTables", &beginTrackBuildFromTablesBytes)
+        .function("pumpTrackBuild", &PhysicsEngine::pumpTrackBuild)
+        .function("isTrackBuildPending", &PhysicsEngine::isTrackBuildPending)
+        .function("getTrackVersion", &PhysicsEngine::getTrackVersion)
+        .function("getTrackLength", &PhysicsEngine::getTrackLength)
+        .function("getFrameChunkCount", &PhysicsEngine::getFrameChunkCount)
+        .function("getBuiltFrameChunkCount", &PhysicsEngine::getBuiltFrameChunkCount)
+        .function("setSpeedProfileStep", &PhysicsEngine::setSpeedProfileStep)
+        .function("getSpeedProfileStep", &PhysicsEngine::getSpeedProfileStep)
+        .function("getSpeedAtProgress", &PhysicsEngine::getSpeedAtProgress)
+        .function("getSpeedAtDistance", &PhysicsEngine::getSpeedAtDistance)
+        .function("getRideDuration", &PhysicsEngine::getRideDuration)
+        .function("seekToTime", &PhysicsEngine::seekToTime)
+        .function("seekToDistance", &PhysicsEngine::seekToDistance)
         .function("setChainLift", &PhysicsEngine::setChainLift)
+        .function("setRideConditions", &PhysicsEngine::setRideConditions)
+        .function("getRideConditions", &PhysicsEngine::getRideConditions)
         .function("reset", &PhysicsEngine::reset)
+        .function("step", &stepEngine)
         .function("getSpeed", &PhysicsEngine::getSpeed)
         .function("getGForceVertical", &PhysicsEngine::getGForceVertical)
         .function("getGForceLateral", &PhysicsEngine::getGForceLateral)
@@ -811,19 +5639,265 @@ EMSCRIPTEN_BINDINGS(physics_engine) {
         .function("getVelocityX", &PhysicsEngine::getVelocityX)
         .function("getVelocityY", &PhysicsEngine::getVelocityY)
         .function("getVelocityZ", &PhysicsEngine::getVelocityZ)
+        .function("readSnapshot", &PhysicsEngine::readSnapshot)
+        .function("getSnapshotVersion", &PhysicsEngine::getSnapshotVersion)
+        .function("drainEvents", &PhysicsEngine::drainEvents)
+        .function("getDroppedEventCount", &PhysicsEngine::getDroppedEventCount)
+        .function("setControlRate", &PhysicsEngine::setControlRate)
+        .function("getControlHead", &PhysicsEngine::getControlHead)
+        .function("getControlCapacity", &PhysicsEngine::getControlCapacity)
+        .function("getControlChannels", &PhysicsEngine::getControlChannels)
+        .function("getControlFramesView", &getControlFramesView<PhysicsEngine>)
+        .function("getControlHeadView", &getControlHeadView<PhysicsEngine>)
         .function("setProgress", &PhysicsEngine::setProgress)
         .function("setSpeed", &PhysicsEngine::setSpeed);
     
     // Vector registration for arrays
     register_vector<TrackPointData>("TrackPointDataVector");
-    register_vector<ValidationResult>("ValidationResultVector");
+    register_vector<RideEvent>("RideEventVector");
     register_vector<Vec3>("Vec3Vector");
     
+#if PHYSICS_HAS_THREADS
+    // SimulationHost (pthreads build only)
+    class_<SimulationHost>("SimulationHost")
+        .constructor<>()
+        .function("start", &SimulationHost::start)
+        .function("stop", &SimulationHost::stop)
+        .function("isRunning", &SimulationHost::isRunning)
+        .function("getSnapshot", &SimulationHost::getSnapshot)
+        .function("getSnapshotVersion", &SimulationHost::getSnapshotVersion)
+        .function("drainEvents", &SimulationHost::drainEvents)
+        .function("setControlRate", &SimulationHost::setControlRate)
+        .function("getControlFramesView", &getControlFramesView<SimulationHost>)
+        .function("getControlHeadView", &getControlHeadView<SimulationHost>)
+        .function("setTrack", &SimulationHost::setTrack)
+        .function("setChainLift", &SimulationHost::setChainLift)
+        .function("setRideConditions", &SimulationHost::setRideConditions)
+        .function("reset", &SimulationHost::reset)
+        .function("setSpeed", &SimulationHost::setSpeed)
+        .function("setProgress", &SimulationHost::setProgress)
+        .function("getRingStatesPointer", &SimulationHost::getRingStatesPointer)
+        .function("getRingHeadPointer", &SimulationHost::getRingHeadPointer)
+        .function("getRingCapacity", &SimulationHost::getRingCapacity)
+        .function("getRecordStride", &SimulationHost::getRecordStride);
+#endif
+    
+    // Playback of encoded rides
+    value_object<TrajectorySample>("TrajectorySample")
+        .field("time", &TrajectorySample::time)
+        .field("x", &TrajectorySample::x)
+        .field("y", &TrajectorySample::y)
+        .field("z", &TrajectorySample::z)
+        .field("qx", &TrajectorySample::qx)
+        .field("qy", &TrajectorySample::qy)
+        .field("qz", &TrajectorySample::qz)
+        .field("qw", &TrajectorySample::qw)
+        .field("speed", &TrajectorySample::speed)
+        .field("gForceVertical", &TrajectorySample::gForceVertical)
+        .field("gForceLateral", &TrajectorySample::gForceLateral);
+    
+    class_<TrajectoryReader>("TrajectoryReader")
+        .constructor<>()
+        .function("append", &appendTrajectoryBytes)
+        .function("isValid", &TrajectoryReader::isValid)
+        .function("getSampleCount", &TrajectoryReader::getSampleCount)
+        .function("getBlockCount", &TrajectoryReader::getBlockCount)
+        .function("getStartTime", &TrajectoryReader::getStartTime)
+        .function("getLoadedEndTime", &TrajectoryReader::getLoadedEndTime)
+        .function("sampleAt", &TrajectoryReader::sampleAt);
+    
+#ifndef PHYSICS_RIDE_CORE
+    // ---- Editor and analysis (left out of physics_engine_core) ----
+    
+    // TrackStats struct
+    class_<TrackStats>("TrackStats")
+        .property("totalLength", &TrackStats::totalLength)
+        .property("elementLength", &TrackStats::elementLength)
+        .property("minHeight", &TrackStats::minHeight)
+        .property("maxHeight", &TrackStats::maxHeight)
+        .property("maxGrade", &TrackStats::maxGrade)
+        .property("maxBank", &TrackStats::maxBank)
+        .property("inversions", &TrackStats::inversions)
+        .property("elements", &TrackStats::elements)
+        .property("rideTime", &TrackStats::rideTime)
+        .property("maxSpeed", &TrackStats::maxSpeed)
+        .property("maxGForce", &TrackStats::maxGForce)
+        .property("rideCompleted", &TrackStats::rideCompleted);
+    
+    // StallPrediction struct
+    value_object<StallPrediction>("StallPrediction")
+        .field("outcome", &StallPrediction::outcome)
+        .field("stallProgress", &StallPrediction::stallProgress)
+        .field("hillPoint", &StallPrediction::hillPoint)
+        .field("shortfall", &StallPrediction::shortfall)
+        .field("swings", &StallPrediction::swings)
+        .field("restProgress", &StallPrediction::restProgress)
+        .field("minSpeed", &StallPrediction::minSpeed)
+        .field("minSpeedProgress", &StallPrediction::minSpeedProgress);
+    
+    // EnergySection struct
+    value_object<EnergySection>("EnergySection")
+        .field("startProgress", &EnergySection::startProgress)
+        .field("endProgress", &EnergySection::endProgress)
+        .field("length", &EnergySection::length)
+        .field("entryHeight", &EnergySection::entryHeight)
+        .field("peakHeight", &EnergySection::peakHeight)
+        .field("peakDistance", &EnergySection::peakDistance)
+        .field("entrySpeed", &EnergySection::entrySpeed)
+        .field("exitSpeed", &EnergySection::exitSpeed)
+        .field("dragLoss", &EnergySection::dragLoss)
+        .field("frictionLoss", &EnergySection::frictionLoss)
+        .field("dragToPeak", &EnergySection::dragToPeak)
+        .field("liftGain", &EnergySection::liftGain)
+        .field("margin", &EnergySection::margin)
+        .field("chainLifted", &EnergySection::chainLifted)
+        .field("reached", &EnergySection::reached);
+    
+    // TrackFeature struct
+    value_object<TrackFeature>("TrackFeature")
+        .field("kind", &TrackFeature::kind)
+        .field("startProgress", &TrackFeature::startProgress)
+        .field("endProgress", &TrackFeature::endProgress)
+        .field("startDistance", &TrackFeature::startDistance)
+        .field("endDistance", &TrackFeature::endDistance)
+        .field("heightChange", &TrackFeature::heightChange)
+        .field("turnAngle", &TrackFeature::turnAngle)
+        .field("maxCurvature", &TrackFeature::maxCurvature)
+        .field("maxTorsion", &TrackFeature::maxTorsion)
+        .field("maxBank", &TrackFeature::maxBank)
+        .field("minVerticalG", &TrackFeature::minVerticalG);
+    
+    // Monte Carlo robustness
+    value_object<RobustnessOptions>("RobustnessOptions")
+        .field("samples", &RobustnessOptions::samples)
+        .field("seed", &RobustnessOptions::seed)
+        .field("threads", &RobustnessOptions::threads)
+        .field("minOccupancy", &RobustnessOptions::minOccupancy)
+        .field("maxOccupancy", &RobustnessOptions::maxOccupancy)
+        .field("frictionSigma", &RobustnessOptions::frictionSigma)
+        .field("meanWindSpeed", &RobustnessOptions::meanWindSpeed);
+    
+    value_object<RobustnessSection>("RobustnessSection")
+        .field("startProgress", &RobustnessSection::startProgress)
+        .field("endProgress", &RobustnessSection::endProgress)
+        .field("reachProbability", &RobustnessSection::reachProbability)
+        .field("stallProbability", &RobustnessSection::stallProbability)
+        .field("exceedanceProbability", &RobustnessSection::exceedanceProbability)
+        .field("maxVerticalG", &RobustnessSection::maxVerticalG)
+        .field("minVerticalG", &RobustnessSection::minVerticalG)
+        .field("maxLateralG", &RobustnessSection::maxLateralG);
+    
+    register_vector<RobustnessSection>("RobustnessSectionVector");
+    
+    value_object<RobustnessReport>("RobustnessReport")
+        .field("samples", &RobustnessReport::samples)
+        .field("stallProbability", &RobustnessReport::stallProbability)
+        .field("exceedanceProbability", &RobustnessReport::exceedanceProbability)
+        .field("sections", &RobustnessReport::sections);
+    
+    // ValidationResult struct  
+    class_<ValidationResult>("ValidationResult")
+        .property("isValid", &ValidationResult::isValid)
+        .property("message", &ValidationResult::message)
+        .property("severity", &ValidationResult::severity)
+        .property("pointIndex", &ValidationResult::pointIndex)
+        .property("value", &ValidationResult::value);
+    
+    // Core models skip validation, so only the full engine writes tables
+    engine
+        .function("getTrackTables", &getTrackTablesArray)
+        .function("getValidation", &PhysicsEngine::getValidation)
+        .function("getTrackStats", &PhysicsEngine::getTrackStats)
+        .function("getTrackFeatures", &PhysicsEngine::getTrackFeatures)
+        .function("recordRide", &PhysicsEngine::recordRide)
+        .function("simulateRobustness", &PhysicsEngine::simulateRobustness)
+        .function("getMinimapPolyline", &getMinimapPolylineArray)
+        .function("getVertexAttribute", &getVertexAttributeArray)
+        .function("getEnergySections", &PhysicsEngine::getEnergySections)
+        .function("predictStall", &PhysicsEngine::predictStall)
+        .function("getTrackFingerprint", &PhysicsEngine::getTrackFingerprint)
+        .function("getTrackDescriptor", &getTrackDescriptorArray)
+        .function("canClearSection", &PhysicsEngine::canClearSection)
+        .function("getClearanceMargin", &PhysicsEngine::getClearanceMargin)
+        .function("getFirstStallSection", &PhysicsEngine::getFirstStallSection)
+        .function("getElevationProfile", &getElevationProfileArray)
+        .function("getBankingProfile", &getBankingProfileArray)
+        .function("getCurvatureComb", &getCurvatureCombArray);
+    
+    register_vector<ValidationResult>("ValidationResultVector");
+    register_vector<EnergySection>("EnergySectionVector");
+    register_vector<TrackFeature>("TrackFeatureVector");
+    
     // TrackValidator static methods
     class_<TrackValidator>("TrackValidator")
         .class_function("validate", &TrackValidator::validate);
     
+    // Saved track format
+    value_object<SavedTrackPoint>("SavedTrackPoint")
+        .field("x", &SavedTrackPoint::x)
+        .field("y", &SavedTrackPoint::y)
+        .field("z", &SavedTrackPoint::z)
+        .field("tilt", &SavedTrackPoint::tilt);
+    
+    value_object<SavedTrackElement>("SavedTrackElement")
+        .field("pointIndex", &SavedTrackElement::pointIndex)
+        .field("type", &SavedTrackElement::type)
+        .field("radius", &SavedTrackElement::radius)
+        .field("pitch", &SavedTrackElement::pitch)
+        .field("rotation", &SavedTrackElement::rotation)
+        .field("leftHanded", &SavedTrackElement::leftHanded);
+    
+    register_vector<SavedTrackPoint>("SavedTrackPointVector");
+    register_vector<SavedTrackElement>("SavedTrackElementVector");
+    
+    class_<SavedTrack>("SavedTrack")
+        .constructor<>()
+        .property("points", &SavedTrack::points)
+        .property("elements", &SavedTrack::elements)
+        .property("isLooped", &SavedTrack::isLooped);
+    
+    class_<TrackCodec>("TrackCodec")
+        .class_function("encode", &encodeTrack)
+        .class_function("decode", &decodeTrack);
+    
+    // Trajectory codec
+    value_object<TrajectoryCodecOptions>("TrajectoryCodecOptions")
+        .field("timeStep", &TrajectoryCodecOptions::timeStep)
+        .field("positionStep", &TrajectoryCodecOptions::positionStep)
+        .field("speedStep", &TrajectoryCodecOptions::speedStep)
+        .field("gForceStep", &TrajectoryCodecOptions::gForceStep)
+        .field("orientationStep", &TrajectoryCodecOptions::orientationStep)
+        .field("smallestThree", &TrajectoryCodecOptions::smallestThree)
+        .field("blockSize", &TrajectoryCodecOptions::blockSize);
+    
+    register_vector<TrajectorySample>("TrajectorySampleVector");
+    
+    class_<TrackFingerprint>("TrackFingerprint")
+        .class_function("compute", &computeTrackFingerprint);
+    
+    class_<TrajectoryCodec>("TrajectoryCodec")
+        .class_function("encode", &encodeTrajectory);
+    
+    // Similarity search over descriptors
+    value_object<SimilarityMatch>("SimilarityMatch")
+        .field("id", &SimilarityMatch::id)
+        .field("distance", &SimilarityMatch::distance);
+    
+    register_vector<SimilarityMatch>("SimilarityMatchVector");
+    
+    class_<SimilarityIndex>("SimilarityIndex")
+        .constructor<>()
+        .function("add", &addSimilarityDescriptor)
+        .function("remove", &SimilarityIndex::remove)
+        .function("contains", &SimilarityIndex::contains)
+        .function("get", &getSimilarityDescriptor)
+        .function("size", &SimilarityIndex::size)
+        .function("query", &querySimilarityIndex);
+    
     // CollisionDetector static methods
     class_<CollisionDetector>("CollisionDetector")
         .class_function("checkGroundCollision", &CollisionDetector::checkGroundCollision);
+#endif // PHYSICS_RIDE_CORE
 }
+
+#endif // __EMSCRIPTEN__
@@ -1,5 +1,6 @@
 import express, { type Request, Response, NextFunction } from "express";
 import { registerRoutes } from "./routes";
+import { checkReferenceTrack, getPhysicsAddon } from "./physicsAddon";
 import { serveStatic } from "./static";
 import { createServer } from "http";
 
@@ -7,6 +8,9 @@ const app = express();
 const httpServer = createServer(app);
 
 // Security: Limit JSON body size to prevent DoS attacks
+// Batch analysis takes up to 1000 tracks; parsed here first so the
+// general limit below skips it
+app.use('/api/analyze/batch', express.json({ limit: '32mb' }));
 app.use(express.json({ limit: '1mb' }));
 app.use(express.urlencoded({ extended: false, limit: '1mb' }));
 
@@ -18,6 +22,18 @@ app.use((_req, res, next) => {
   next();
 });
 
+// Cross-origin isolation for the app page and the engine scripts its
+// workers load: the threaded physics engine (usePhysicsSimulation) needs
+// SharedArrayBuffer. Every resource the app loads is same-origin, so
+// require-corp blocks nothing; a cross-origin asset would need CORP/CORS.
+app.use((req, res, next) => {
+  if (!req.path.startsWith('/api')) {
+    res.setHeader('Cross-Origin-Opener-Policy', 'same-origin');
+    res.setHeader('Cross-Origin-Embedder-Policy', 'require-corp');
+  }
+  next();
+});
+
 export function log(message: string, source = "express") {
   const formattedTime = new Date().toLocaleTimeString("en-US", {
     hour: "numeric",
@@ -58,6 +74,13 @@ app.use((req, res, next) => {
 (async () => {
   await registerRoutes(httpServer, app);
 
+  const physics = getPhysicsAddon();
+  if (physics) {
+    checkReferenceTrack(physics).catch((err) => {
+      console.error("Physics addon reference track check failed:", err);
+    });
+  }
+
   app.use((err: any, _req: Request, res: Response, _next: NextFunction) => {
     const status = err.status || err.statusCode || 500;
     const message = err.message || "Internal Server Error";
@@ -0,0 +1,319 @@
+import { createHash } from "crypto";
+import { createRequire } from "module";
+import path from "path";
+import {
+  trackSubmissionSchema,
+  type SimilarTrackQuery,
+  type TrackPointInput,
+  type TrackSubmission,
+} from "@shared/schema";
+import { storage } from "./storage";
+
+/**
+ * Native physics engine for the server: the C++ core built as a Node-API
+ * addon (native/node_addon.cpp, `npm run build:addon`). Every call runs on
+ * libuv's thread pool and resolves a Promise, so analysis never blocks the
+ * event loop. The addon is optional; callers get null when it isn't built.
+ */
+
+export interface ValidationResult {
+  isValid: boolean;
+  message: string;
+  severity: number; // 0 = info, 1 = warning, 2 = error
+  pointIndex: number;
+  value: number;
+}
+
+export interface TrackStats {
+  totalLength: number;
+  elementLength: number;
+  minHeight: number;
+  maxHeight: number;
+  maxGrade: number;
+  maxBank: number;
+  inversions: number;
+  elements: number;
+  rideTime: number;
+  maxSpeed: number;
+  maxGForce: number;
+  rideCompleted: boolean;
+}
+
+export interface StallPrediction {
+  outcome: number; // 0 none, 1 settles, 2 chain catch, 3 station
+  stallProgress: number;
+  hillPoint: number;
+  shortfall: number;
+  swings: number;
+  restProgress: number;
+  minSpeed: number;
+  minSpeedProgress: number;
+}
+
+export interface TrackAnalysis {
+  stats: TrackStats;
+  validation: ValidationResult[];
+  stall: StallPrediction;
+}
+
+export interface RobustnessOptions {
+  samples?: number;
+  seed?: number;
+  threads?: number; // 0 or absent: one per core
+  minOccupancy?: number;
+  maxOccupancy?: number;
+  frictionSigma?: number;
+  meanWindSpeed?: number; // m/s
+}
+
+// Probabilities are fractions of all samples; G extremes are the worst
+// over every sample that reached the section
+export interface RobustnessSection {
+  startProgress: number;
+  endProgress: number;
+  reachProbability: number;
+  stallProbability: number;
+  exceedanceProbability: number;
+  maxVerticalG: number;
+  minVerticalG: number;
+  maxLateralG: number;
+}
+
+export interface RobustnessReport {
+  samples: number;
+  stallProbability: number;
+  exceedanceProbability: number;
+  sections: RobustnessSection[];
+}
+
+export interface SimilarityMatch {
+  id: string;
+  distance: number; // descriptor units; DUPLICATE_DISTANCE and under is the same ride
+}
+
+// Exact k-NN over track descriptors; synchronous, it scans in well under
+// a frame even for tens of thousands of designs
+export interface SimilarityIndex {
+  add(id: string, descriptor: Float32Array): boolean;
+  remove(id: string): boolean;
+  has(id: string): boolean;
+  get(id: string): Float32Array | null;
+  size(): number;
+  query(descriptor: Float32Array, k: number, excludeId?: string): SimilarityMatch[];
+}
+
+export interface RideSimulation {
+  rideTime: number;
+  completed: boolean;
+  // time, x, y, z, qx, qy, qz, qw, speed, gVertical, gLateral per step
+  samples: Float64Array;
+}
+
+export interface PhysicsAddon {
+  validateTrack(points: TrackPointInput[], isLooped: boolean, hasChainLift: boolean): Promise<ValidationResult[]>;
+  analyzeTrack(
+    points: TrackPointInput[],
+    isLooped: boolean,
+    hasChainLift: boolean
+  ): Promise<TrackAnalysis & { descriptor: Float32Array }>;
+  simulateRide(points: TrackPointInput[], isLooped: boolean, hasChainLift: boolean, rateHz: number): Promise<RideSimulation>;
+  // Quantized points, elements and physics constants; synchronous
+  canonicalTrack(points: TrackPointInput[], isLooped: boolean, hasChainLift: boolean): Buffer;
+  // Fixed-length similarity key: element counts, ride scalars, shape signatures
+  describeTrack(points: TrackPointInput[], isLooped: boolean, hasChainLift: boolean): Promise<Float32Array>;
+  // Monte Carlo over load, friction and wind; fans out over its own threads
+  simulateRobustness(
+    points: TrackPointInput[],
+    isLooped: boolean,
+    hasChainLift: boolean,
+    options?: RobustnessOptions
+  ): Promise<RobustnessReport>;
+  SimilarityIndex: new () => SimilarityIndex;
+  readonly SAMPLE_STRIDE: number;
+  readonly DESCRIPTOR_LENGTH: number;
+  readonly DUPLICATE_DISTANCE: number;
+}
+
+let addon: PhysicsAddon | null | undefined;
+
+export function getPhysicsAddon(): PhysicsAddon | null {
+  if (addon === undefined) {
+    const addonPath =
+      process.env.PHYSICS_ADDON_PATH ?? path.resolve(process.cwd(), "server/native/physics_engine.node");
+    try {
+      addon = createRequire(addonPath)(addonPath) as PhysicsAddon;
+    } catch {
+      console.warn(`Native physics addon not found at ${addonPath}; server-side analysis is disabled`);
+      addon = null;
+    }
+  }
+  return addon;
+}
+
+/**
+ * A plain lift-hill oval every engine build must ride to the end: 30 m
+ * lift hill whose spline crest lies past its highest point, then hills
+ * of 14 m and under. Drag or chain-lift regressions make it stall.
+ */
+export const REFERENCE_TRACK: TrackSubmission = {
+  points: [
+    { x: 70, y: 2, z: 0 },
+    { x: 60.6, y: 12, z: 22.5 },
+    { x: 35, y: 30, z: 39 },
+    { x: 0, y: 24, z: 45 },
+    { x: -35, y: 10, z: 39 },
+    { x: -60.6, y: 14, z: 22.5 },
+    { x: -70, y: 6, z: 0 },
+    { x: -60.6, y: 11, z: -22.5 },
+    { x: -35, y: 4, z: -39 },
+    { x: 0, y: 7, z: -45 },
+    { x: 35, y: 3, z: -39 },
+    { x: 60.6, y: 2, z: -22.5 },
+  ],
+  isLooped: true,
+  hasChainLift: true,
+};
+
+// Run once at startup; logs and returns false if the reference track
+// does not complete
+export async function checkReferenceTrack(physics: PhysicsAddon): Promise<boolean> {
+  const { points, isLooped, hasChainLift } = REFERENCE_TRACK;
+  const { stats, stall } = await physics.analyzeTrack(points, isLooped, hasChainLift);
+  if (stats.rideCompleted && stall.outcome === 0) return true;
+
+  console.error(
+    `Physics addon failed the reference track (completed: ${stats.rideCompleted}, stall outcome: ${stall.outcome}); ` +
+      "check the drag and chain-lift calibration"
+  );
+  return false;
+}
+
+let similarityIndex: SimilarityIndex | undefined;
+
+/**
+ * Designs whose analysis is in the storage cache, keyed by fingerprint.
+ * Entries leave together with their cached analysis, so the index is
+ * bounded by the same LRU limit however many tracks are submitted.
+ */
+export function getSimilarityIndex(physics: PhysicsAddon): SimilarityIndex {
+  similarityIndex ??= new physics.SimilarityIndex();
+  return similarityIndex;
+}
+
+/**
+ * Cache key for a design: SHA-256 over its canonical bytes, so distinct
+ * designs never share a cached analysis however many are submitted.
+ */
+export function fingerprintTrack(
+  physics: PhysicsAddon,
+  points: TrackPointInput[],
+  isLooped: boolean,
+  hasChainLift: boolean
+): string {
+  return createHash("sha256").update(physics.canonicalTrack(points, isLooped, hasChainLift)).digest("hex");
+}
+
+/**
+ * Analysis through the storage cache: repeat submissions of the same
+ * design (re-uploads, forks, imports) cost one fingerprint hash. Fresh
+ * analyses also add the design to the similarity index, and designs the
+ * cache evicts leave it.
+ */
+export async function analyzeTrackCached(
+  physics: PhysicsAddon,
+  submission: TrackSubmission
+): Promise<TrackAnalysis & { fingerprint: string; cached: boolean }> {
+  const { points, isLooped, hasChainLift } = submission;
+  const fingerprint = fingerprintTrack(physics, points, isLooped, hasChainLift);
+
+  const cached = await storage.getCachedAnalysis(fingerprint);
+  if (cached) return { ...cached, fingerprint, cached: true };
+
+  const { descriptor, ...analysis } = await physics.analyzeTrack(points, isLooped, hasChainLift);
+  const index = getSimilarityIndex(physics);
+  index.add(fingerprint, descriptor);
+  for (const evicted of await storage.cacheAnalysis(fingerprint, analysis)) {
+    index.remove(evicted);
+  }
+  return { ...analysis, fingerprint, cached: false };
+}
+
+export interface SimilarTrack {
+  fingerprint: string;
+  distance: number;
+  duplicate: boolean;
+}
+
+/**
+ * The k indexed designs nearest to a submission, closest first. The
+ * submission is analyzed (and so indexed) first, and never matches itself.
+ */
+export async function findSimilarTracks(
+  physics: PhysicsAddon,
+  query: SimilarTrackQuery
+): Promise<{ fingerprint: string; matches: SimilarTrack[] }> {
+  const { points, isLooped, hasChainLift, k } = query;
+  const { fingerprint } = await analyzeTrackCached(physics, query);
+
+  const index = getSimilarityIndex(physics);
+  // Evicted again by concurrent submissions; describe it without
+  // re-indexing, so the index never outgrows the cache
+  const descriptor = index.get(fingerprint) ?? (await physics.describeTrack(points, isLooped, hasChainLift));
+
+  const matches = index.query(descriptor, k, fingerprint).map((match) => ({
+    fingerprint: match.id,
+    distance: match.distance,
+    duplicate: match.distance <= physics.DUPLICATE_DISTANCE,
+  }));
+  return { fingerprint, matches };
+}
+
+// libuv runs addon work on UV_THREADPOOL_SIZE threads (default 4); more
+// tracks in flight than that only queue up inside libuv
+export const ANALYSIS_POOL_SIZE = Number(process.env.UV_THREADPOOL_SIZE) || 4;
+
+// Robustness runs use every core each, so more than one at a time only
+// competes with itself and starves the pool threads analyses need
+export const MAX_ROBUSTNESS_RUNS = 1;
+
+export type BatchResult =
+  | ({ index: number; ok: true } & TrackAnalysis & { fingerprint: string; cached: boolean })
+  | { index: number; ok: false; message: string };
+
+/**
+ * Analyze many tracks with at most `concurrency` in flight, handing each
+ * result to `emit` as it finishes (completion order, tagged by index).
+ * A worker doesn't pick up its next track until `emit` resolves, so a slow
+ * consumer holds the batch back instead of buffering results. Stops taking
+ * new tracks once `isCancelled` returns true.
+ */
+export async function analyzeTrackBatch(
+  physics: PhysicsAddon,
+  tracks: unknown[],
+  concurrency: number,
+  emit: (result: BatchResult) => Promise<void>,
+  isCancelled: () => boolean = () => false
+): Promise<void> {
+  let next = 0;
+
+  const worker = async () => {
+    while (next < tracks.length && !isCancelled()) {
+      const index = next++;
+      const parsed = trackSubmissionSchema.safeParse(tracks[index]);
+      let result: BatchResult;
+      if (!parsed.success) {
+        result = { index, ok: false, message: parsed.error.issues[0]?.message ?? "Invalid track" };
+      } else {
+        try {
+          result = { index, ok: true, ...(await analyzeTrackCached(physics, parsed.data)) };
+        } catch (err) {
+          result = { index, ok: false, message: err instanceof Error ? err.message : String(err) };
+        }
+      }
+      await emit(result);
+    }
+  };
+
+  const workers = Math.max(1, Math.min(concurrency, tracks.length));
+  await Promise.all(Array.from({ length: workers }, worker));
+}
@@ -1,6 +1,20 @@
 import type { Express } from "express";
 import type { Server } from "http";
+import {
+  robustnessQuerySchema,
+  similarTrackQuerySchema,
+  trackBatchSchema,
+  trackSubmissionSchema,
+} from "@shared/schema";
 import { storage } from "./storage";
+import {
+  ANALYSIS_POOL_SIZE,
+  analyzeTrackBatch,
+  analyzeTrackCached,
+  findSimilarTracks,
+  getPhysicsAddon,
+  MAX_ROBUSTNESS_RUNS,
+} from "./physicsAddon";
 
 export async function registerRoutes(
   httpServer: Server,
@@ -12,5 +26,135 @@ export async function registerRoutes(
   // use storage to perform CRUD operations on the storage interface
   // e.g. storage.insertUser(user) or storage.getUserByUsername(username)
 
+  // Validate and score a submitted track with the native engine
+  app.post("/api/analyze", async (req, res, next) => {
+    const parsed = trackSubmissionSchema.safeParse(req.body);
+    if (!parsed.success) {
+      return res.status(400).json({ message: parsed.error.issues[0]?.message ?? "Invalid track" });
+    }
+
+    const physics = getPhysicsAddon();
+    if (!physics) {
+      return res.status(503).json({ message: "Track analysis is unavailable" });
+    }
+
+    try {
+      res.json(await analyzeTrackCached(physics, parsed.data));
+    } catch (err) {
+      next(err);
+    }
+  });
+
+  // Robustness runs in flight; requests past the cap are turned away
+  // rather than queued behind a run that already holds every core
+  let robustnessRuns = 0;
+
+  // Stall and G-limit odds per section under varied load, friction and
+  // wind. Deterministic for a given seed, so results can be compared
+  // across edits.
+  app.post("/api/analyze/robustness", async (req, res, next) => {
+    const parsed = robustnessQuerySchema.safeParse(req.body);
+    if (!parsed.success) {
+      return res.status(400).json({ message: parsed.error.issues[0]?.message ?? "Invalid track" });
+    }
+
+    const physics = getPhysicsAddon();
+    if (!physics) {
+      return res.status(503).json({ message: "Track analysis is unavailable" });
+    }
+
+    if (robustnessRuns >= MAX_ROBUSTNESS_RUNS) {
+      res.set("Retry-After", "5");
+      return res.status(503).json({ message: "Robustness analysis is busy; try again shortly" });
+    }
+
+    const { points, isLooped, hasChainLift, ...options } = parsed.data;
+    robustnessRuns++;
+    try {
+      res.json(await physics.simulateRobustness(points, isLooped, hasChainLift, options));
+    } catch (err) {
+      next(err);
+    } finally {
+      robustnessRuns--;
+    }
+  });
+
+  // Nearest designs among everything analyzed so far, with near-duplicates
+  // flagged
+  app.post("/api/similar", async (req, res, next) => {
+    const parsed = similarTrackQuerySchema.safeParse(req.body);
+    if (!parsed.success) {
+      return res.status(400).json({ message: parsed.error.issues[0]?.message ?? "Invalid track" });
+    }
+
+    const physics = getPhysicsAddon();
+    if (!physics) {
+      return res.status(503).json({ message: "Track analysis is unavailable" });
+    }
+
+    try {
+      res.json(await findSimilarTracks(physics, parsed.data));
+    } catch (err) {
+      next(err);
+    }
+  });
+
+  // Bulk scoring: one NDJSON line per track as it finishes, then a summary
+  // line. Writes wait for the socket to drain, and the batch stops when the
+  // client disconnects.
+  app.post("/api/analyze/batch", async (req, res) => {
+    const parsed = trackBatchSchema.safeParse(req.body);
+    if (!parsed.success) {
+      return res.status(400).json({ message: parsed.error.issues[0]?.message ?? "Invalid batch" });
+    }
+
+    const physics = getPhysicsAddon();
+    if (!physics) {
+      return res.status(503).json({ message: "Track analysis is unavailable" });
+    }
+
+    const { tracks, concurrency = ANALYSIS_POOL_SIZE } = parsed.data;
+    let closed = false;
+    res.on("close", () => {
+      closed = true;
+    });
+
+    const writeLine = (value: unknown) =>
+      new Promise<void>((resolve) => {
+        if (closed || res.write(JSON.stringify(value) + "\n")) return resolve();
+        const done = () => {
+          res.off("drain", done);
+          res.off("close", done);
+          resolve();
+        };
+        res.on("drain", done);
+        res.on("close", done);
+      });
+
+    res.status(200);
+    res.setHeader("Content-Type", "application/x-ndjson");
+    res.setHeader("Cache-Control", "no-cache");
+    res.flushHeaders();
+
+    try {
+      let failed = 0;
+      await analyzeTrackBatch(
+        physics,
+        tracks,
+        Math.min(concurrency, ANALYSIS_POOL_SIZE),
+        (result) => {
+          if (!result.ok) failed++;
+          return writeLine(result);
+        },
+        () => closed
+      );
+      await writeLine({ done: true, total: tracks.length, failed });
+      res.end();
+    } catch (err) {
+      // Headers are out; cut the stream so the client sees it truncated
+      res.destroy(err instanceof Error ? err : undefined);
+    }
+  });
+
   return httpServer;
 }
@@ -1,4 +1,8 @@
 import { users, type User, type InsertUser } from "@shared/schema";
+import type { TrackAnalysis } from "./physicsAddon";
+
+// Analysis results kept per track fingerprint; least recently used first out
+const ANALYSIS_CACHE_LIMIT = 1000;
 
 // Note: In production, use bcrypt or argon2 for password hashing
 // This is a placeholder that should be replaced with proper hashing
@@ -17,16 +21,21 @@ export interface IStorage {
   getUserByUsername(username: string): Promise<User | undefined>;
   createUser(user: InsertUser): Promise<User>;
   verifyPassword(user: User, password: string): Promise<boolean>;
+  getCachedAnalysis(fingerprint: string): Promise<TrackAnalysis | undefined>;
+  // Resolves to the fingerprints evicted to make room
+  cacheAnalysis(fingerprint: string, analysis: TrackAnalysis): Promise<string[]>;
 }
 
 export class MemStorage implements IStorage {
   private users: Map<number, User>;
   private passwordStore: Map<number, string>; // Store password hashes separately
+  private analysisCache: Map<string, TrackAnalysis>; // insertion order = recency
   currentId: number;
 
   constructor() {
     this.users = new Map();
     this.passwordStore = new Map();
+    this.analysisCache = new Map();
     this.currentId = 1;
   }
 
@@ -59,6 +68,29 @@ export class MemStorage implements IStorage {
     // In production: return await bcrypt.compare(password, storedHash);
     return storedHash.includes(password);
   }
+
+  async getCachedAnalysis(fingerprint: string): Promise<TrackAnalysis | undefined> {
+    const analysis = this.analysisCache.get(fingerprint);
+    if (analysis) {
+      // Move to the back so it is evicted last
+      this.analysisCache.delete(fingerprint);
+      this.analysisCache.set(fingerprint, analysis);
+    }
+    return analysis;
+  }
+
+  async cacheAnalysis(fingerprint: string, analysis: TrackAnalysis): Promise<string[]> {
+    this.analysisCache.delete(fingerprint);
+    this.analysisCache.set(fingerprint, analysis);
+    const evicted: string[] = [];
+    while (this.analysisCache.size > ANALYSIS_CACHE_LIMIT) {
+      const oldest = this.analysisCache.keys().next().value;
+      if (oldest === undefined) break;
+      this.analysisCache.delete(oldest);
+      evicted.push(oldest);
+    }
+    return evicted;
+  }
 }
 
 export const storage = new MemStorage();
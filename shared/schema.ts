@@ -19,3 +19,54 @@ export const insertUserSchema = createInsertSchema(users).pick({
 
 export type InsertUser = z.infer<typeof insertUserSchema>;
 export type User = typeof users.$inferSelect;
+
+// Track submitted for server-side analysis; the same point shape the
+// client hands to the WASM engine (tilt in radians)
+export const trackPointInputSchema = z.object({
+  x: z.number().finite(),
+  y: z.number().finite(),
+  z: z.number().finite(),
+  tilt: z.number().finite().optional(),
+  hasLoop: z.boolean().optional(),
+  loopRadius: z.number().finite().positive().optional(),
+  loopPitch: z.number().finite().optional(),
+});
+
+export const trackSubmissionSchema = z.object({
+  points: z.array(trackPointInputSchema).min(2).max(4096),
+  isLooped: z.boolean().default(true),
+  hasChainLift: z.boolean().default(true),
+});
+
+// Bulk analysis. Tracks are checked one by one against trackSubmissionSchema
+// so a bad entry becomes an error line instead of failing the whole batch
+export const trackBatchSchema = z.object({
+  tracks: z.array(z.unknown()).min(1).max(1000),
+  concurrency: z.number().int().min(1).max(64).optional(),
+});
+
+// "Rides like this one": the k nearest designs the server has analyzed
+export const similarTrackQuerySchema = trackSubmissionSchema.extend({
+  k: z.number().int().min(1).max(100).default(10),
+});
+
+// Monte Carlo robustness: rides with drawn passenger load, friction and
+// wind. The same seed reproduces every sample.
+export const robustnessQuerySchema = trackSubmissionSchema
+  .extend({
+    samples: z.number().int().min(1).max(20000).default(2000),
+    seed: z.number().int().min(0).max(0xffffffff).default(1),
+    minOccupancy: z.number().min(0).max(1).default(0),
+    maxOccupancy: z.number().min(0).max(1).default(1),
+    frictionSigma: z.number().min(0).max(1).default(0.2),
+    meanWindSpeed: z.number().min(0).max(30).default(4),
+  })
+  .refine((q) => q.minOccupancy <= q.maxOccupancy, {
+    message: "minOccupancy must not exceed maxOccupancy",
+  });
+
+export type TrackPointInput = z.infer<typeof trackPointInputSchema>;
+export type TrackSubmission = z.infer<typeof trackSubmissionSchema>;
+export type TrackBatch = z.infer<typeof trackBatchSchema>;
+export type SimilarTrackQuery = z.infer<typeof similarTrackQuerySchema>;
+export type RobustnessQuery = z.infer<typeof robustnessQuerySchema>;